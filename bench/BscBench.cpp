@@ -0,0 +1,463 @@
+/**
+ * @file BscBench.cpp
+ * @brief Throughput, round-trip latency and port scaling benchmarks for libSerial and libOpenBSC
+ *
+ * Every port is the slave side of a pty pair; BscResponder plays the device on the master
+ * side. Results are written as one JSON document so that runs can be compared across
+ * releases.
+ */
+
+#include "BscResponder.hpp"
+#include "FrameParser.hpp"
+#include "OpenBSC.hpp"
+#include "PtyPair.hpp"
+#include "Serial.hpp"
+#include "SerialReactor.hpp"
+#include "SerialUring.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <time.h>
+
+using Clock = std::chrono::steady_clock;
+
+static const char   BENCH_COMMAND[]  = "V";
+static const char   BENCH_RESPONSE[] = "OpenBSC bench responder 1.0";
+static const size_t CHUNK_SIZE       = 4096;
+
+struct BenchConfig
+{
+    size_t       iterations = 20000;   // Round trips per backend
+    size_t       bulkBytes  = 8 << 20; // Bytes per throughput direction
+    unsigned int durationMs = 1000;    // Duration of each scaling step
+    size_t       maxPorts   = 256;     // Largest scaling step
+    unsigned int shards     = 1;       // Reactor threads in the scaling steps
+    std::string  output     = "-";     // JSON destination, "-" for stdout
+};
+
+struct Variant
+{
+    const char*   name;
+    SerialOptions options;
+};
+
+struct ThroughputResult
+{
+    std::string name;
+    double      writeMBps;
+    double      readMBps;
+};
+
+struct RoundTripResult
+{
+    std::string name;
+    size_t      iterations;
+    size_t      failures;
+    double      p50Us, p99Us, p999Us, meanUs;
+    double      framesPerSec;
+    double      framesPerCpuSec;
+};
+
+struct ScalingResult
+{
+    size_t ports;
+    double framesPerSec;
+    double p50Us, p99Us;
+};
+
+static double threadCpuSeconds()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return static_cast<double>(ts.tv_sec) + static_cast<double>(ts.tv_nsec) / 1e9;
+}
+
+static double seconds(Clock::duration d)
+{
+    return std::chrono::duration<double>(d).count();
+}
+
+// Nearest-rank percentile of sorted samples.
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size()) + 0.999999);
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+static std::vector<uint8_t> frameCommand(const char* command)
+{
+    std::vector<uint8_t> frame(1, FrameParser::STX);
+    uint8_t              bcc = FrameParser::ETX;
+    for (const char* c = command; *c; ++c)
+    {
+        frame.push_back(static_cast<uint8_t>(*c));
+        bcc ^= static_cast<uint8_t>(*c);
+    }
+    frame.push_back(FrameParser::ETX);
+    frame.push_back(bcc);
+    return frame;
+}
+
+static bool measureThroughput(const Variant& variant, size_t total, ThroughputResult& result)
+{
+    PtyPair pair;
+    if (!pair.Valid())
+        return false;
+
+    auto port = SerialCommunication::Create(pair.SlaveName(), 115200, 8, 1, 'N', false, false, variant.options);
+    if (!port)
+        return false;
+
+    std::vector<uint8_t> chunk(CHUNK_SIZE, 0x55);
+
+    // Port -> device
+    auto        start  = Clock::now();
+    std::thread drain([&] {
+        std::vector<uint8_t> buffer(CHUNK_SIZE);
+        size_t               received = 0;
+        while (received < total)
+        {
+            ssize_t n = ::read(pair.Master(), buffer.data(), buffer.size());
+            if (n > 0)
+                received += static_cast<size_t>(n);
+        }
+    });
+    for (size_t sent = 0; sent < total; sent += CHUNK_SIZE)
+        port->Write(chunk.data(), std::min(CHUNK_SIZE, total - sent));
+    port->DrainWrites(5000);
+    drain.join();
+    result.writeMBps = static_cast<double>(total) / 1e6 / seconds(Clock::now() - start);
+
+    // Device -> port
+    start = Clock::now();
+    std::thread fill([&] {
+        for (size_t sent = 0; sent < total;)
+        {
+            ssize_t n = ::write(pair.Master(), chunk.data(), std::min(CHUNK_SIZE, total - sent));
+            if (n > 0)
+                sent += static_cast<size_t>(n);
+        }
+    });
+    std::vector<uint8_t> buffer(CHUNK_SIZE);
+    for (size_t received = 0; received < total;)
+    {
+        size_t n = port->Read(buffer.data(), buffer.size(), 1000);
+        if (n == 0)
+            break;
+        received += n;
+    }
+    fill.join();
+    result.readMBps = static_cast<double>(total) / 1e6 / seconds(Clock::now() - start);
+
+    result.name = variant.name;
+    return true;
+}
+
+static bool measureRoundTrip(const Variant& variant, size_t iterations, RoundTripResult& result)
+{
+    PtyPair      pair;
+    BscResponder responder;
+    if (!pair.Valid() || !responder.Attach(pair.Master()))
+        return false;
+    responder.Script(BENCH_COMMAND, BENCH_RESPONSE);
+    responder.Start();
+
+    OpenBSC bsc;
+    if (!bsc.Init(pair.SlaveName().c_str(), 115200, 8, 1, 'N', false, false, variant.options))
+        return false;
+
+    char                answer[256];
+    std::vector<double> samples;
+    samples.reserve(iterations);
+
+    // Warm up caches, the responder thread and the io_uring instance.
+    for (int i = 0; i < 100; ++i)
+    {
+        bsc.SendCommand(BENCH_COMMAND, sizeof(BENCH_COMMAND) - 1);
+        bsc.ReadResponse(answer, sizeof(answer), 1000);
+    }
+
+    size_t failures = 0;
+    double cpuStart = threadCpuSeconds();
+    auto   start    = Clock::now();
+
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        auto sent = Clock::now();
+        if (!bsc.SendCommand(BENCH_COMMAND, sizeof(BENCH_COMMAND) - 1) || bsc.ReadResponse(answer, sizeof(answer), 1000) == 0)
+        {
+            ++failures;
+            continue;
+        }
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+    }
+
+    double wall = seconds(Clock::now() - start);
+    double cpu  = threadCpuSeconds() - cpuStart;
+    bsc.Disconnect();
+    responder.Stop();
+
+    std::sort(samples.begin(), samples.end());
+    double sum = 0.0;
+    for (double s : samples)
+        sum += s;
+
+    result.name            = variant.name;
+    result.iterations      = iterations;
+    result.failures        = failures;
+    result.p50Us           = percentile(samples, 0.50);
+    result.p99Us           = percentile(samples, 0.99);
+    result.p999Us          = percentile(samples, 0.999);
+    result.meanUs          = samples.empty() ? 0.0 : sum / static_cast<double>(samples.size());
+    result.framesPerSec    = static_cast<double>(samples.size()) / wall;
+    result.framesPerCpuSec = cpu > 0.0 ? static_cast<double>(samples.size()) / cpu : 0.0;
+    return true;
+}
+
+// One outstanding command per port, driven from SerialReactor shard threads.
+struct ScalingPort
+{
+    std::shared_ptr<SerialCommunication> port;
+    FrameParser                          parser;
+    Clock::time_point                    sent;
+    std::vector<double>                  samples;
+};
+
+static bool measureScaling(size_t count, const BenchConfig& config, ScalingResult& result)
+{
+    std::vector<std::unique_ptr<PtyPair>>     pairs;
+    std::vector<std::unique_ptr<ScalingPort>> ports;
+    BscResponder                              responder;
+    responder.Script(BENCH_COMMAND, BENCH_RESPONSE);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::unique_ptr<PtyPair> pair(new PtyPair());
+        if (!pair->Valid() || !responder.Attach(pair->Master()))
+            return false;
+
+        std::unique_ptr<ScalingPort> state(new ScalingPort());
+        state->port = SerialCommunication::Create(pair->SlaveName(), 115200, 8, 1, 'N', false, false);
+        if (!state->port)
+            return false;
+        state->samples.reserve(4096);
+
+        pairs.push_back(std::move(pair));
+        ports.push_back(std::move(state));
+    }
+
+    const std::vector<uint8_t> command = frameCommand(BENCH_COMMAND);
+    std::atomic<bool>          running(true);
+    SerialReactor              reactor(config.shards);
+
+    for (auto& state : ports)
+    {
+        ScalingPort* s = state.get();
+        reactor.Add(s->port, [s, &command, &running](SerialCommunication& port, uint32_t) {
+            uint8_t buffer[512];
+            size_t  n;
+            while ((n = port.ReadAvailable(buffer, sizeof(buffer))) > 0)
+            {
+                for (size_t offset = 0; offset < n;)
+                {
+                    FrameParser::Result frame;
+                    offset += s->parser.Feed(buffer + offset, n - offset, frame);
+                    if (frame != FrameParser::Result::Frame)
+                        continue;
+
+                    auto now = Clock::now();
+                    s->samples.push_back(std::chrono::duration<double, std::micro>(now - s->sent).count());
+                    if (running)
+                    {
+                        s->sent = now;
+                        port.Write(command.data(), command.size());
+                    }
+                }
+            }
+        });
+    }
+
+    responder.Start();
+    reactor.Start();
+
+    auto start = Clock::now();
+    for (auto& state : ports)
+    {
+        state->sent = Clock::now();
+        state->port->Write(command.data(), command.size());
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(config.durationMs));
+    running = false;
+    auto wall = seconds(Clock::now() - start);
+
+    reactor.Stop();
+    responder.Stop();
+
+    std::vector<double> samples;
+    for (auto& state : ports)
+        samples.insert(samples.end(), state->samples.begin(), state->samples.end());
+    std::sort(samples.begin(), samples.end());
+
+    result.ports        = count;
+    result.framesPerSec = static_cast<double>(samples.size()) / wall;
+    result.p50Us        = percentile(samples, 0.50);
+    result.p99Us        = percentile(samples, 0.99);
+    return true;
+}
+
+static void writeJson(FILE* out, const BenchConfig& config, const std::vector<ThroughputResult>& throughput,
+                      const std::vector<RoundTripResult>& roundTrips, const std::vector<ScalingResult>& scaling)
+{
+    std::fprintf(out, "{\n");
+    std::fprintf(out, "  \"benchmark\": \"bsc_bench\",\n");
+    std::fprintf(out, "  \"schema\": 1,\n");
+    std::fprintf(out, "  \"host\": {\"cpus\": %u, \"io_uring\": %s},\n", std::thread::hardware_concurrency(),
+                 UringRing::Available() ? "true" : "false");
+    std::fprintf(out, "  \"config\": {\"iterations\": %zu, \"bulk_bytes\": %zu, \"duration_ms\": %u, \"max_ports\": %zu, \"shards\": %u},\n",
+                 config.iterations, config.bulkBytes, config.durationMs, config.maxPorts, config.shards);
+
+    std::fprintf(out, "  \"throughput\": [\n");
+    for (size_t i = 0; i < throughput.size(); ++i)
+    {
+        const ThroughputResult& r = throughput[i];
+        std::fprintf(out, "    {\"variant\": \"%s\", \"write_mb_s\": %.2f, \"read_mb_s\": %.2f}%s\n", r.name.c_str(), r.writeMBps, r.readMBps,
+                     i + 1 < throughput.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"round_trip\": [\n");
+    for (size_t i = 0; i < roundTrips.size(); ++i)
+    {
+        const RoundTripResult& r = roundTrips[i];
+        std::fprintf(out,
+                     "    {\"variant\": \"%s\", \"iterations\": %zu, \"failures\": %zu, \"p50_us\": %.2f, \"p99_us\": %.2f, \"p999_us\": %.2f, "
+                     "\"mean_us\": %.2f, \"frames_per_sec\": %.0f, \"frames_per_cpu_sec\": %.0f}%s\n",
+                     r.name.c_str(), r.iterations, r.failures, r.p50Us, r.p99Us, r.p999Us, r.meanUs, r.framesPerSec, r.framesPerCpuSec,
+                     i + 1 < roundTrips.size() ? "," : "");
+    }
+    std::fprintf(out, "  ],\n");
+
+    std::fprintf(out, "  \"scaling\": [\n");
+    for (size_t i = 0; i < scaling.size(); ++i)
+    {
+        const ScalingResult& r = scaling[i];
+        std::fprintf(out, "    {\"ports\": %zu, \"frames_per_sec\": %.0f, \"p50_us\": %.2f, \"p99_us\": %.2f}%s\n", r.ports, r.framesPerSec,
+                     r.p50Us, r.p99Us, i + 1 < scaling.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n");
+    std::fprintf(out, "}\n");
+}
+
+static void printUsage(const char* progName)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-n ITERATIONS] [-b BYTES] [-d MS] [-m PORTS] [-s SHARDS] [-o FILE]\n"
+                 "  -n <ITERATIONS> | --iterations <ITERATIONS>  Round trips per variant (default: 20000)\n"
+                 "  -b <BYTES>      | --bytes <BYTES>            Bytes per throughput direction (default: 8 MiB)\n"
+                 "  -d <MS>         | --duration <MS>            Duration of each scaling step (default: 1000)\n"
+                 "  -m <PORTS>      | --max-ports <PORTS>        Largest scaling step, 1 to 256 by x4 (default: 256)\n"
+                 "  -s <SHARDS>     | --shards <SHARDS>          Reactor threads for scaling, 0 = one per CPU (default: 1)\n"
+                 "  -o <FILE>       | --output <FILE>            JSON output file, - for stdout (default: -)\n",
+                 progName);
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig config;
+
+    const struct option longOptions[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"iterations", required_argument, nullptr, 'n'},
+        {"bytes", required_argument, nullptr, 'b'},
+        {"duration", required_argument, nullptr, 'd'},
+        {"max-ports", required_argument, nullptr, 'm'},
+        {"shards", required_argument, nullptr, 's'},
+        {"output", required_argument, nullptr, 'o'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hn:b:d:m:s:o:", longOptions, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h': printUsage(argv[0]); return 0;
+            case 'n': config.iterations = std::strtoul(optarg, nullptr, 0); break;
+            case 'b': config.bulkBytes = std::strtoul(optarg, nullptr, 0); break;
+            case 'd': config.durationMs = static_cast<unsigned int>(std::strtoul(optarg, nullptr, 0)); break;
+            case 'm': config.maxPorts = std::strtoul(optarg, nullptr, 0); break;
+            case 's': config.shards = static_cast<unsigned int>(std::strtoul(optarg, nullptr, 0)); break;
+            case 'o': config.output = optarg; break;
+            default: printUsage(argv[0]); return 1;
+        }
+    }
+
+    // Every scaling port costs two descriptors (pty master and slave).
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    std::vector<Variant> variants(3);
+    variants[0].name = "poll";
+    variants[1].name = "io_uring";
+    variants[1].options.backend = SerialBackend::IoUring;
+    variants[2].name = "rx_thread";
+    variants[2].options.rxRingCapacity = 64 * 1024;
+
+    std::vector<ThroughputResult> throughput;
+    std::vector<RoundTripResult>  roundTrips;
+    std::vector<ScalingResult>    scaling;
+
+    for (const Variant& variant : variants)
+    {
+        std::fprintf(stderr, "throughput %s\n", variant.name);
+        ThroughputResult t;
+        if (measureThroughput(variant, config.bulkBytes, t))
+            throughput.push_back(t);
+
+        std::fprintf(stderr, "round trip %s\n", variant.name);
+        RoundTripResult r;
+        if (measureRoundTrip(variant, config.iterations, r))
+            roundTrips.push_back(r);
+    }
+
+    for (size_t count = 1; count <= config.maxPorts; count *= 4)
+    {
+        std::fprintf(stderr, "scaling %zu ports\n", count);
+        ScalingResult s;
+        if (!measureScaling(count, config, s))
+        {
+            std::fprintf(stderr, "Failed to set up %zu ports\n", count);
+            break;
+        }
+        scaling.push_back(s);
+    }
+
+    FILE* out = config.output == "-" ? stdout : std::fopen(config.output.c_str(), "w");
+    if (!out)
+    {
+        std::fprintf(stderr, "Cannot write %s\n", config.output.c_str());
+        return 1;
+    }
+    writeJson(out, config, throughput, roundTrips, scaling);
+    if (out != stdout)
+        std::fclose(out);
+
+    return 0;
+}
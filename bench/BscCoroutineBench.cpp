@@ -0,0 +1,266 @@
+/**
+ * @file BscCoroutineBench.cpp
+ * @brief Many OpenBSC sessions as coroutines on a SerialReactor versus one thread per port
+ *
+ * Each port is the slave side of a pty pair answered by BscResponder. Every session sends
+ * the same command in a loop; the coroutine variant suspends in AsyncOpenBSC::Transact,
+ * the thread variant blocks in OpenBSC::ReadResponse. Built only with a C++20 compiler.
+ */
+
+#include "BscResponder.hpp"
+#include "OpenBSC.hpp"
+#include "OpenBSCCoroutine.hpp"
+#include "PtyPair.hpp"
+#include "SerialReactor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+using Clock = std::chrono::steady_clock;
+
+static const char BENCH_COMMAND[]  = "V";
+static const char BENCH_RESPONSE[] = "OpenBSC bench responder 1.0";
+
+struct BenchConfig
+{
+    size_t       ports        = 64;  // Concurrent sessions
+    size_t       transactions = 500; // Transactions per session
+    unsigned int shards       = 1;   // Reactor threads of the coroutine variant
+};
+
+struct Result
+{
+    const char* name;
+    size_t      completed = 0;
+    size_t      failures  = 0;
+    double      wall      = 0.0;
+    double      p50Us     = 0.0;
+    double      p99Us     = 0.0;
+};
+
+// Devices shared by both variants: pty pairs served by one responder thread.
+struct Bench
+{
+    std::vector<std::unique_ptr<PtyPair>> pairs;
+    BscResponder                          responder;
+
+    bool Setup(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            pairs.emplace_back(new PtyPair());
+            if (!pairs.back()->Valid() || !responder.Attach(pairs.back()->Master()))
+                return false;
+        }
+        responder.Script(BENCH_COMMAND, BENCH_RESPONSE);
+        responder.Start();
+        return true;
+    }
+};
+
+static double percentile(std::vector<double>& samples, double p)
+{
+    if (samples.empty())
+        return 0.0;
+    std::sort(samples.begin(), samples.end());
+    return samples[std::min(samples.size() - 1, static_cast<size_t>(p * static_cast<double>(samples.size())))];
+}
+
+static void finish(Result& result, std::vector<std::vector<double>>& perPort, Clock::time_point start)
+{
+    result.wall = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> samples;
+    for (auto& port : perPort)
+        samples.insert(samples.end(), port.begin(), port.end());
+    result.completed = samples.size();
+    result.p50Us     = percentile(samples, 0.50);
+    result.p99Us     = percentile(samples, 0.99);
+}
+
+static SerialTask<> session(AsyncOpenBSC& device, size_t transactions, std::vector<double>& samples, size_t& failures,
+                            std::atomic<size_t>& running)
+{
+    for (size_t i = 0; i < transactions; ++i)
+    {
+        auto           sent   = Clock::now();
+        TransactResult result = co_await device.Transact(BENCH_COMMAND, std::chrono::milliseconds(1000));
+        if (result)
+            samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+        else
+            ++failures;
+    }
+    running.fetch_sub(1);
+}
+
+static bool runCoroutines(Bench& bench, const BenchConfig& config, Result& result)
+{
+    size_t                                    count = bench.pairs.size();
+    SerialReactor                             reactor(config.shards);
+    std::vector<std::unique_ptr<OpenBSC>>     devices;
+    std::vector<std::unique_ptr<AsyncOpenBSC>> sessions;
+    std::vector<std::vector<double>>          samples(count);
+    std::vector<size_t>                       failures(count, 0);
+    std::atomic<size_t>                       running(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        devices.emplace_back(new OpenBSC());
+        if (!devices.back()->Init(bench.pairs[i]->SlaveName().c_str(), 115200, 8, 1, 'N', false, false))
+            return false;
+        sessions.emplace_back(new AsyncOpenBSC(reactor, *devices.back()));
+        if (!sessions.back()->Valid())
+            return false;
+        samples[i].reserve(config.transactions);
+    }
+
+    reactor.Start();
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i)
+        Spawn(reactor, session(*sessions[i], config.transactions, samples[i], failures[i], running), devices[i]->Port().get());
+
+    while (running.load() > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    finish(result, samples, start);
+    reactor.Stop();
+    for (size_t f : failures)
+        result.failures += f;
+
+    sessions.clear();
+    for (auto& device : devices)
+        device->Disconnect();
+    return true;
+}
+
+static bool runThreads(Bench& bench, const BenchConfig& config, Result& result)
+{
+    size_t                                count = bench.pairs.size();
+    std::vector<std::unique_ptr<OpenBSC>> devices;
+    std::vector<std::vector<double>>      samples(count);
+    std::atomic<size_t>                   failures(0);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        devices.emplace_back(new OpenBSC());
+        if (!devices.back()->Init(bench.pairs[i]->SlaveName().c_str(), 115200, 8, 1, 'N', false, false))
+            return false;
+        samples[i].reserve(config.transactions);
+    }
+
+    auto                     start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; ++i)
+    {
+        threads.emplace_back([&, i] {
+            char answer[256];
+            for (size_t n = 0; n < config.transactions; ++n)
+            {
+                auto sent = Clock::now();
+                if (!devices[i]->SendCommand(BENCH_COMMAND, sizeof(BENCH_COMMAND) - 1) ||
+                    devices[i]->ReadResponse(answer, sizeof(answer), 1000) == 0)
+                {
+                    failures.fetch_add(1);
+                    continue;
+                }
+                samples[i].push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent).count());
+            }
+        });
+    }
+    for (auto& thread : threads)
+        thread.join();
+
+    finish(result, samples, start);
+    result.failures = failures.load();
+
+    for (auto& device : devices)
+        device->Disconnect();
+    return true;
+}
+
+static void printUsage(const char* progName)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-p PORTS] [-n TRANSACTIONS] [-s SHARDS]\n"
+                 "  -p <PORTS>        | --ports <PORTS>               Concurrent sessions (default: 64)\n"
+                 "  -n <TRANSACTIONS> | --transactions <TRANSACTIONS> Transactions per session (default: 500)\n"
+                 "  -s <SHARDS>       | --shards <SHARDS>             Reactor threads, 0 = one per CPU (default: 1)\n",
+                 progName);
+}
+
+int main(int argc, char* argv[])
+{
+    BenchConfig config;
+
+    const struct option longOptions[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"ports", required_argument, nullptr, 'p'},
+        {"transactions", required_argument, nullptr, 'n'},
+        {"shards", required_argument, nullptr, 's'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hp:n:s:", longOptions, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h': printUsage(argv[0]); return 0;
+            case 'p': config.ports = std::strtoul(optarg, nullptr, 0); break;
+            case 'n': config.transactions = std::strtoul(optarg, nullptr, 0); break;
+            case 's': config.shards = static_cast<unsigned int>(std::strtoul(optarg, nullptr, 0)); break;
+            default: printUsage(argv[0]); return 1;
+        }
+    }
+
+    // Every port costs two descriptors (pty master and slave).
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    Bench bench;
+    if (!bench.Setup(config.ports))
+    {
+        std::fprintf(stderr, "Failed to set up %zu ports\n", config.ports);
+        return 1;
+    }
+
+    Result results[2];
+    results[0].name = "coroutine";
+    results[1].name = "thread_per_port";
+
+    std::fprintf(stderr, "coroutine sessions\n");
+    if (!runCoroutines(bench, config, results[0]))
+        return 1;
+    std::fprintf(stderr, "thread per port\n");
+    if (!runThreads(bench, config, results[1]))
+        return 1;
+
+    bench.responder.Stop();
+
+    std::printf("{\n  \"ports\": %zu,\n  \"transactions\": %zu,\n  \"shards\": %u,\n  \"results\": [\n", config.ports,
+                config.transactions, config.shards);
+    for (size_t i = 0; i < 2; ++i)
+    {
+        const Result& r = results[i];
+        std::printf("    {\"name\": \"%s\", \"completed\": %zu, \"failures\": %zu, \"tps\": %.1f, \"p50_us\": %.1f, "
+                    "\"p99_us\": %.1f}%s\n",
+                    r.name, r.completed, r.failures, r.wall > 0 ? r.completed / r.wall : 0.0, r.p50Us, r.p99Us,
+                    i == 0 ? "," : "");
+    }
+    std::printf("  ]\n}\n");
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ * @file BscReplay.cpp
+ * @brief Replays a traffic capture through the loopback transport into OpenBSC::ReadResponse
+ *
+ * The received chunks of the capture are written, with their original spacing or
+ * accelerated, to one end of an in-memory loopback; OpenBSC parses them on the other end.
+ * Reproduces field latency problems offline and benchmarks the parser on real traffic.
+ */
+
+#include "OpenBSC.hpp"
+#include "Serial.hpp"
+#include "SerialCapture.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <getopt.h>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static const char REPLAY_DEVICE[] = "loop://bsc-replay/b";
+static const char REPLAY_HOST[]   = "loop://bsc-replay/a";
+
+struct ReplayConfig
+{
+    CaptureReplayOptions options;        // Port, direction and speed
+    unsigned int         repeat   = 1;   // Passes over the capture
+    uint32_t             baudRate = 0;   // Loopback line pacing, 0 = none
+    std::string          input;
+};
+
+static void printUsage(const char* progName)
+{
+    std::fprintf(stderr,
+                 "Usage: %s [-p PORT_ID] [-s SPEED] [-r REPEAT] [-b BAUD] [--tx] CAPTURE\n"
+                 "  -p <PORT_ID> | --port <PORT_ID>   Replay only this port id (default: all)\n"
+                 "  -s <SPEED>   | --speed <SPEED>    Time scale, 1 = original, 0 = as fast as possible (default: 1)\n"
+                 "  -r <REPEAT>  | --repeat <REPEAT>  Passes over the capture (default: 1)\n"
+                 "  -b <BAUD>    | --baudrate <BAUD>  Also pace the loopback line at BAUD (default: off)\n"
+                 "  -t           | --tx               Replay transmitted instead of received chunks\n",
+                 progName);
+}
+
+int main(int argc, char* argv[])
+{
+    ReplayConfig config;
+
+    const struct option longOptions[] = {
+        {"help", no_argument, nullptr, 'h'},
+        {"port", required_argument, nullptr, 'p'},
+        {"speed", required_argument, nullptr, 's'},
+        {"repeat", required_argument, nullptr, 'r'},
+        {"baudrate", required_argument, nullptr, 'b'},
+        {"tx", no_argument, nullptr, 't'},
+        {nullptr, 0, nullptr, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "hp:s:r:b:t", longOptions, nullptr)) != -1)
+    {
+        switch (opt)
+        {
+            case 'h': printUsage(argv[0]); return 0;
+            case 'p': config.options.portId = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 0)); break;
+            case 's': config.options.speed = std::strtod(optarg, nullptr); break;
+            case 'r': config.repeat = static_cast<unsigned int>(std::strtoul(optarg, nullptr, 0)); break;
+            case 'b': config.baudRate = static_cast<uint32_t>(std::strtoul(optarg, nullptr, 0)); break;
+            case 't': config.options.direction = CaptureDirection::Tx; break;
+            default: printUsage(argv[0]); return 1;
+        }
+    }
+
+    if (optind != argc - 1)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    config.input = argv[optind];
+
+    SerialCaptureReader reader;
+    if (!reader.Open(config.input))
+    {
+        std::fprintf(stderr, "Cannot read capture %s\n", config.input.c_str());
+        return 1;
+    }
+
+    SerialOptions options;
+    options.loopback.simulateBaud = config.baudRate > 0;
+    uint32_t baudRate             = config.baudRate > 0 ? config.baudRate : 115200;
+
+    OpenBSC bsc;
+    auto    device = SerialCommunication::Create(REPLAY_DEVICE, baudRate, 8, 1, 'N', false, false, options);
+    if (!device || !bsc.Init(REPLAY_HOST, baudRate, 8, 1, 'N', false, false, options))
+    {
+        std::fprintf(stderr, "Cannot open the loopback ports\n");
+        return 1;
+    }
+
+    std::atomic<bool> done(false);
+    size_t            replayed = 0;
+    auto              start    = Clock::now();
+
+    std::thread player([&] {
+        for (unsigned int pass = 0; pass < config.repeat; ++pass)
+        {
+            reader.Rewind();
+            replayed += ReplayCapture(reader, *device, config.options);
+        }
+        done = true;
+    });
+
+    char     payload[1024];
+    uint64_t frames = 0;
+    while (true)
+    {
+        if (bsc.ReadResponse(payload, sizeof(payload), 100) > 0)
+            ++frames;
+        else if (done && bsc.Stats().serial.bytesIn == replayed)
+            break;
+    }
+
+    double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    player.join();
+
+    OpenBSCStats stats = bsc.Stats();
+    bsc.Disconnect();
+
+    std::printf("{\n");
+    std::printf("  \"capture\": \"%s\",\n", config.input.c_str());
+    std::printf("  \"bytes\": %zu,\n", replayed);
+    std::printf("  \"frames\": %llu,\n", static_cast<unsigned long long>(frames));
+    std::printf("  \"bcc_errors\": %llu,\n", static_cast<unsigned long long>(stats.bccErrors));
+    std::printf("  \"elapsed_s\": %.6f,\n", elapsed);
+    std::printf("  \"frames_per_s\": %.1f,\n", elapsed > 0 ? frames / elapsed : 0.0);
+    std::printf("  \"MBps\": %.3f\n", elapsed > 0 ? replayed / elapsed / 1e6 : 0.0);
+    std::printf("}\n");
+    return 0;
+}
@@ -0,0 +1,165 @@
+#ifndef BSC_RESPONDER_HPP
+#define BSC_RESPONDER_HPP
+
+#include "FrameParser.hpp"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+/**
+ * @brief Scripted OpenBSC device played on the master side of pty pairs
+ *
+ * One thread serves every attached master through epoll. Each received frame is answered
+ * with the response scripted for its payload, or with the payload itself when the command
+ * has no script entry.
+ */
+class BscResponder
+{
+public:
+    BscResponder() : epollFd_(::epoll_create1(EPOLL_CLOEXEC)), running_(false)
+    {
+    }
+
+    ~BscResponder()
+    {
+        Stop();
+        if (epollFd_ >= 0)
+            ::close(epollFd_);
+    }
+
+    BscResponder(const BscResponder&)            = delete;
+    BscResponder& operator=(const BscResponder&) = delete;
+
+    /**
+     * @brief Answer command with response instead of echoing it
+     */
+    void Script(const std::string& command, const std::string& response)
+    {
+        script_[command] = response;
+    }
+
+    /**
+     * @brief Serve a pty master; must be called before Start()
+     */
+    bool Attach(int master)
+    {
+        ::fcntl(master, F_SETFL, ::fcntl(master, F_GETFL) | O_NONBLOCK);
+
+        struct epoll_event ev{};
+        ev.events   = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(links_.size());
+        if (::epoll_ctl(epollFd_, EPOLL_CTL_ADD, master, &ev) != 0)
+            return false;
+
+        links_.emplace_back(new Link(master));
+        return true;
+    }
+
+    void Start()
+    {
+        if (running_.exchange(true))
+            return;
+        thread_ = std::thread(&BscResponder::loop, this);
+    }
+
+    void Stop()
+    {
+        if (!running_.exchange(false))
+            return;
+        thread_.join();
+    }
+
+    /**
+     * @brief Frames answered so far
+     */
+    uint64_t Answered() const
+    {
+        return answered_;
+    }
+
+private:
+    struct Link
+    {
+        explicit Link(int fd) : fd(fd)
+        {
+        }
+
+        int         fd;
+        FrameParser parser;
+    };
+
+    void loop()
+    {
+        struct epoll_event ready[64];
+        uint8_t            buffer[4096];
+
+        while (running_)
+        {
+            int n = ::epoll_wait(epollFd_, ready, 64, 50);
+            for (int i = 0; i < n; ++i)
+            {
+                Link&   link     = *links_[ready[i].data.u32];
+                ssize_t received = ::read(link.fd, buffer, sizeof(buffer));
+                if (received <= 0)
+                    continue;
+
+                size_t offset = 0;
+                while (offset < static_cast<size_t>(received))
+                {
+                    FrameParser::Result result;
+                    offset += link.parser.Feed(buffer + offset, static_cast<size_t>(received) - offset, result);
+                    if (result == FrameParser::Result::Frame)
+                        answer(link);
+                }
+            }
+        }
+    }
+
+    void answer(Link& link)
+    {
+        std::string command(reinterpret_cast<const char*>(link.parser.Payload()), link.parser.PayloadLength());
+        auto        it      = script_.find(command);
+        const std::string& payload = it == script_.end() ? command : it->second;
+
+        frame_.clear();
+        frame_.push_back(FrameParser::STX);
+        uint8_t bcc = FrameParser::ETX;
+        for (char c : payload)
+        {
+            frame_.push_back(static_cast<uint8_t>(c));
+            bcc ^= static_cast<uint8_t>(c);
+        }
+        frame_.push_back(FrameParser::ETX);
+        frame_.push_back(bcc);
+
+        size_t written = 0;
+        while (written < frame_.size())
+        {
+            ssize_t n = ::write(link.fd, frame_.data() + written, frame_.size() - written);
+            if (n < 0 && errno != EAGAIN && errno != EINTR)
+                return;
+            if (n > 0)
+                written += static_cast<size_t>(n);
+        }
+        ++answered_;
+    }
+
+    int                                epollFd_;
+    std::atomic<bool>                  running_;
+    std::atomic<uint64_t>              answered_{0};
+    std::thread                        thread_;
+    std::vector<std::unique_ptr<Link>> links_;
+    std::map<std::string, std::string> script_;
+    std::vector<uint8_t>               frame_;
+};
+
+#endif // BSC_RESPONDER_HPP
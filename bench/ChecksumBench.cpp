@@ -0,0 +1,99 @@
+/**
+ * @file ChecksumBench.cpp
+ * @brief Throughput of the SerialChecksum kernels at each instruction set level
+ */
+
+#include "SerialChecksum.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Bytes hashed per measurement; small buffers are repeated until this much is done.
+static const size_t BYTES_PER_RUN = 64 * 1024 * 1024;
+
+// Keeps results alive so that the compiler cannot drop the calls.
+static volatile uint32_t g_sink;
+
+// The per-byte loop OpenBSC::CalculateBCC uses.
+static uint8_t bccByteLoop(const uint8_t* data, size_t length)
+{
+    uint8_t bcc = 0;
+    for (size_t i = 0; i < length; ++i)
+        bcc ^= data[i];
+    return bcc;
+}
+
+static double megabytesPerSecond(const std::function<uint32_t(const uint8_t*, size_t)>& kernel, const std::vector<uint8_t>& buffer,
+                                 size_t size)
+{
+    size_t   repeats = BYTES_PER_RUN / size;
+    uint32_t sink    = 0;
+    auto     start   = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < repeats; ++r)
+        sink += kernel(buffer.data(), size);
+
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    g_sink       = sink;
+    return static_cast<double>(repeats * size) / elapsed / 1e6;
+}
+
+int main(int argc, char* argv[])
+{
+    const size_t sizes[] = {16, 64, 1024, 64 * 1024};
+
+    struct Kernel
+    {
+        const char*                                    name;
+        std::function<uint32_t(const uint8_t*, size_t)> run;
+    };
+    const Kernel kernels[] = {
+        {"bcc-byte", [](const uint8_t* p, size_t n) { return uint32_t(bccByteLoop(p, n)); }},
+        {"bcc", [](const uint8_t* p, size_t n) { return uint32_t(ChecksumBcc(p, n)); }},
+        {"lrc", [](const uint8_t* p, size_t n) { return uint32_t(ChecksumLrc(p, n)); }},
+        {"crc16-modbus", [](const uint8_t* p, size_t n) { return uint32_t(ChecksumCrc16(Crc16::Modbus, p, n)); }},
+        {"crc16-xmodem", [](const uint8_t* p, size_t n) { return uint32_t(ChecksumCrc16(Crc16::Xmodem, p, n)); }},
+        {"crc32", [](const uint8_t* p, size_t n) { return ChecksumCrc32(p, n); }},
+    };
+
+    // A single algorithm may be named on the command line.
+    const char* only = argc > 1 ? argv[1] : nullptr;
+
+    std::vector<uint8_t> buffer(sizes[sizeof(sizes) / sizeof(sizes[0]) - 1]);
+    std::srand(1);
+    for (uint8_t& byte : buffer)
+        byte = static_cast<uint8_t>(std::rand());
+
+    ChecksumLevel supported = ChecksumSupportedLevel();
+    std::printf("supported level: %s\n", ChecksumLevelName(supported));
+    std::printf("%-14s %-12s", "algorithm", "level");
+    for (size_t size : sizes)
+        std::printf(" %9zu B", size);
+    std::printf("   (MB/s)\n");
+
+    for (const Kernel& kernel : kernels)
+    {
+        if (only && std::string(only) != kernel.name)
+            continue;
+
+        for (int level = 0; level <= static_cast<int>(supported); ++level)
+        {
+            ChecksumSetLevel(static_cast<ChecksumLevel>(level));
+            std::printf("%-14s %-12s", kernel.name, ChecksumLevelName(ChecksumActiveLevel()));
+            for (size_t size : sizes)
+                std::printf(" %11.0f", megabytesPerSecond(kernel.run, buffer, size));
+            std::printf("\n");
+
+            // The byte loop does not depend on the level.
+            if (std::string(kernel.name) == "bcc-byte")
+                break;
+        }
+    }
+
+    ChecksumSetLevel(supported);
+    return 0;
+}
@@ -0,0 +1,68 @@
+#ifndef PTY_PAIR_HPP
+#define PTY_PAIR_HPP
+
+#include <string>
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <termios.h>
+#include <unistd.h>
+
+/**
+ * @brief Pseudo-terminal pair standing in for a serial adapter during benchmarks
+ *
+ * The slave path is opened by SerialCommunication like any tty; the benchmark plays
+ * the device on the master side.
+ */
+class PtyPair
+{
+public:
+    PtyPair() : master_(-1)
+    {
+        master_ = ::posix_openpt(O_RDWR | O_NOCTTY);
+        if (master_ < 0 || ::grantpt(master_) != 0 || ::unlockpt(master_) != 0)
+            return;
+
+        const char* name = ::ptsname(master_);
+        if (name)
+            slave_ = name;
+
+        // Raw mode on the master so that bytes pass through untouched.
+        struct termios tty;
+        if (::tcgetattr(master_, &tty) == 0)
+        {
+            ::cfmakeraw(&tty);
+            ::tcsetattr(master_, TCSANOW, &tty);
+        }
+    }
+
+    ~PtyPair()
+    {
+        if (master_ >= 0)
+            ::close(master_);
+    }
+
+    PtyPair(const PtyPair&)            = delete;
+    PtyPair& operator=(const PtyPair&) = delete;
+
+    bool Valid() const
+    {
+        return master_ >= 0 && !slave_.empty();
+    }
+
+    int Master() const
+    {
+        return master_;
+    }
+
+    const std::string& SlaveName() const
+    {
+        return slave_;
+    }
+
+private:
+    int         master_;
+    std::string slave_;
+};
+
+#endif // PTY_PAIR_HPP
@@ -0,0 +1,149 @@
+/**
+ * @file SerialBackendBench.cpp
+ * @brief Compares the poll and io_uring SerialCommunication backends over pty pairs
+ */
+
+#include "PtyPair.hpp"
+#include "Serial.hpp"
+#include "SerialUring.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+static const size_t PAYLOAD_SIZE = 16;
+
+struct Fleet
+{
+    std::vector<std::unique_ptr<PtyPair>>             pairs;
+    std::vector<std::shared_ptr<SerialCommunication>> ports;
+};
+
+static bool openFleet(Fleet& fleet, size_t count, SerialBackend backend)
+{
+    SerialOptions options;
+    options.backend = backend;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        std::unique_ptr<PtyPair> pair(new PtyPair());
+        if (!pair->Valid())
+            return false;
+
+        auto port = SerialCommunication::Create(pair->SlaveName(), 115200, 8, 1, 'N', false, false, options);
+        if (!port)
+            return false;
+
+        fleet.pairs.push_back(std::move(pair));
+        fleet.ports.push_back(port);
+    }
+    return true;
+}
+
+static void feed(Fleet& fleet)
+{
+    static const uint8_t payload[PAYLOAD_SIZE] = {0};
+    for (auto& pair : fleet.pairs)
+        (void)!::write(pair->Master(), payload, sizeof(payload));
+}
+
+// One Read() call per port per round, the way a polling gateway services its ports.
+static double perPortReads(Fleet& fleet, size_t rounds)
+{
+    uint8_t buffer[PAYLOAD_SIZE];
+    auto    start = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        feed(fleet);
+        for (auto& port : fleet.ports)
+        {
+            size_t got = 0;
+            while (got < PAYLOAD_SIZE)
+                got += port->Read(buffer + got, PAYLOAD_SIZE - got, 100);
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(rounds * fleet.ports.size());
+}
+
+// All ports read through one io_uring submission per round.
+static double batchedReads(Fleet& fleet, size_t rounds)
+{
+    UringRing* ring = UringRing::ForThisThread();
+    if (!ring)
+        return 0.0;
+
+    std::vector<uint8_t>                  buffers(fleet.ports.size() * PAYLOAD_SIZE);
+    std::vector<UringRing::ReadRequest>   requests(fleet.ports.size());
+    std::vector<size_t>                   got(fleet.ports.size());
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (size_t r = 0; r < rounds; ++r)
+    {
+        feed(fleet);
+        std::fill(got.begin(), got.end(), 0);
+
+        size_t done = 0;
+        while (done < fleet.ports.size())
+        {
+            size_t pending = 0;
+            for (size_t i = 0; i < fleet.ports.size(); ++i)
+            {
+                if (got[i] == PAYLOAD_SIZE)
+                    continue;
+                requests[pending++] = {fleet.ports[i]->NativeHandle(), &buffers[i * PAYLOAD_SIZE + got[i]], PAYLOAD_SIZE - got[i], 0};
+            }
+
+            ring->ReadBatch(requests.data(), pending, 100);
+
+            for (size_t i = 0, j = 0; i < fleet.ports.size(); ++i)
+            {
+                if (got[i] == PAYLOAD_SIZE)
+                    continue;
+                if (requests[j].result > 0)
+                {
+                    got[i] += static_cast<size_t>(requests[j].result);
+                    if (got[i] == PAYLOAD_SIZE)
+                        ++done;
+                }
+                ++j;
+            }
+        }
+    }
+
+    auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return elapsed / static_cast<double>(rounds * fleet.ports.size());
+}
+
+int main(int argc, char* argv[])
+{
+    size_t rounds = argc > 1 ? std::strtoul(argv[1], nullptr, 0) : 2000;
+
+    if (!UringRing::Available())
+        std::printf("io_uring unavailable: IoUring rows use the poll fallback\n");
+
+    std::printf("%-10s %6s %14s\n", "backend", "ports", "ns/read");
+
+    const size_t portCounts[] = {1, 16, 64};
+    for (size_t count : portCounts)
+    {
+        Fleet poll, uring;
+        if (!openFleet(poll, count, SerialBackend::Poll) || !openFleet(uring, count, SerialBackend::IoUring))
+        {
+            std::fprintf(stderr, "Failed to open %zu pty pairs\n", count);
+            return 1;
+        }
+
+        std::printf("%-10s %6zu %14.0f\n", "poll", count, perPortReads(poll, rounds));
+        std::printf("%-10s %6zu %14.0f\n", "io_uring", count, perPortReads(uring, rounds));
+        if (UringRing::Available())
+            std::printf("%-10s %6zu %14.0f\n", "batch", count, batchedReads(uring, rounds));
+    }
+
+    return 0;
+}
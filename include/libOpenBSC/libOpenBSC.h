@@ -38,7 +38,9 @@ extern "C"
         PORT_NOT_FOUND,
         PORT_OPEN_FAILED,
         CONFIG_FAILED,
-        SEND_FAILED
+        SEND_FAILED,
+        IO_FAILED,         ///< The port reported an error while waiting for the response.
+        PORT_DISCONNECTED  ///< The device went away (unplugged or hung up).
     };
 
     /**
@@ -52,6 +54,8 @@ extern "C"
 
     /**
      * @brief Structure representing a list of communication ports.
+     *
+     * Holds the first 10 ports only; OpenBSCSDKListPorts returns all of them.
      */
     struct ComPortList_s
     {
@@ -62,12 +66,119 @@ extern "C"
         } ComPort[10];       ///< Fixed-size array holding up to 10 communication port entries.
     };
 
+    /**
+     * @brief Communication port with the identity of the USB device behind it.
+     */
+    struct ComPortInfo_s
+    {
+        const char *name;         ///< Name of the communication port.
+        const char *serial;       ///< Path to pass to OpenBSCSDKInit and OpenBSCSDKOpen.
+        const char *serialNumber; ///< USB serial number, "" if unknown.
+        uint16_t    vendorId;     ///< USB Vendor ID, 0 if not a USB device.
+        uint16_t    productId;    ///< USB Product ID, 0 if not a USB device.
+    };
+
+    /**
+     * @brief List of communication ports of any length, released with OpenBSCSDKFreePortList.
+     */
+    struct ComPortInfoList_s
+    {
+        struct ComPortInfo_s *ports; ///< Array of count entries.
+        uint32_t              count; ///< Number of entries in ports.
+    };
+
+    /**
+     * @brief Settings of OpenBSCSDKDiscover; NULL or zero fields select the defaults in brackets.
+     */
+    struct DiscoverConfig_s
+    {
+        const char *command;   ///< Identify command sent to every port ["V"].
+        uint32_t    timeoutMs; ///< One deadline for all ports [1000].
+        uint32_t    baudRate;  ///< Serial settings, as for OpenBSCSDKInit [115200 8N1, no RTS/DTR].
+        uint8_t     byte_size;
+        uint8_t     stop_bits;
+        char        parity;
+        bool        use_rts;
+        bool        use_dtr;
+        uint16_t    VID;       ///< Filter of the enumerated ports when no port list is given, 0 = any [0].
+        uint16_t    PID;
+    };
+
+    /**
+     * @brief What one port answered to the identify command.
+     */
+    struct DiscoveredPort_s
+    {
+        const char      *serial;    ///< Port that was probed.
+        enum errorList_e error;     ///< NONE if it answered, NO_DATA_RECEIVED if it stayed silent.
+        const char      *answer;    ///< Response payload, "" unless error is NONE.
+        uint32_t         latencyUs; ///< From the command to its response.
+    };
+
+    /**
+     * @brief Results of OpenBSCSDKDiscover, released with OpenBSCSDKFreeDiscovery.
+     */
+    struct DiscoveryList_s
+    {
+        struct DiscoveredPort_s *ports; ///< Array of count entries, in probe order.
+        uint32_t                 count; ///< Number of entries in ports.
+    };
+
+    /**
+     * @brief Receives ports plugged in (added = true) or out, see OpenBSCSDKWatchPorts.
+     *
+     * Runs on a library-owned thread; port is valid only during the call.
+     */
+    typedef void (*OpenBSCPortEventCallback)(bool added, const struct ComPortInfo_s *port, void *userData);
+
+    /**
+     * @brief Number of buckets of the latency histograms in OpenBSCStats_s.
+     */
+#define OPENBSC_HISTOGRAM_BUCKETS 24
+
+    /**
+     * @brief Counters of the SDK session and of its serial port.
+     *
+     * Histogram bucket 0 counts durations below 2 us, bucket i durations in
+     * [2^i, 2^(i+1)) microseconds; the last bucket also counts longer ones.
+     */
+    struct OpenBSCStats_s
+    {
+        uint64_t commandsSent;                          ///< Commands written completely.
+        uint64_t responsesReceived;                     ///< Valid response frames.
+        uint64_t bccErrors;                             ///< Frames dropped because of a bad BCC.
+        uint64_t responseTimeouts;                      ///< Responses that did not arrive in time.
+        uint64_t responseUs[OPENBSC_HISTOGRAM_BUCKETS]; ///< Time from command to response.
+
+        uint64_t bytesIn;                               ///< Bytes received from the port.
+        uint64_t bytesOut;                              ///< Bytes handed to the port.
+        uint64_t readCalls;                             ///< Device read operations.
+        uint64_t writeCalls;                            ///< Device write operations.
+        uint64_t pollWakeups;                           ///< Readiness waits that returned.
+        uint64_t timeouts;                              ///< Waits that ended without the port becoming ready.
+        uint64_t partialWrites;                         ///< Writes the port accepted only in part.
+        uint64_t errors;                                ///< Device operations that failed.
+        uint64_t droppedBytes;                          ///< Queued write bytes discarded on close.
+        uint64_t readWaitUs[OPENBSC_HISTOGRAM_BUCKETS]; ///< Time blocked in reads.
+        uint64_t writeUs[OPENBSC_HISTOGRAM_BUCKETS];    ///< Duration of device writes.
+    };
+
     BSC_SDK_EXPORT struct ComPortList_s    listPortSDK(uint16_t VID, uint16_t PID);
+    BSC_SDK_EXPORT struct ComPortInfoList_s OpenBSCSDKListPorts(uint16_t VID, uint16_t PID);
+    BSC_SDK_EXPORT void                    OpenBSCSDKFreePortList(struct ComPortInfoList_s *list);
+    BSC_SDK_EXPORT int                     OpenBSCSDKWatchPorts(uint16_t VID, uint16_t PID, OpenBSCPortEventCallback callback, void *userData);
+    BSC_SDK_EXPORT void                    OpenBSCSDKUnwatchPorts(int watchId);
+    BSC_SDK_EXPORT struct DiscoveryList_s  OpenBSCSDKDiscover(const struct DiscoverConfig_s *config, const char *const *ports, uint32_t portCount);
+    BSC_SDK_EXPORT void                    OpenBSCSDKFreeDiscovery(struct DiscoveryList_s *list);
     BSC_SDK_EXPORT enum errorList_e        OpenBSCSDKInit(const char* comSerial, uint32_t baudRate, uint8_t byte_size, uint8_t stop_bits, char parity, bool use_rts,
                                                                 bool use_dtr);
     BSC_SDK_EXPORT enum errorList_e        OpenBSCSDKOpen(const char *comSerial);
     BSC_SDK_EXPORT void                    OpenBSCSDKClose(void);
     BSC_SDK_EXPORT struct CommandOutcome_s OpenBSCSDKSend(const char *cmd);
+    BSC_SDK_EXPORT size_t                  OpenBSCSDKSendBatch(const char *const *cmds, const uint32_t *lens, size_t count, struct CommandOutcome_s *outcomes,
+                                                               uint32_t timeoutMs);
+    BSC_SDK_EXPORT enum errorList_e        OpenBSCSDKGetStats(struct OpenBSCStats_s *stats);
+    BSC_SDK_EXPORT void                    OpenBSCSDKResetStats(void);
 
 #ifdef __cplusplus
 }
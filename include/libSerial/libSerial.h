@@ -28,6 +28,123 @@ struct SerialCommPortList {
     size_t  count;
 };
 
+/**
+ * @brief One serial port and the USB device behind it.
+ * 
+ * Strings are never NULL; the USB fields are "", 0 or -1 for ports not on a USB device.
+ * 
+ * @struct SerialCommPortInfo
+ * @param device          Path to pass to SerialCommInit, e.g. "/dev/ttyUSB0".
+ * @param name            Kernel name of the port, e.g. "ttyUSB0".
+ * @param driver          Kernel driver, e.g. "ftdi_sio".
+ * @param serialNumber    USB serial number string.
+ * @param manufacturer    USB manufacturer string.
+ * @param product         USB product string.
+ * @param vendorId        USB vendor ID.
+ * @param productId       USB product ID.
+ * @param interfaceNumber USB interface of the port.
+ */
+struct SerialCommPortInfo {
+    const char* device;
+    const char* name;
+    const char* driver;
+    const char* serialNumber;
+    const char* manufacturer;
+    const char* product;
+    uint16_t    vendorId;
+    uint16_t    productId;
+    int         interfaceNumber;
+};
+
+/**
+ * @brief List of ports returned by SerialCommListPortInfo.
+ * 
+ * @struct SerialCommPortInfoList
+ * @param ports Array of @c count entries.
+ * @param count Number of entries in @c ports.
+ */
+struct SerialCommPortInfoList {
+    struct SerialCommPortInfo* ports;
+    size_t                     count;
+};
+
+/**
+ * @brief One segment of a gather write.
+ * 
+ * @struct SerialCommIoVec
+ * @param base   Start of the segment.
+ * @param length Length of the segment in bytes.
+ */
+struct SerialCommIoVec {
+    const void* base;
+    size_t      length;
+};
+
+/**
+ * @brief Destination of one element of SerialCommReadMany.
+ * 
+ * @struct SerialCommBuffer
+ * @param base   Start of the buffer.
+ * @param length Capacity of the buffer in bytes.
+ */
+struct SerialCommBuffer {
+    void*  base;
+    size_t length;
+};
+
+/**
+ * @brief Settings of one port for SerialCommInitMany, as passed to SerialCommInit.
+ * 
+ * @struct SerialCommPortConfig
+ */
+struct SerialCommPortConfig {
+    const char* portSerial;
+    uint32_t    baudRate;
+    uint8_t     dataBits;
+    uint8_t     stopBits;
+    char        parity;
+    bool        enableRts;
+    bool        enableDtr;
+};
+
+/**
+ * @brief Number of buckets of the latency histograms in SerialCommStats.
+ */
+#define SERIAL_COMM_HISTOGRAM_BUCKETS 24
+
+/**
+ * @brief Counters and latency histograms of one serial instance.
+ * 
+ * Histogram bucket 0 counts durations below 2 us, bucket i durations in
+ * [2^i, 2^(i+1)) microseconds; the last bucket also counts longer ones.
+ * 
+ * @struct SerialCommStats
+ * @param bytesIn        Bytes received from the device.
+ * @param bytesOut       Bytes handed to the device.
+ * @param readCalls      Device read operations.
+ * @param writeCalls     Device write operations.
+ * @param pollWakeups    Readiness waits that returned.
+ * @param timeouts       Waits that ended without the port becoming ready.
+ * @param partialWrites  Writes the device accepted only in part.
+ * @param errors         Device operations that failed.
+ * @param droppedBytes   Queued write bytes discarded because closing could not send them.
+ * @param readWaitUs     Histogram of time blocked in reads.
+ * @param writeUs        Histogram of device write durations.
+ */
+struct SerialCommStats {
+    uint64_t bytesIn;
+    uint64_t bytesOut;
+    uint64_t readCalls;
+    uint64_t writeCalls;
+    uint64_t pollWakeups;
+    uint64_t timeouts;
+    uint64_t partialWrites;
+    uint64_t errors;
+    uint64_t droppedBytes;
+    uint64_t readWaitUs[SERIAL_COMM_HISTOGRAM_BUCKETS];
+    uint64_t writeUs[SERIAL_COMM_HISTOGRAM_BUCKETS];
+};
+
 /**
  * @enum SerialCommError
  * @brief Error codes for serial operations.
@@ -42,27 +159,133 @@ struct SerialCommPortList {
  *   Failed to open port.
  * @var SCErrorNoData
  *   No data available.
+ * @var SCErrorTimeout
+ *   The port accepted no data before the write timeout.
+ * @var SCErrorNotOpen
+ *   The port is closed.
+ * @var SCErrorIoFailed
+ *   The device reported an error, see SerialCommGetLastSystemError.
+ * @var SCErrorDisconnected
+ *   The device went away (unplugged or hung up).
  */
 typedef enum {
     SCErrorNone = 0,
     SCErrorInvalidFormat,
     SCErrorPortNotFound,
     SCErrorOpenFailed,
-    SCErrorNoData
+    SCErrorNoData,
+    SCErrorTimeout,
+    SCErrorNotOpen,
+    SCErrorIoFailed,
+    SCErrorDisconnected
 } SerialCommError;
 
+/**
+ * @brief Receives bytes pushed by SerialCommSetRxCallback.
+ *
+ * Runs on a library-owned I/O thread. data is valid only during the call; length is
+ * never 0 and at most SERIAL_COMM_RX_BATCH_SIZE.
+ */
+typedef void (*SerialCommRxCallback)(int instanceId, const uint8_t* data, size_t length, void* userData);
+
+/**
+ * @brief Largest batch handed to a SerialCommRxCallback.
+ */
+#define SERIAL_COMM_RX_BATCH_SIZE 16384
+
+/**
+ * @brief Change reported to a SerialCommPortEventCallback.
+ */
+typedef enum {
+    SCPortAdded = 0,
+    SCPortRemoved
+} SerialCommPortEvent;
+
+/**
+ * @brief Receives ports that appear or disappear, see SerialCommWatchPorts.
+ *
+ * Runs on a library-owned monitor thread, one call at a time. port and its strings are
+ * valid only during the call; for SCPortRemoved they describe the port as it was.
+ */
+typedef void (*SerialCommPortEventCallback)(SerialCommPortEvent event, const struct SerialCommPortInfo* port, void* userData);
+
 /**
  * @brief Enumerate available serial ports.
+ *
+ * The port list is cached and scanned again only when the set of devices changes.
+ * Release the result with SerialCommFreePortList.
  * 
- * @param[in]  vendorId   USB vendor ID filter.
- * @param[in]  productId  USB product ID filter.
+ * @param[in]  vendorId   USB vendor ID filter, 0 = any.
+ * @param[in]  productId  USB product ID filter, 0 = any.
  * @return     SerialCommPortList List of matching ports.
  */
 BSC_SDK_EXPORT SerialCommPortList SerialCommListPorts(uint16_t vendorId,
                                                      uint16_t productId);
 
+/**
+ * @brief Release a list returned by SerialCommListPorts and empty it.
+ * 
+ * @param[in]  list  List to release; NULL is ignored.
+ */
+BSC_SDK_EXPORT void SerialCommFreePortList(struct SerialCommPortList* list);
+
+/**
+ * @brief Enumerate available serial ports with the identity of their USB devices.
+ *
+ * Same ports as SerialCommListPorts. Release the result with SerialCommFreePortInfoList.
+ * 
+ * @param[in]  vendorId   USB vendor ID filter, 0 = any.
+ * @param[in]  productId  USB product ID filter, 0 = any.
+ * @return     SerialCommPortInfoList List of matching ports.
+ */
+BSC_SDK_EXPORT struct SerialCommPortInfoList SerialCommListPortInfo(uint16_t vendorId,
+                                                                   uint16_t productId);
+
+/**
+ * @brief Release a list returned by SerialCommListPortInfo and empty it.
+ * 
+ * @param[in]  list  List to release; NULL is ignored.
+ */
+BSC_SDK_EXPORT void SerialCommFreePortInfoList(struct SerialCommPortInfoList* list);
+
+/**
+ * @brief Report serial ports of a device type as they are plugged in and out.
+ *
+ * Listens to kernel hot-plug events. While any watch exists the port list is kept up to
+ * date from the events, so SerialCommListPorts and SerialCommPortExists never rescan.
+ * 
+ * @param[in]   vendorId    USB vendor ID filter, 0 = any.
+ * @param[in]   productId   USB product ID filter, 0 = any.
+ * @param[in]   callback    Called for every matching port that comes or goes.
+ * @param[in]   userData    Passed to callback unchanged.
+ * @return      int Watch ID (> 0), 0 if hot-plug events are not available (e.g. Windows).
+ */
+BSC_SDK_EXPORT int SerialCommWatchPorts(uint16_t vendorId, uint16_t productId,
+                                        SerialCommPortEventCallback callback, void* userData);
+
+/**
+ * @brief Stop a watch of SerialCommWatchPorts.
+ *
+ * When it returns, the callback of the watch is not running and will not run again, unless
+ * it is called from inside that callback.
+ * 
+ * @param[in]   watchId     ID from SerialCommWatchPorts.
+ */
+BSC_SDK_EXPORT void SerialCommUnwatchPorts(int watchId);
+
+/**
+ * @brief Check whether a port exists, without enumerating the ports.
+ * 
+ * @param[in]   device      Port path, e.g. "/dev/ttyUSB0".
+ * @return      bool true if the port is present.
+ */
+BSC_SDK_EXPORT bool SerialCommPortExists(const char* device);
+
 /**
  * @brief Initialize a serial instance.
+ *
+ * All functions may be called from several threads; calls on different instances do not
+ * block each other.
  * 
  * @param[in]   baudRate    Connection speed.
  * @param[in]   dataBits    Number of data bits.
@@ -83,6 +306,23 @@ BSC_SDK_EXPORT int SerialCommInit(uint32_t        baudRate,
                                  const char*     portSerial,
                                  SerialCommError* outError);
 
+/**
+ * @brief Open and configure several ports in parallel.
+ *
+ * Elements are independent: one port failing does not affect the others. Instance IDs
+ * are assigned in the order of configs.
+ * 
+ * @param[in]   configs    Port settings.
+ * @param[in]   count      Number of elements in configs.
+ * @param[out]  outIds     Receives the instance ID of each element, -1 on failure.
+ * @param[out]  outErrors  Optional, receives the error code of each element.
+ * @return      size_t Number of ports opened.
+ */
+BSC_SDK_EXPORT size_t SerialCommInitMany(const struct SerialCommPortConfig* configs,
+                                         size_t                             count,
+                                         int*                               outIds,
+                                         SerialCommError*                   outErrors);
+
 /**
  * @brief Close the port without destroying the instance.
  * 
@@ -93,6 +333,8 @@ BSC_SDK_EXPORT SerialCommError SerialCommClose(int instanceId);
 
 /**
  * @brief Destroy a serial instance.
+ *
+ * The ID stays invalid afterwards, even when a new instance reuses its slot.
  * 
  * @param[in]  instanceId  ID from SerialCommInit.
  * @return     SerialCommError Error code.
@@ -121,6 +363,51 @@ BSC_SDK_EXPORT size_t SerialCommWrite(int             instanceId,
                                      size_t          length,
                                      SerialCommError* outError);
 
+/**
+ * @brief Write several buffers in one call, without joining them first.
+ * 
+ * @param[in]   instanceId  ID from SerialCommInit.
+ * @param[in]   segments    Array of segments to send in order.
+ * @param[in]   count       Number of segments.
+ * @param[out]  outError    Error code output.
+ * @return      size_t      Total number of bytes written.
+ */
+BSC_SDK_EXPORT size_t SerialCommWriteV(int                            instanceId,
+                                      const struct SerialCommIoVec* segments,
+                                      size_t                         count,
+                                      SerialCommError*               outError);
+
+/**
+ * @brief Write one buffer to each of several instances in parallel.
+ *
+ * To broadcast, point every element of buffers at the same data.
+ * 
+ * @param[in]   instanceIds  IDs from SerialCommInit.
+ * @param[in]   buffers      Data to write to the instance at the same index.
+ * @param[in]   count        Number of elements.
+ * @param[out]  outWritten   Optional, receives the bytes written per element.
+ * @param[out]  outErrors    Optional, receives the error code per element.
+ * @return      size_t Number of elements written completely.
+ */
+BSC_SDK_EXPORT size_t SerialCommWriteMany(const int*                    instanceIds,
+                                          const struct SerialCommIoVec* buffers,
+                                          size_t                        count,
+                                          size_t*                       outWritten,
+                                          SerialCommError*              outErrors);
+
+/**
+ * @brief Wait until queued write data has been handed to the driver.
+ * 
+ * SerialCommWrite returns once the data is accepted; bytes the driver could not take
+ * immediately stay in a per-port queue. On Linux a library thread sends them as soon as
+ * the port becomes writable; this call waits until that has happened.
+ * 
+ * @param[in]  instanceId  ID from SerialCommInit.
+ * @param[in]  timeoutMs   Maximum wait in milliseconds.
+ * @return     SerialCommError Error code; SCErrorNoData if data is still queued at timeout.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommDrain(int instanceId, uint32_t timeoutMs);
+
 /**
  * @brief Read data from the serial port.
  * 
@@ -135,6 +422,136 @@ BSC_SDK_EXPORT size_t SerialCommRead(int       instanceId,
                                     size_t    length,
                                     SerialCommError* outError);
 
+/**
+ * @brief Read from several instances concurrently until one shared deadline.
+ *
+ * Each element returns as soon as its instance has data, like SerialCommRead; an
+ * element with nothing received by the deadline reports SCErrorNoData. List each
+ * instance at most once.
+ * 
+ * @param[in]   instanceIds  IDs from SerialCommInit.
+ * @param[in]   buffers      Destination of the instance at the same index.
+ * @param[in]   count        Number of elements.
+ * @param[in]   timeoutMs    Time from the call until the shared deadline.
+ * @param[out]  outRead      Receives the bytes read per element.
+ * @param[out]  outErrors    Optional, receives the error code per element.
+ * @return      size_t Number of elements that received data.
+ */
+BSC_SDK_EXPORT size_t SerialCommReadMany(const int*                     instanceIds,
+                                         const struct SerialCommBuffer* buffers,
+                                         size_t                         count,
+                                         uint32_t                       timeoutMs,
+                                         size_t*                        outRead,
+                                         SerialCommError*               outErrors);
+
+/**
+ * @brief Read exactly @p length bytes, waiting at most @p timeoutMs in total.
+ * 
+ * @param[in]   instanceId  ID from SerialCommInit.
+ * @param[out]  buffer      Buffer to receive data.
+ * @param[in]   length      Number of bytes wanted.
+ * @param[in]   timeoutMs   Total time budget in milliseconds, not reset by partial reads.
+ * @param[out]  outError    Error code output; SCErrorNoData if fewer bytes arrived in time.
+ * @return      size_t      Number of bytes read.
+ */
+BSC_SDK_EXPORT size_t SerialCommReadExact(int              instanceId,
+                                         void*            buffer,
+                                         size_t           length,
+                                         uint32_t         timeoutMs,
+                                         SerialCommError* outError);
+
+/**
+ * @brief Read up to and including @p delimiter, waiting at most @p timeoutMs in total.
+ * 
+ * Bytes received after the delimiter are returned by the next read call.
+ * 
+ * @param[in]   instanceId  ID from SerialCommInit.
+ * @param[out]  buffer      Buffer to receive data.
+ * @param[in]   maxLength   Capacity of @p buffer.
+ * @param[in]   delimiter   Byte that ends the read.
+ * @param[in]   timeoutMs   Total time budget in milliseconds.
+ * @param[out]  outError    Error code output; SCErrorNoData if the delimiter was not received
+ *                          before the timeout or within @p maxLength bytes.
+ * @return      size_t      Number of bytes stored, including the delimiter.
+ */
+BSC_SDK_EXPORT size_t SerialCommReadUntil(int              instanceId,
+                                         void*            buffer,
+                                         size_t           maxLength,
+                                         uint8_t          delimiter,
+                                         uint32_t         timeoutMs,
+                                         SerialCommError* outError);
+
+/**
+ * @brief Enable or disable low-latency mode (ASYNC_LOW_LATENCY and USB-serial latency timer).
+ * 
+ * Original settings are restored when disabled or when the port is closed.
+ * 
+ * @param[in]  instanceId  ID from SerialCommInit.
+ * @param[in]  enable      true to enable low-latency mode.
+ * @return     SerialCommError Error code; SCErrorOpenFailed if the driver supports neither setting.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommSetLowLatency(int instanceId, bool enable);
+
+/**
+ * @brief Configure driver-side read batching (termios VMIN/VTIME).
+ * 
+ * With @p minBytes only, reads wait until that many bytes are buffered. With an
+ * inter-byte timeout as well, a read completes after @p minBytes bytes or once the line
+ * stays idle for the timeout after the first byte. The read timeouts still apply.
+ * 
+ * @param[in]  instanceId        ID from SerialCommInit.
+ * @param[in]  minBytes          Bytes to collect before a read completes (0 = return immediately).
+ * @param[in]  interByteTimeout  Inter-byte timer in tenths of a second (0 = none).
+ * @return     SerialCommError   Error code.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommSetReadMode(int instanceId, uint8_t minBytes, uint8_t interByteTimeout);
+
+/**
+ * @brief Baud rate actually applied by the driver.
+ * 
+ * @param[in]  instanceId  ID from SerialCommInit.
+ * @return     uint32_t    Rate in bits per second, 0 for an invalid instance.
+ */
+BSC_SDK_EXPORT uint32_t SerialCommGetActualBaudRate(int instanceId);
+
+/**
+ * @brief Copy the counters and histograms of an instance.
+ * 
+ * @param[in]   instanceId  ID from SerialCommInit.
+ * @param[out]  stats       Receives the current values.
+ * @return      SerialCommError Error code.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommGetStats(int instanceId, struct SerialCommStats* stats);
+
+/**
+ * @brief Zero the counters and histograms of an instance.
+ * 
+ * @param[in]  instanceId  ID from SerialCommInit.
+ * @return     SerialCommError Error code.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommResetStats(int instanceId);
+
+/**
+ * @brief Push received data to a callback instead of polling SerialCommRead.
+ *
+ * A library-owned I/O thread drains the port on every wakeup and invokes the callback
+ * once per batch, so several chunks that arrived together are delivered in one call.
+ * Do not call SerialCommRead on the instance while a callback is set. Closing the port
+ * removes the callback.
+ *
+ * Each read and callback holds the instance like any other call, so SerialCommClose,
+ * SerialCommOpen and SerialCommDeinit wait for them to finish. Called from inside the
+ * callback of the same instance, those three return SCErrorInvalidFormat instead.
+ * 
+ * @param[in]  instanceId  ID from SerialCommInit.
+ * @param[in]  callback    Function to call, NULL to remove the current one.
+ * @param[in]  userData    Passed unchanged to callback.
+ * @return     SerialCommError Error code; after removal returns, the callback is no longer running.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommSetRxCallback(int                  instanceId,
+                                                       SerialCommRxCallback callback,
+                                                       void*                userData);
+
 /**
  * @brief Flush port buffers.
  * 
@@ -143,6 +560,15 @@ BSC_SDK_EXPORT size_t SerialCommRead(int       instanceId,
  */
 BSC_SDK_EXPORT SerialCommError SerialCommFlush(int instanceId);
 
+/**
+ * @brief System error code behind the last SCErrorIoFailed or SCErrorDisconnected.
+ *
+ * Kept per thread.
+ * 
+ * @return     int errno (GetLastError() on Windows), 0 if the failure had none.
+ */
+BSC_SDK_EXPORT int SerialCommGetLastSystemError(void);
+
 #ifdef __cplusplus
 }
 #endif
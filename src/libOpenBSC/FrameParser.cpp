@@ -0,0 +1,123 @@
+#include "FrameParser.hpp"
+#include "SerialChecksum.hpp"
+#include <cstring>
+
+const uint8_t FrameParser::STX;
+const uint8_t FrameParser::ETX;
+
+/**
+ * @brief Constructs a parser waiting for the first STX.
+ * @param maxPayload Largest payload accepted
+ */
+FrameParser::FrameParser(size_t maxPayload) : state_(State::WaitStx), bcc_(0), maxPayload_(maxPayload)
+{
+    payload_.reserve(maxPayload_);
+}
+
+/**
+ * @brief Drops any partial frame.
+ */
+void FrameParser::Reset()
+{
+    state_ = State::WaitStx;
+    bcc_   = 0;
+    payload_.clear();
+}
+
+/**
+ * @brief Advances the state machine over the given bytes.
+ * @param data Received bytes
+ * @param length Number of received bytes
+ * @param result Set to Frame/BadBcc when a frame ends, NeedMore otherwise
+ * @return Number of bytes consumed
+ */
+size_t FrameParser::Feed(const uint8_t* data, size_t length, Result& result)
+{
+    size_t i = 0;
+    result   = Result::NeedMore;
+
+    while (i < length)
+    {
+        switch (state_)
+        {
+            case State::WaitStx:
+            {
+                const void* stx = std::memchr(data + i, STX, length - i);
+                if (!stx)
+                    return length;
+
+                i      = static_cast<const uint8_t*>(stx) - data + 1;
+                state_ = State::Payload;
+                bcc_   = 0;
+                payload_.clear();
+                break;
+            }
+
+            case State::Payload:
+            {
+                // Take the payload bytes up to the next ETX or STX as one run.
+                const uint8_t* begin = data + i;
+                const uint8_t* end   = data + length;
+                if (const void* etx = std::memchr(begin, ETX, end - begin))
+                    end = static_cast<const uint8_t*>(etx);
+                if (const void* stx = std::memchr(begin, STX, end - begin))
+                    end = static_cast<const uint8_t*>(stx);
+
+                size_t run  = end - begin;
+                size_t room = maxPayload_ - payload_.size();
+                if (run > room)
+                {
+                    // The first byte beyond the limit drops the frame.
+                    i += room + 1;
+                    Reset();
+                    break;
+                }
+
+                payload_.insert(payload_.end(), begin, end);
+                bcc_ = ChecksumBcc(begin, run, bcc_);
+                i += run;
+                if (i == length)
+                    break;
+
+                if (data[i++] == ETX)
+                {
+                    bcc_ ^= ETX;
+                    state_ = State::Bcc;
+                }
+                else
+                {
+                    // A new frame started before the previous one ended: resync on it.
+                    bcc_ = 0;
+                    payload_.clear();
+                }
+                break;
+            }
+
+            case State::Bcc:
+            {
+                uint8_t received = data[i++];
+                state_           = State::WaitStx;
+                result           = (received == bcc_) ? Result::Frame : Result::BadBcc;
+                return i;
+            }
+        }
+    }
+
+    return i;
+}
+
+/**
+ * @brief Returns the payload of the last completed frame.
+ */
+const uint8_t* FrameParser::Payload() const
+{
+    return payload_.data();
+}
+
+/**
+ * @brief Returns the payload length of the last completed frame.
+ */
+size_t FrameParser::PayloadLength() const
+{
+    return payload_.size();
+}
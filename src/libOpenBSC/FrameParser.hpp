@@ -0,0 +1,85 @@
+/**
+ * @file FrameParser.hpp
+ * @author Eduardo Abdala
+ * @brief Incremental parser for OpenBSC frames
+ * @version 0.1
+ * @date 2025-08-09
+ * @copyright Copyright (c) 2025
+ */
+#ifndef FRAME_PARSER_HPP
+#define FRAME_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Byte-stream state machine that extracts STX..ETX+BCC frames.
+ *
+ * Bytes are fed in arbitrary chunks. The parser stops consuming right after a
+ * complete frame so that trailing bytes can be kept for the next frame. Any
+ * garbage before STX is skipped, and an STX seen inside a payload restarts the
+ * frame (resynchronisation).
+ */
+class FrameParser
+{
+  public:
+    static const uint8_t STX = 0x02;
+    static const uint8_t ETX = 0x03;
+
+    /**
+     * @brief Outcome of a Feed() call.
+     */
+    enum class Result
+    {
+        NeedMore, ///< All input consumed, no complete frame yet.
+        Frame,    ///< A valid frame is available through Payload().
+        BadBcc    ///< A frame was terminated but its BCC did not match.
+    };
+
+    /**
+     * @brief Constructs a parser.
+     * @param[in] maxPayload: Largest payload accepted; longer frames are dropped.
+     */
+    explicit FrameParser(size_t maxPayload = 4096);
+
+    /**
+     * @brief Drops any partially parsed frame and waits for the next STX.
+     */
+    void Reset();
+
+    /**
+     * @brief Feeds received bytes into the state machine.
+     * @param[in] data: Pointer to the received bytes.
+     * @param[in] length: Number of bytes available in data.
+     * @param[out] result: Frame, BadBcc or NeedMore.
+     * @return Number of bytes consumed. Less than length only when a frame
+     *         (valid or not) finished before the end of the input.
+     */
+    size_t Feed(const uint8_t* data, size_t length, Result& result);
+
+    /**
+     * @brief Payload of the last completed frame (without STX, ETX and BCC).
+     */
+    const uint8_t* Payload() const;
+
+    /**
+     * @brief Length of the last completed frame's payload.
+     */
+    size_t PayloadLength() const;
+
+  private:
+    enum class State
+    {
+        WaitStx,
+        Payload,
+        Bcc
+    };
+
+    State                state_;
+    uint8_t              bcc_;
+    size_t               maxPayload_;
+    std::vector<uint8_t> payload_;
+};
+
+#endif // FRAME_PARSER_HPP
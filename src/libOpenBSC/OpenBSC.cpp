@@ -1,13 +1,22 @@
 #include "OpenBSC.hpp"
+#include <algorithm>
 #include <cstring>
 #include <iostream>
 #include <chrono>
 #include <thread>
 
-const uint16_t MAX_BUFF_SIZE = 1024;
 const uint8_t STX = 0x02;
 const uint8_t ETX = 0x03;
 
+// Frames per gather write of Pipeline(); three segments each keep it far below IOV_MAX.
+static const size_t PIPELINE_WRITE_BATCH = 64;
+
+// Longest Pipeline() blocks flushing queued command bytes before it looks for responses again
+static const unsigned int PIPELINE_FLUSH_SLICE_MS = 1;
+
+const size_t OpenBSC::PIPELINE_WINDOW;
+const uint32_t OpenBSC::SEND_TIMEOUT_MS;
+
 OpenBSC::OpenBSC() = default;
 
 /**
@@ -19,9 +28,11 @@ OpenBSC::OpenBSC() = default;
  * @param parity Parity ('N' = none, 'E' = even, 'O' = odd)
  * @param use_rts Enable RTS flow control
  * @param use_dtr Enable DTR flow control
+ * @param options Optional serial settings
  * @return true if initialization succeeded, false otherwise
  */
-bool OpenBSC::Init(const char* portName, uint32_t baudRate, uint8_t byte_size, uint8_t stop_bits, char parity, bool use_rts, bool use_dtr)
+bool OpenBSC::Init(const char* portName, uint32_t baudRate, uint8_t byte_size, uint8_t stop_bits, char parity, bool use_rts, bool use_dtr,
+                   const SerialOptions& options)
 {
     serial = SerialCommunication::Create(
         std::string(portName),
@@ -30,8 +41,11 @@ bool OpenBSC::Init(const char* portName, uint32_t baudRate, uint8_t byte_size, u
         stop_bits,
         parity,
         use_rts,
-        use_dtr
+        use_dtr,
+        options
     );
+    parser.Reset();
+    rxBegin = rxEnd = 0;
     return serial != nullptr;
 }
 
@@ -54,6 +68,7 @@ bool OpenBSC::Open(const char* comSerial)
  */
 uint8_t OpenBSC::CalculateBCC(const uint8_t* data, uint32_t length)
 {
+    // At command sizes this inlined loop beats calling ChecksumBcc (see checksum_bench).
     uint8_t bcc = 0;
     for (uint32_t i = 0; i < length; ++i)
         bcc ^= data[i];
@@ -64,29 +79,67 @@ uint8_t OpenBSC::CalculateBCC(const uint8_t* data, uint32_t length)
  * @brief Sends a command packet using OpenBSC protocol.
  * @param command Pointer to the command string
  * @param length Length of the command
+ * @param timeout_ms Time allowed for the whole frame to be handed to the port
  * @return true if the command was successfully sent, false otherwise
  */
-bool OpenBSC::SendCommand(const char* command, uint32_t length)
+bool OpenBSC::SendCommand(const char* command, uint32_t length, uint32_t timeout_ms)
 {
     if (!serial || !command || length == 0) return false;
 
-    uint8_t packet[MAX_BUFF_SIZE] = {0};
-    uint32_t packetSize = 0;
+    // Header, payload and trailer go out in one gather write: no packet copy, no size cap.
+    uint8_t header     = STX;
+    uint8_t trailer[2] = {ETX, 0};
+    trailer[1]         = CalculateBCC(reinterpret_cast<const uint8_t*>(command), length) ^ ETX;
 
-    packet[packetSize++] = STX;
-    std::memcpy(&packet[packetSize], command, length);
-    packetSize += length;
-    packet[packetSize++] = ETX;
+    iovec segments[3];
+    segments[0].iov_base = &header;
+    segments[0].iov_len  = 1;
+    segments[1].iov_base = const_cast<char*>(command);
+    segments[1].iov_len  = length;
+    segments[2].iov_base = trailer;
+    segments[2].iov_len  = sizeof(trailer);
 
-    uint8_t bcc = CalculateBCC(&packet[1], length + 1);
-    packet[packetSize++] = bcc;
+    ioResult = serial->TryWriteV(segments, 3);
+    if (!ioResult || ioResult.bytes != length + 1 + sizeof(trailer)) return false;
 
-    std::size_t written = serial->Write(packet, packetSize);
-    if (written != packetSize) return false;
+    // A short write leaves the tail queued; nothing else would flush it before the response is awaited.
+    if (serial->PendingWrite() > 0) {
+        ioResult = serial->TryDrainWrites(timeout_ms);
+        if (!ioResult) return false;
+    }
 
+    CommandWritten();
     return true;
 }
 
+/**
+ * @brief Frames a command for callers that write it to the port themselves.
+ * @param command Pointer to the command string
+ * @param length Length of the command
+ * @return STX, command, ETX and BCC; empty if the command is empty
+ */
+std::string OpenBSC::FrameCommand(const char* command, uint32_t length)
+{
+    std::string frame;
+    if (!command || length == 0) return frame;
+
+    frame.reserve(length + 3);
+    frame += static_cast<char>(STX);
+    frame.append(command, length);
+    frame += static_cast<char>(ETX);
+    frame += static_cast<char>(CalculateBCC(reinterpret_cast<const uint8_t*>(command), length) ^ ETX);
+    return frame;
+}
+
+/**
+ * @brief Accounts a command whose frame has been written completely.
+ */
+void OpenBSC::CommandWritten()
+{
+    lastCommand = std::chrono::steady_clock::now();
+    commandsSent.fetch_add(1, std::memory_order_relaxed);
+}
+
 /**
  * @brief Reads a response packet from the serial port using OpenBSC protocol.
  * @param buffer Buffer to store the received payload
@@ -98,31 +151,299 @@ uint32_t OpenBSC::ReadResponse(char* buffer, uint32_t maxLength, uint32_t timeou
 {
     if (!serial || !buffer || maxLength == 0) return 0;
 
-    uint8_t raw[MAX_BUFF_SIZE] = {0};
-    uint32_t idx = 0;
-    auto start = std::chrono::steady_clock::now();
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
 
     while (true) {
-        uint8_t byte;
-        std::size_t read = serial->Read(&byte, 1, 10);
-        if (read == 1 && idx < MAX_BUFF_SIZE) raw[idx++] = byte;
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() < 0) remaining = std::chrono::milliseconds(0);
+
+        bool                received;
+        FrameParser::Result result = pump(static_cast<unsigned int>(remaining.count()), received);
+
+        if (ioResult.Failed()) return 0;
+        if (!received) {
+            if (std::chrono::steady_clock::now() >= deadline) {
+                responseTimeouts.fetch_add(1, std::memory_order_relaxed);
+                return 0;
+            }
+            continue;
+        }
+
+        if (result == FrameParser::Result::BadBcc) {
+            bccErrors.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+        if (result == FrameParser::Result::Frame) break;
+    }
+
+    return deliver(buffer, maxLength);
+}
+
+/**
+ * @brief Parses the bytes available right now, without waiting.
+ * @param buffer Buffer to store the received payload
+ * @param maxLength Size of buffer, including the NUL terminator
+ * @param length Receives the payload length when a frame is complete
+ * @param expired Give up if no frame is complete
+ * @return Complete, BadBcc, Timeout (expired only), Error or Pending
+ */
+OpenBSC::ResponseStatus OpenBSC::PollResponse(char* buffer, uint32_t maxLength, uint32_t& length, bool expired)
+{
+    length = 0;
+    if (!serial || !buffer || maxLength == 0) return ResponseStatus::BadBcc;
+
+    while (true) {
+        bool                received;
+        FrameParser::Result result = pump(0, received);
+        if (ioResult.Failed()) return ResponseStatus::Error;
+        if (!received) break;
+
+        if (result == FrameParser::Result::BadBcc) {
+            bccErrors.fetch_add(1, std::memory_order_relaxed);
+            return ResponseStatus::BadBcc;
+        }
+        if (result == FrameParser::Result::Frame) {
+            length = deliver(buffer, maxLength);
+            return ResponseStatus::Complete;
+        }
+    }
+
+    if (expired) {
+        responseTimeouts.fetch_add(1, std::memory_order_relaxed);
+        return ResponseStatus::Timeout;
+    }
+    return ResponseStatus::Pending;
+}
+
+/**
+ * @brief Microseconds elapsed since start.
+ */
+static uint32_t microsecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+}
+
+/**
+ * @brief Sends commands with up to window of them in flight, matching responses in order.
+ * @param requests Commands to send, receive the outcomes
+ * @param count Number of requests
+ * @param timeout_ms Deadline of the whole batch
+ * @param window Commands in flight at most
+ * @return Number of requests answered with a valid frame
+ */
+size_t OpenBSC::Pipeline(PipelineRequest* requests, size_t count, uint32_t timeout_ms, size_t window)
+{
+    if (!requests) return 0;
+
+    bool valid = true;
+    for (size_t i = 0; i < count; ++i) {
+        requests[i].status       = ResponseStatus::Pending;
+        requests[i].answerLength = 0;
+        requests[i].sentUs       = 0;
+        requests[i].latencyUs    = 0;
+        valid                    = valid && requests[i].command && requests[i].length > 0;
+    }
+    if (!serial || !valid) return 0;
+    if (window == 0) window = 1;
+
+    const auto start    = std::chrono::steady_clock::now();
+    const auto deadline = start + std::chrono::milliseconds(timeout_ms);
+
+    // Requests [oldest, next) are in flight; those before sent have left the write queue.
+    size_t oldest    = 0;
+    size_t next      = 0;
+    size_t sent      = 0;
+    size_t completed = 0;
+    bool   writing   = true;
+    size_t submitted = 0; // Bytes of requests [0, next) accepted by TryQueueWriteV()
+    size_t sentBytes = 0; // Bytes of requests [0, sent)
+
+    // Stamps the requests whose last byte is no longer queued, given the bytes still pending.
+    auto markSent = [&](size_t pending) {
+        uint32_t now = microsecondsSince(start);
+        while (sent < next && sentBytes + requests[sent].length + 3u <= submitted - std::min(pending, submitted)) {
+            sentBytes += requests[sent].length + 3u;
+            requests[sent++].sentUs = now;
+            commandsSent.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
 
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::milliseconds>(now - start).count() > timeout_ms)
+    while (oldest < next || (writing && next < count)) {
+        if (writing && std::chrono::steady_clock::now() >= deadline) writing = false;
+
+        // Top up the window with one gather write.
+        if (writing && next < count && next - oldest < window) {
+            uint8_t        header = STX;
+            iovec          segments[3 * PIPELINE_WRITE_BATCH];
+            uint8_t        trailers[PIPELINE_WRITE_BATCH][2];
+
+            size_t frames = std::min({count - next, window - (next - oldest), PIPELINE_WRITE_BATCH});
+            for (size_t f = 0; f < frames; ++f) {
+                const PipelineRequest& request = requests[next + f];
+                trailers[f][0]                 = ETX;
+                trailers[f][1]                 = CalculateBCC(reinterpret_cast<const uint8_t*>(request.command), request.length) ^ ETX;
+                segments[3 * f].iov_base       = &header;
+                segments[3 * f].iov_len        = 1;
+                segments[3 * f + 1].iov_base   = const_cast<char*>(request.command);
+                segments[3 * f + 1].iov_len    = request.length;
+                segments[3 * f + 2].iov_base   = trailers[f];
+                segments[3 * f + 2].iov_len    = sizeof(trailers[f]);
+            }
+
+            // Never waits for the queue: a full one takes nothing (backpressure) and the frames
+            // are offered again once the flush below and the responses have made room.
+            ioResult = serial->TryQueueWriteV(segments, 3 * frames);
+            if (ioResult.Failed()) {
+                requests[next].status = ResponseStatus::Error;
+                writing               = false;
+            } else if (ioResult.bytes > 0) {
+                for (size_t f = 0; f < frames; ++f) submitted += requests[next++].length + 3u;
+            }
+        }
+
+        // The port may have taken only part of the gather write; the rest waits in the queue
+        // and nothing else flushes it, so hand it over before waiting for responses.
+        size_t pending = serial->PendingWrite();
+        if (pending > 0) {
+            SerialResult flushed = serial->TryDrainWrites(PIPELINE_FLUSH_SLICE_MS);
+            if (flushed.Failed()) ioResult = flushed;
+            pending = flushed.Failed() ? pending : flushed.bytes;
+        }
+        markSent(pending);
+        if (oldest == next) continue;
+
+        // Only look for bytes already there while the window has room for more commands or
+        // queued bytes still have to go out.
+        bool canWrite  = writing && next < count && next - oldest < window;
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (canWrite || pending > 0 || remaining.count() < 0) remaining = std::chrono::milliseconds(0);
+
+        bool                received;
+        FrameParser::Result result = pump(static_cast<unsigned int>(remaining.count()), received);
+
+        if (ioResult.Failed()) {
+            for (; oldest < next; ++oldest) requests[oldest].status = ResponseStatus::Error;
+            writing = false;
             break;
+        }
+
+        if (result == FrameParser::Result::Frame) {
+            responsesReceived.fetch_add(1, std::memory_order_relaxed);
+            PipelineRequest& request = requests[oldest++];
+            request.latencyUs        = microsecondsSince(start) - request.sentUs;
+            request.answerLength     = copyPayload(request.answer, request.answerSize);
+            request.status           = ResponseStatus::Complete;
+            responseTime.Record(std::chrono::microseconds(request.latencyUs));
+            ++completed;
+        } else if (result == FrameParser::Result::BadBcc) {
+            bccErrors.fetch_add(1, std::memory_order_relaxed);
+            requests[oldest++].status = ResponseStatus::BadBcc;
+        } else if (!canWrite && std::chrono::steady_clock::now() >= deadline) {
+            // Requests still (partly) queued at the deadline time out too and keep sentUs 0.
+            for (; oldest < next; ++oldest) {
+                requests[oldest].status = ResponseStatus::Timeout;
+                responseTimeouts.fetch_add(1, std::memory_order_relaxed);
+            }
+            writing = false;
+        }
+    }
+
+    return completed;
+}
+
+/**
+ * @brief Returns the serial port used by this instance.
+ * @return Port, nullptr before Init() or after Disconnect()
+ */
+std::shared_ptr<SerialCommunication> OpenBSC::Port() const
+{
+    return serial;
+}
+
+/**
+ * @brief Returns the outcome of the last serial call.
+ * @return Ok, Timeout or the failure with its system error code
+ */
+SerialResult OpenBSC::LastIoResult() const
+{
+    return ioResult;
+}
+
+/**
+ * @brief Feeds one batch of received bytes to the frame parser.
+ * @param waitMs How long to wait for bytes when none are buffered
+ * @param received Set to false when no byte was available or the port failed (see ioResult)
+ * @return Parser result for the bytes consumed
+ */
+FrameParser::Result OpenBSC::pump(unsigned int waitMs, bool& received)
+{
+    const uint8_t* data;
+    std::size_t    available;
+    bool           fromRing = false;
+
+    if (rxBegin < rxEnd) {
+        data      = rxBuffer + rxBegin;
+        available = rxEnd - rxBegin;
+        ioResult  = SerialResult::Transferred(available);
+    } else if (serial->RxThreadActive()) {
+        // Parse in place from the receive ring: no staging copy.
+        ByteSpan span;
+        ioResult  = serial->TryPeekRx(waitMs, span);
+        data      = span.data;
+        available = span.size;
+        fromRing  = true;
+    } else {
+        ioResult  = waitMs > 0 ? serial->TryRead(rxBuffer, sizeof(rxBuffer), waitMs)
+                               : serial->TryReadAvailable(rxBuffer, sizeof(rxBuffer));
+        rxBegin   = 0;
+        rxEnd     = ioResult.Failed() ? 0 : ioResult.bytes;
+        data      = rxBuffer;
+        available = rxEnd;
+    }
+
+    received = available > 0;
+    if (!received) return FrameParser::Result::NeedMore;
+
+    FrameParser::Result result;
+    std::size_t         used = parser.Feed(data, available, result);
+    if (fromRing)
+        serial->ConsumeRx(used);
+    else
+        rxBegin += used;
+    return result;
+}
+
+/**
+ * @brief Copies the payload of the completed frame and accounts for the response.
+ * @param buffer Destination buffer
+ * @param maxLength Size of buffer, including the NUL terminator
+ * @return Number of payload bytes copied
+ */
+uint32_t OpenBSC::deliver(char* buffer, uint32_t maxLength)
+{
+    responsesReceived.fetch_add(1, std::memory_order_relaxed);
+    // Only the first frame after a command answers it; unsolicited or replayed frames are not timed.
+    if (lastCommand != std::chrono::steady_clock::time_point()) {
+        responseTime.Record(std::chrono::steady_clock::now() - lastCommand);
+        lastCommand = std::chrono::steady_clock::time_point();
     }
 
-    uint8_t* stxPtr = static_cast<uint8_t*>(std::memchr(raw, STX, idx));
-    uint8_t* etxPtr = stxPtr ? static_cast<uint8_t*>(std::memchr(stxPtr + 1, ETX, idx - (stxPtr - raw) - 1)) : nullptr;
-    if (!stxPtr || !etxPtr || etxPtr <= stxPtr) return 0;
+    return copyPayload(buffer, maxLength);
+}
 
-    uint8_t expectedBcc = *(etxPtr + 1);
-    uint8_t calcBcc = CalculateBCC(stxPtr + 1, etxPtr - stxPtr);
-    if (expectedBcc != calcBcc) return 0;
+/**
+ * @brief Copies the payload of the completed frame, truncated to fit.
+ * @param buffer Destination buffer, may be null
+ * @param maxLength Size of buffer, including the NUL terminator
+ * @return Number of payload bytes copied
+ */
+uint32_t OpenBSC::copyPayload(char* buffer, uint32_t maxLength)
+{
+    if (!buffer || maxLength == 0) return 0;
 
-    uint32_t payloadLen = etxPtr - stxPtr - 1;
-    if (payloadLen > maxLength) payloadLen = maxLength;
-    std::memcpy(buffer, stxPtr + 1, payloadLen);
+    uint32_t payloadLen = static_cast<uint32_t>(parser.PayloadLength());
+    if (payloadLen > maxLength - 1) payloadLen = maxLength - 1;
+    std::memcpy(buffer, parser.Payload(), payloadLen);
     buffer[payloadLen] = '\0';
 
     return payloadLen;
@@ -137,7 +458,40 @@ bool OpenBSC::Disconnect()
     if (serial) {
         serial->Close();
         serial.reset();
+        parser.Reset();
+        rxBegin = rxEnd = 0;
         return true;
     }
     return false;
 }
+
+/**
+ * @brief Collects the protocol counters and those of the serial port.
+ * @return Snapshot of the counters
+ */
+OpenBSCStats OpenBSC::Stats() const
+{
+    OpenBSCStats stats;
+    stats.commandsSent      = commandsSent.load(std::memory_order_relaxed);
+    stats.responsesReceived = responsesReceived.load(std::memory_order_relaxed);
+    stats.bccErrors         = bccErrors.load(std::memory_order_relaxed);
+    stats.responseTimeouts  = responseTimeouts.load(std::memory_order_relaxed);
+    responseTime.Snapshot(stats.responseUs);
+    if (serial)
+        stats.serial = serial->Stats();
+    return stats;
+}
+
+/**
+ * @brief Zeroes the protocol counters and those of the serial port.
+ */
+void OpenBSC::ResetStats()
+{
+    commandsSent.store(0, std::memory_order_relaxed);
+    responsesReceived.store(0, std::memory_order_relaxed);
+    bccErrors.store(0, std::memory_order_relaxed);
+    responseTimeouts.store(0, std::memory_order_relaxed);
+    responseTime.Reset();
+    if (serial)
+        serial->ResetStats();
+}
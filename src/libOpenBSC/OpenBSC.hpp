@@ -10,9 +10,29 @@
 #define OPENBSC_H
 
 #include "Serial.hpp"
+#include "FrameParser.hpp"
+#include "SerialStats.hpp"
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <cstring>
+#include <string>
+
+/**
+ * @brief Protocol counters of an OpenBSC session together with those of its port.
+ */
+struct OpenBSCStats
+{
+    uint64_t commandsSent      = 0; ///< Commands written completely.
+    uint64_t responsesReceived = 0; ///< Valid response frames returned by ReadResponse.
+    uint64_t bccErrors         = 0; ///< Frames dropped because of a bad BCC.
+    uint64_t responseTimeouts  = 0; ///< ReadResponse calls that ran out of time.
+
+    uint64_t responseUs[LATENCY_BUCKETS] = {}; ///< Time from the last command to its response frame.
+
+    SerialStatsSnapshot serial; ///< Counters of the underlying port, zero when there is none.
+};
 
 /**
  * @brief Class for managing Open BSC protocol with a device via a serial interface.
@@ -20,6 +40,44 @@
 class OpenBSC
 {
   public:
+    /**
+     * @brief Outcome of PollResponse().
+     */
+    enum class ResponseStatus
+    {
+        Pending,  ///< No complete frame yet; call again once the port is readable.
+        Complete, ///< A frame was received and copied to the buffer.
+        BadBcc,   ///< A frame arrived with an invalid BCC.
+        Timeout,  ///< The caller's deadline expired without a complete frame.
+        Error     ///< The port failed; see LastIoResult().
+    };
+
+    /**
+     * @brief One command of a Pipeline() call and what came back for it.
+     */
+    struct PipelineRequest
+    {
+        const char* command    = nullptr; ///< Command payload; Pipeline() adds the framing.
+        uint32_t    length     = 0;       ///< Length of command.
+        char*       answer     = nullptr; ///< Receives the response payload and a NUL terminator; may be null.
+        uint32_t    answerSize = 0;       ///< Size of answer in bytes, including room for the NUL terminator.
+
+        ResponseStatus status       = ResponseStatus::Pending; ///< Complete, BadBcc, Timeout or Error; Pending when never sent.
+        uint32_t       answerLength = 0;                       ///< Payload bytes copied to answer when Complete.
+        uint32_t       sentUs       = 0;                       ///< From the Pipeline() call until the command has left the write queue.
+        uint32_t       latencyUs    = 0;                       ///< From sentUs to the response when Complete.
+    };
+
+    /**
+     * @brief Commands Pipeline() keeps in flight unless told otherwise.
+     */
+    static const size_t PIPELINE_WINDOW = 8;
+
+    /**
+     * @brief Time SendCommand() waits for a command the port did not take at once.
+     */
+    static const uint32_t SEND_TIMEOUT_MS = 1000;
+
     /**
      * @brief Constructs a new OpenBSC object.
      */
@@ -38,10 +96,12 @@ class OpenBSC
      * @param[in] parity: The parity setting ('N' for none, 'E' for even, 'O' for odd).
      * @param[in] use_rts: Flag indicating whether to enable the RTS signal.
      * @param[in] use_dtr: Flag indicating whether to enable the DTR signal.
+     * @param[in] options: Optional serial settings (backend, receive thread, low latency...).
      * @return true if the initialization was successful;
      *         false otherwise.
      */
-    bool Init(const char* portName, uint32_t baudRate, uint8_t byte_size, uint8_t stop_bits, char parity, bool use_rts, bool use_dtr);
+    bool Init(const char* portName, uint32_t baudRate, uint8_t byte_size, uint8_t stop_bits, char parity, bool use_rts, bool use_dtr,
+              const SerialOptions& options = SerialOptions());
 
     /**
      * @brief Opens a serial communication port.
@@ -55,24 +115,97 @@ class OpenBSC
      * @brief Sends a command to the connected device.
      * @param[in] command: The command string to be sent.
      * @param[in] length: The length of the command string.
+     * @param[in] timeout_ms: Time allowed for the whole frame to be handed to the port.
      * @return true if the command was successfully sent;
      *         false otherwise.
      */
-    bool SendCommand(const char* command, uint32_t length);
+    bool SendCommand(const char* command, uint32_t length, uint32_t timeout_ms = SEND_TIMEOUT_MS);
+
+    /**
+     * @brief Frames a command for callers that write it to the port themselves.
+     * @param[in] command: The command string to be framed.
+     * @param[in] length: The length of the command string.
+     * @return std::string STX, command, ETX and BCC; empty if the command is empty.
+     */
+    std::string FrameCommand(const char* command, uint32_t length);
+
+    /**
+     * @brief Accounts a frame from FrameCommand() that the caller has written completely,
+     *        so that the next response is timed and counted like one to SendCommand().
+     */
+    void CommandWritten();
 
     /**
      * @brief Reads the response from the connected device.
      * 
-     * Reads bytes from the serial port and extracts the payload according to the OpenBSC protocol.
-     * If `filtered` is true, the STX, ETX, and BCC bytes are removed and only the payload is returned.
+     * Reads bytes from the serial port in bulk and feeds them to an incremental frame parser.
+     * Returns as soon as a complete STX..ETX+BCC frame has been received; bytes that follow
+     * the frame are kept and used by the next call. Only the payload is copied to buffer,
+     * followed by a NUL terminator. When the port runs a receive thread
+     * (SerialCommunication::StartRxThread), frames are parsed directly from its ring buffer.
      * 
      * @param[out] buffer The buffer to store the received payload.
-     * @param[in] maxLength Maximum number of bytes that can be stored in buffer.
+     * @param[in] maxLength Size of buffer in bytes, including room for the NUL terminator.
      * @param[in] timeout_ms Timeout in milliseconds to wait for the response.
-     * @return uint32_t Number of bytes successfully read into buffer. Returns 0 if timeout occurs or BCC is invalid.
+     * @return uint32_t Number of bytes successfully read into buffer. Returns 0 if timeout occurs, BCC is invalid
+     *         or the port failed (LastIoResult() tells them apart).
      */
     uint32_t ReadResponse(char* buffer, uint32_t maxLength, uint32_t timeout_ms);
 
+    /**
+     * @brief Non-blocking variant of ReadResponse() for event loops.
+     * 
+     * Parses whatever the port has buffered right now and returns without waiting. Call it
+     * whenever the port becomes readable; pass expired = true once the caller's deadline has
+     * passed, so that a late frame is still taken and a timeout is accounted otherwise.
+     * 
+     * @param[out] buffer The buffer to store the received payload.
+     * @param[in] maxLength Size of buffer in bytes, including room for the NUL terminator.
+     * @param[out] length Payload length when the status is Complete, 0 otherwise.
+     * @param[in] expired The caller's deadline has passed.
+     * @return ResponseStatus Outcome of the call.
+     */
+    ResponseStatus PollResponse(char* buffer, uint32_t maxLength, uint32_t& length, bool expired = false);
+
+    /**
+     * @brief Sends many commands without waiting a round trip for each.
+     * 
+     * Keeps up to window commands in flight: they are framed and written back-to-back in one
+     * gather write, and more follow as responses come in. The device must answer in order,
+     * one frame per command, so each response frame (valid or with a bad BCC) belongs to the
+     * oldest unanswered command. Over a link with a latency of milliseconds, window commands
+     * share one round trip instead of paying one each.
+     * 
+     * All commands share one deadline. Commands still unanswered when it passes time out, and
+     * commands not completely written by then stay Pending. Backpressure from the write queue
+     * only delays writing; a failed write marks its command and those in flight Error and leaves
+     * the rest Pending. A late
+     * response to a timed-out command arrives as the first frame of the next call, as it would
+     * for ReadResponse(). Nothing is sent when a request has no command.
+     * 
+     * @param[in,out] requests Commands to send; receive the outcomes.
+     * @param[in] count Number of requests.
+     * @param[in] timeout_ms Deadline of the whole batch, counted from the call.
+     * @param[in] window Commands in flight at most; 1 waits for every response before the next command.
+     * @return size_t Number of requests answered with a valid frame.
+     */
+    size_t Pipeline(PipelineRequest* requests, size_t count, uint32_t timeout_ms, size_t window = PIPELINE_WINDOW);
+
+    /**
+     * @brief Serial port used by this instance, e.g. to register it with a SerialReactor.
+     * @return Port, nullptr before Init() or after Disconnect().
+     */
+    std::shared_ptr<SerialCommunication> Port() const;
+
+    /**
+     * @brief Outcome of the last serial call made by SendCommand(), ReadResponse() or PollResponse().
+     * 
+     * The protocol layer never throws: a failing port makes these calls return false, 0 or
+     * ResponseStatus::Error, and this result keeps the status and errno of the failure.
+     * @return SerialResult Ok, Timeout or the failure with its system error code.
+     */
+    SerialResult LastIoResult() const;
+
     /**
      * @brief Disconnects the serial communication.
      * @return true if the port was successfully closed;
@@ -80,6 +213,16 @@ class OpenBSC
      */
     bool Disconnect();
 
+    /**
+     * @brief Returns the protocol counters and the counters of the serial port.
+     */
+    OpenBSCStats Stats() const;
+
+    /**
+     * @brief Zeroes the protocol counters and those of the serial port.
+     */
+    void ResetStats();
+
   private:
     /**
      * @brief Calculates the Block Check Character (BCC).
@@ -89,7 +232,35 @@ class OpenBSC
      */
     uint8_t CalculateBCC(const uint8_t* data, uint32_t length);
 
+    /**
+     * @brief Feeds one batch of received bytes to the parser, waiting up to waitMs for them.
+     */
+    FrameParser::Result pump(unsigned int waitMs, bool& received);
+
+    /**
+     * @brief Copies the completed frame to buffer and accounts for it.
+     */
+    uint32_t deliver(char* buffer, uint32_t maxLength);
+
+    /**
+     * @brief Copies the payload of the completed frame to buffer, NUL-terminated.
+     */
+    uint32_t copyPayload(char* buffer, uint32_t maxLength);
+
     std::shared_ptr<SerialCommunication> serial; ///< Smart pointer to SerialCommunication object.
+    SerialResult                         ioResult; ///< Result of the last serial call, see LastIoResult().
+
+    FrameParser parser;           ///< Receive state machine, kept across calls.
+    uint8_t     rxBuffer[1024];   ///< Bytes read from the port but not parsed yet.
+    size_t      rxBegin = 0;      ///< First unparsed byte in rxBuffer.
+    size_t      rxEnd   = 0;      ///< One past the last valid byte in rxBuffer.
+
+    std::chrono::steady_clock::time_point lastCommand;               ///< When the last command was written, cleared once answered.
+    std::atomic<uint64_t>                 commandsSent{0};           ///< See OpenBSCStats.
+    std::atomic<uint64_t>                 responsesReceived{0};      ///< See OpenBSCStats.
+    std::atomic<uint64_t>                 bccErrors{0};              ///< See OpenBSCStats.
+    std::atomic<uint64_t>                 responseTimeouts{0};       ///< See OpenBSCStats.
+    LatencyHistogram                      responseTime;              ///< See OpenBSCStats::responseUs.
 };
 
 #endif // OPENBSC_HPP
@@ -0,0 +1,164 @@
+/**
+ * @file OpenBSCCoroutine.hpp
+ * @brief C++20 coroutine transactions on an OpenBSC device driven by a SerialReactor
+ * @version 0.1
+ * @date 2025-08-09
+ * @copyright Copyright (c) 2025
+ */
+#ifndef OPENBSC_COROUTINE_HPP
+#define OPENBSC_COROUTINE_HPP
+
+#include "OpenBSC.hpp"
+#include "SerialCoroutine.hpp"
+
+#if defined(__cpp_impl_coroutine) && !defined(_WIN32)
+
+#include <string>
+
+/**
+ * @brief Outcome of AsyncOpenBSC::Transact().
+ */
+struct TransactResult
+{
+    AsyncStatus status = AsyncStatus::Ok; ///< Ok, Timeout, Cancelled or Error.
+    bool        badBcc = false;           ///< Error was caused by a response with an invalid BCC.
+    std::string response;                 ///< Payload of the response when status is Ok.
+
+    explicit operator bool() const
+    {
+        return status == AsyncStatus::Ok;
+    }
+};
+
+/**
+ * @brief Command/response transactions as awaitables, one OpenBSC device per instance.
+ *
+ * The framed command goes out through AsyncPort::Write(), so the coroutine suspends while
+ * the port cannot take it, and then until the reactor reports the port readable; each
+ * wakeup parses what arrived with OpenBSC::PollResponse(). No thread blocks in
+ * SendCommand() or ReadResponse(), so a few reactor threads serve hundreds of devices,
+ * each written as straight-line code:
+ *
+ * @code
+ * SerialTask<> session(AsyncOpenBSC& device)
+ * {
+ *     TransactResult version = co_await device.Transact("V", std::chrono::milliseconds(500));
+ *     if (version)
+ *         ...
+ * }
+ * @endcode
+ *
+ * The OpenBSC instance must be initialized and must outlive this object; only one
+ * transaction may be pending at a time.
+ */
+class AsyncOpenBSC
+{
+  public:
+    using Deadline = SerialCommunication::Deadline;
+
+    /**
+     * @brief Registers the port of bsc with reactor.
+     * @param[in] reactor Reactor resuming the transactions.
+     * @param[in] bsc Initialized OpenBSC instance.
+     */
+    AsyncOpenBSC(SerialReactor& reactor, OpenBSC& bsc) : bsc_(bsc), port_(reactor, bsc.Port())
+    {
+    }
+
+    /**
+     * @brief Whether the port could be registered and has not failed.
+     */
+    bool Valid() const
+    {
+        return port_.Valid();
+    }
+
+    /**
+     * @brief The awaitable port, e.g. to Cancel() a pending transaction.
+     */
+    AsyncPort& Port()
+    {
+        return port_;
+    }
+
+    /**
+     * @brief Sends a command and waits for its response frame.
+     * @param[in] command Command payload.
+     * @param[in] deadline Point in time after which the transaction times out.
+     * @return TransactResult Status and response payload.
+     */
+    SerialTask<TransactResult> Transact(std::string command, Deadline deadline)
+    {
+        TransactResult result;
+
+        std::string frame = bsc_.FrameCommand(command.data(), static_cast<uint32_t>(command.size()));
+        if (frame.empty())
+        {
+            result.status = AsyncStatus::Error;
+            co_return result;
+        }
+
+        // Completes once the whole frame has been handed to the driver.
+        AsyncResult written = co_await port_.Write(frame.data(), frame.size(), deadline);
+        if (!written)
+        {
+            result.status = written.status;
+            co_return result;
+        }
+        bsc_.CommandWritten();
+
+        char     buffer[1024];
+        uint32_t length;
+        while (true)
+        {
+            OpenBSC::ResponseStatus status = bsc_.PollResponse(buffer, sizeof(buffer), length,
+                                                               std::chrono::steady_clock::now() >= deadline);
+            switch (status)
+            {
+                case OpenBSC::ResponseStatus::Complete:
+                    result.response.assign(buffer, length);
+                    co_return result;
+
+                case OpenBSC::ResponseStatus::BadBcc:
+                    result.status = AsyncStatus::Error;
+                    result.badBcc = true;
+                    co_return result;
+
+                case OpenBSC::ResponseStatus::Timeout:
+                    result.status = AsyncStatus::Timeout;
+                    co_return result;
+
+                case OpenBSC::ResponseStatus::Error:
+                    result.status = AsyncStatus::Error;
+                    co_return result;
+
+                case OpenBSC::ResponseStatus::Pending:
+                    break;
+            }
+
+            // On Timeout, loop once more: PollResponse takes a late frame or accounts the timeout.
+            AsyncResult ready = co_await port_.WaitReadable(deadline);
+            if (ready.status == AsyncStatus::Cancelled || ready.status == AsyncStatus::Error || ready.status == AsyncStatus::Busy)
+            {
+                result.status = ready.status;
+                co_return result;
+            }
+        }
+    }
+
+    /**
+     * @brief Sends a command and waits at most timeout for its response frame.
+     */
+    SerialTask<TransactResult> Transact(std::string command, std::chrono::milliseconds timeout = std::chrono::milliseconds(1000))
+    {
+        return Transact(std::move(command), std::chrono::steady_clock::now() + timeout);
+    }
+
+  private:
+    OpenBSC&  bsc_;
+    AsyncPort port_;
+};
+
+#endif // __cpp_impl_coroutine && !_WIN32
+
+#endif // OPENBSC_COROUTINE_HPP
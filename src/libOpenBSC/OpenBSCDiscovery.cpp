@@ -0,0 +1,194 @@
+/**
+ * @file OpenBSCDiscovery.cpp
+ * @brief Concurrent identify probe of many serial ports
+ */
+#include "OpenBSCDiscovery.hpp"
+#include "SerialParallel.hpp"
+
+#ifndef _WIN32
+#include "SerialReactor.hpp"
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+struct Probe
+{
+    OpenBSC           bsc;
+    DiscoveryResult   result;
+    Clock::time_point sent;
+    bool              pending = false; // Command sent, no outcome yet
+    bool              watched = false; // Served by the reactor, not by a thread
+};
+
+// Takes the outcome of a PollResponse() or ReadResponse() call; false while still pending.
+static bool settle(Probe& probe, OpenBSC::ResponseStatus status, const char* payload, uint32_t length)
+{
+    switch (status)
+    {
+        case OpenBSC::ResponseStatus::Complete:
+            probe.result.status    = DiscoveryStatus::Answered;
+            probe.result.answer.assign(payload, length);
+            probe.result.latencyUs = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - probe.sent).count());
+            break;
+        case OpenBSC::ResponseStatus::BadBcc:
+            probe.result.status = DiscoveryStatus::BadBcc;
+            break;
+        case OpenBSC::ResponseStatus::Error:
+            probe.result.status = DiscoveryStatus::IoError;
+            break;
+        case OpenBSC::ResponseStatus::Timeout:
+            probe.result.status = DiscoveryStatus::NoAnswer;
+            break;
+        case OpenBSC::ResponseStatus::Pending:
+            return false;
+    }
+
+    probe.result.io = probe.bsc.LastIoResult();
+    probe.pending   = false;
+    return true;
+}
+
+static void openAndSend(Probe& probe, const DiscoveryConfig& config, const SerialOptions& options)
+{
+    const char* name = probe.result.port.c_str();
+    if (!probe.bsc.Init(name, config.baudRate, config.byteSize, config.stopBits, config.parity, config.useRts, config.useDtr, options) ||
+        !probe.bsc.Open(name))
+    {
+        probe.result.status = DiscoveryStatus::OpenFailed;
+        return;
+    }
+
+    probe.sent = Clock::now();
+    if (!probe.bsc.SendCommand(config.command.c_str(), static_cast<uint32_t>(config.command.size())))
+    {
+        probe.result.status = DiscoveryStatus::SendFailed;
+        probe.result.io     = probe.bsc.LastIoResult();
+        return;
+    }
+    probe.pending = true;
+}
+
+// Blocking wait for ports the reactor cannot watch.
+static void awaitBlocking(Probe& probe, Clock::time_point deadline)
+{
+    char     payload[1024];
+    auto     remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+    uint32_t length    = probe.bsc.ReadResponse(payload, sizeof(payload), static_cast<uint32_t>(std::max<long long>(remaining, 0)));
+    if (length > 0)
+    {
+        settle(probe, OpenBSC::ResponseStatus::Complete, payload, length);
+        return;
+    }
+
+    // ReadResponse() returns 0 for a bad BCC as well; the counter tells it from a timeout.
+    OpenBSC::ResponseStatus status = OpenBSC::ResponseStatus::Timeout;
+    if (probe.bsc.LastIoResult().Failed())
+        status = OpenBSC::ResponseStatus::Error;
+    else if (probe.bsc.Stats().bccErrors > 0)
+        status = OpenBSC::ResponseStatus::BadBcc;
+    settle(probe, status, payload, 0);
+}
+
+std::vector<DiscoveryResult> DiscoverDevices(const std::vector<std::string>& ports, const DiscoveryConfig& config)
+{
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(config.timeoutMs);
+
+    // PollResponse() parses from the descriptor; a receive thread would compete for the bytes.
+    SerialOptions options  = config.options;
+    options.rxRingCapacity = 0;
+
+    std::vector<std::unique_ptr<Probe>> probes;
+    probes.reserve(ports.size());
+    for (const std::string& port : ports)
+    {
+        probes.emplace_back(new Probe());
+        probes.back()->result.port = port;
+    }
+
+    // Open and send in parallel; opening a USB adapter blocks for a few milliseconds.
+    ParallelFor(probes.size(), [&](size_t i) { openAndSend(*probes[i], config, options); });
+
+    // Joins the blocking waiters on every way out, also when the reactor throws; declared
+    // before the reactor so that its handlers are gone first.
+    struct Waiters
+    {
+        std::vector<std::thread> threads;
+        ~Waiters()
+        {
+            for (auto& thread : threads)
+                if (thread.joinable())
+                    thread.join();
+        }
+    } waiters;
+#ifndef _WIN32
+    SerialReactor reactor(1);
+    size_t        watched = 0;
+#endif
+    for (auto& owned : probes)
+    {
+        Probe* probe = owned.get();
+        if (!probe->pending)
+            continue;
+#ifndef _WIN32
+        if (probe->bsc.Port()->NativeHandle() >= 0)
+        {
+            bool added = reactor.Add(probe->bsc.Port(), [probe, &reactor, &watched](SerialCommunication& port, uint32_t) {
+                char                    payload[1024];
+                uint32_t                length;
+                OpenBSC::ResponseStatus status = probe->bsc.PollResponse(payload, sizeof(payload), length);
+                if (settle(*probe, status, payload, length))
+                {
+                    reactor.Remove(port);
+                    --watched;
+                }
+            });
+            if (added)
+            {
+                probe->watched = true;
+                ++watched;
+                continue;
+            }
+        }
+#endif
+        waiters.threads.emplace_back(awaitBlocking, std::ref(*probe), deadline);
+    }
+
+#ifndef _WIN32
+    while (watched > 0)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (remaining <= 0)
+            break;
+        reactor.RunOnce(static_cast<int>(remaining));
+    }
+
+    // Past the deadline: take a frame that is already buffered, account the timeout otherwise.
+    for (auto& owned : probes)
+    {
+        Probe& probe = *owned;
+        if (!probe.pending || !probe.watched)
+            continue;
+        char                    payload[1024];
+        uint32_t                length;
+        OpenBSC::ResponseStatus status = probe.bsc.PollResponse(payload, sizeof(payload), length, true);
+        settle(probe, status, payload, length);
+        reactor.Remove(*probe.bsc.Port());
+    }
+#endif
+
+    for (auto& waiter : waiters.threads)
+        waiter.join();
+
+    std::vector<DiscoveryResult> results;
+    results.reserve(probes.size());
+    for (auto& probe : probes)
+    {
+        probe->bsc.Disconnect();
+        results.push_back(std::move(probe->result));
+    }
+    return results;
+}
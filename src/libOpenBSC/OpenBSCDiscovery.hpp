@@ -0,0 +1,68 @@
+/**
+ * @file OpenBSCDiscovery.hpp
+ * @brief Finds which serial ports have an OpenBSC device and what each one answers
+ */
+#ifndef OPENBSC_DISCOVERY_HPP
+#define OPENBSC_DISCOVERY_HPP
+
+#include "OpenBSC.hpp"
+#include <string>
+#include <vector>
+
+/**
+ * @brief Settings of DiscoverDevices().
+ */
+struct DiscoveryConfig
+{
+    std::string   command   = "V";    ///< Identify command sent to every port.
+    uint32_t      timeoutMs = 1000;   ///< Shared deadline, counted from the call.
+    uint32_t      baudRate  = 115200; ///< Serial settings, as for OpenBSC::Init().
+    uint8_t       byteSize  = 8;
+    uint8_t       stopBits  = 1;
+    char          parity    = 'N';
+    bool          useRts    = false;
+    bool          useDtr    = false;
+    SerialOptions options;            ///< Backend, low latency...; no receive thread is needed.
+};
+
+/**
+ * @brief Outcome of probing one port.
+ */
+enum class DiscoveryStatus
+{
+    Answered,   ///< A valid frame came back; see DiscoveryResult::answer.
+    NoAnswer,   ///< Nothing valid arrived before the deadline.
+    BadBcc,     ///< A frame arrived with an invalid BCC.
+    OpenFailed, ///< The port could not be configured or opened.
+    SendFailed, ///< The identify command could not be written.
+    IoError     ///< The port failed while waiting; see DiscoveryResult::io.
+};
+
+/**
+ * @brief What one port answered to the identify command.
+ */
+struct DiscoveryResult
+{
+    std::string     port;                               ///< Port name as passed in.
+    DiscoveryStatus status    = DiscoveryStatus::NoAnswer;
+    std::string     answer;                             ///< Response payload when Answered.
+    uint32_t        latencyUs = 0;                      ///< From the command to its response when Answered.
+    SerialResult    io;                                 ///< Last serial result of the port.
+};
+
+/**
+ * @brief Sends the identify command to every port at once and collects the answers.
+ *
+ * The ports are opened and written by a pool of threads, so slow opens overlap. The answers
+ * are then awaited together until one deadline: ports with a descriptor share one
+ * SerialReactor driven from the calling thread, the others (loopback, Windows) wait on a
+ * thread each. Probing 100 ports therefore takes one timeout instead of 100. All ports are
+ * closed again before returning.
+ *
+ * @param[in] ports Candidate ports, e.g. from SerialPortIndex.
+ * @param[in] config Command, deadline and serial settings.
+ * @return One result per port, in the order of ports.
+ */
+std::vector<DiscoveryResult> DiscoverDevices(const std::vector<std::string>& ports, const DiscoveryConfig& config = DiscoveryConfig());
+
+#endif // OPENBSC_DISCOVERY_HPP
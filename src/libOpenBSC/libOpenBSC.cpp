@@ -1,11 +1,21 @@
 #include "libOpenBSC.h"
 #include "OpenBSC.hpp"
+#include "OpenBSCDiscovery.hpp"
 #include "PortManager.hpp"
+#include "SerialHotplug.hpp"
+#include "SerialLoopback.hpp"
+#include "SerialPortIndex.hpp"
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <vector>
 
 static OpenBSC sdk;
 
+static const uint32_t SDK_RESPONSE_TIMEOUT_MS = 1000;
+
+static_assert(OPENBSC_HISTOGRAM_BUCKETS == LATENCY_BUCKETS, "OpenBSCStats_s histograms must match LatencyHistogram");
+
 extern "C"
 {
     /**
@@ -43,6 +53,208 @@ extern "C"
         return list;
     }
 
+    /**
+     * @brief Lists all COM ports filtered by VID and PID, without the limits of listPortSDK.
+     * @param VID USB Vendor ID (0 = any)
+     * @param PID USB Product ID (0 = any)
+     * @return ComPortInfoList_s whose entries and strings share one allocation; release it with OpenBSCSDKFreePortList.
+     */
+    BSC_SDK_EXPORT struct ComPortInfoList_s OpenBSCSDKListPorts(uint16_t VID, uint16_t PID)
+    {
+        ComPortInfoList_s list = {};
+
+        auto   ports = SerialPortIndex::Instance().List(VID, PID);
+        size_t size  = ports.size() * sizeof(ComPortInfo_s);
+        for (const auto &info : ports)
+        {
+            size += info.name.size() + info.device.size() + info.serialNumber.size() + 3;
+        }
+        if (ports.empty())
+        {
+            return list;
+        }
+
+        list.ports = static_cast<ComPortInfo_s *>(std::malloc(size));
+        if (!list.ports)
+        {
+            return list;
+        }
+
+        char *cursor = reinterpret_cast<char *>(list.ports + ports.size());
+        auto  pack   = [&cursor](const std::string &text) {
+            char *start = cursor;
+            std::memcpy(cursor, text.c_str(), text.size() + 1);
+            cursor += text.size() + 1;
+            return start;
+        };
+
+        for (const auto &info : ports)
+        {
+            ComPortInfo_s &entry = list.ports[list.count++];
+            entry.name           = pack(info.name);
+            entry.serial         = pack(info.device);
+            entry.serialNumber   = pack(info.serialNumber);
+            entry.vendorId       = info.vendorId;
+            entry.productId      = info.productId;
+        }
+
+        return list;
+    }
+
+    /**
+     * @brief Releases a list returned by OpenBSCSDKListPorts and empties it.
+     * @param list List to release (may be NULL)
+     */
+    BSC_SDK_EXPORT void OpenBSCSDKFreePortList(struct ComPortInfoList_s *list)
+    {
+        if (!list)
+        {
+            return;
+        }
+        std::free(list->ports);
+        *list = ComPortInfoList_s{};
+    }
+
+    /**
+     * @brief Reports COM ports filtered by VID and PID as they are plugged in and out.
+     * @param VID USB Vendor ID (0 = any)
+     * @param PID USB Product ID (0 = any)
+     * @param callback Called from the hot-plug monitor thread for every matching port
+     * @param userData Passed to callback unchanged
+     * @return Watch ID for OpenBSCSDKUnwatchPorts, 0 if hot-plug events are not available
+     */
+    BSC_SDK_EXPORT int OpenBSCSDKWatchPorts(uint16_t VID, uint16_t PID, OpenBSCPortEventCallback callback, void *userData)
+    {
+        if (!callback)
+        {
+            return 0;
+        }
+
+        return SerialHotplug::Instance().Subscribe(
+            [callback, userData](SerialHotplug::Event event, const SerialPortInfo &info) {
+                ComPortInfo_s port;
+                port.name         = info.name.c_str();
+                port.serial       = info.device.c_str();
+                port.serialNumber = info.serialNumber.c_str();
+                port.vendorId     = info.vendorId;
+                port.productId    = info.productId;
+                callback(event == SerialHotplug::Event::Added, &port, userData);
+            },
+            VID, PID);
+    }
+
+    /**
+     * @brief Stops a watch started by OpenBSCSDKWatchPorts; its callback does not run afterwards.
+     * @param watchId ID returned by OpenBSCSDKWatchPorts
+     */
+    BSC_SDK_EXPORT void OpenBSCSDKUnwatchPorts(int watchId)
+    {
+        SerialHotplug::Instance().Unsubscribe(watchId);
+    }
+
+    /**
+     * @brief Sends an identify command to many ports at once and reports which answered what.
+     * @param config Command, deadline, serial settings and VID/PID filter (NULL = defaults)
+     * @param ports Ports to probe; NULL probes every enumerated port matching the VID/PID filter
+     * @param portCount Number of entries in ports
+     * @return DiscoveryList_s whose entries and strings share one allocation; release it with OpenBSCSDKFreeDiscovery.
+     */
+    BSC_SDK_EXPORT struct DiscoveryList_s OpenBSCSDKDiscover(const struct DiscoverConfig_s *config, const char *const *ports, uint32_t portCount)
+    {
+        DiscoveryList_s list = {};
+
+        DiscoveryConfig settings;
+        uint16_t        VID = 0, PID = 0;
+        if (config)
+        {
+            if (config->command && config->command[0] != '\0')
+            {
+                settings.command = config->command;
+            }
+            settings.timeoutMs = config->timeoutMs ? config->timeoutMs : settings.timeoutMs;
+            settings.baudRate  = config->baudRate ? config->baudRate : settings.baudRate;
+            settings.byteSize  = config->byte_size ? config->byte_size : settings.byteSize;
+            settings.stopBits  = config->stop_bits ? config->stop_bits : settings.stopBits;
+            settings.parity    = config->parity ? config->parity : settings.parity;
+            settings.useRts    = config->use_rts;
+            settings.useDtr    = config->use_dtr;
+            VID                = config->VID;
+            PID                = config->PID;
+        }
+
+        std::vector<std::string> candidates;
+        if (ports)
+        {
+            candidates.assign(ports, ports + portCount);
+        }
+        else
+        {
+            candidates = FindPorts(VID, PID);
+        }
+
+        std::vector<DiscoveryResult> results = DiscoverDevices(candidates, settings);
+        if (results.empty())
+        {
+            return list;
+        }
+
+        size_t size = results.size() * sizeof(DiscoveredPort_s);
+        for (const auto &result : results)
+        {
+            size += result.port.size() + result.answer.size() + 2;
+        }
+
+        list.ports = static_cast<DiscoveredPort_s *>(std::malloc(size));
+        if (!list.ports)
+        {
+            return list;
+        }
+
+        char *cursor = reinterpret_cast<char *>(list.ports + results.size());
+        auto  pack   = [&cursor](const std::string &text) {
+            char *start = cursor;
+            std::memcpy(cursor, text.c_str(), text.size() + 1);
+            cursor += text.size() + 1;
+            return start;
+        };
+
+        for (const auto &result : results)
+        {
+            DiscoveredPort_s &entry = list.ports[list.count++];
+            entry.serial            = pack(result.port);
+            entry.answer            = pack(result.answer);
+            entry.latencyUs         = result.latencyUs;
+
+            switch (result.status)
+            {
+                case DiscoveryStatus::Answered:   entry.error = NONE; break;
+                case DiscoveryStatus::NoAnswer:   entry.error = NO_DATA_RECEIVED; break;
+                case DiscoveryStatus::BadBcc:     entry.error = INVALID_FORMAT; break;
+                case DiscoveryStatus::OpenFailed: entry.error = PORT_OPEN_FAILED; break;
+                case DiscoveryStatus::SendFailed: entry.error = SEND_FAILED; break;
+                case DiscoveryStatus::IoError:
+                    entry.error = result.io.status == SerialStatus::Disconnected ? PORT_DISCONNECTED : IO_FAILED;
+                    break;
+            }
+        }
+
+        return list;
+    }
+
+    /**
+     * @brief Releases a list returned by OpenBSCSDKDiscover and empties it.
+     * @param list List to release (may be NULL)
+     */
+    BSC_SDK_EXPORT void OpenBSCSDKFreeDiscovery(struct DiscoveryList_s *list)
+    {
+        if (!list)
+        {
+            return;
+        }
+        std::free(list->ports);
+        *list = DiscoveryList_s{};
+    }
+
     /**
      * @brief Initializes the OpenBSC SDK with specified serial port parameters.
      * @param comSerial COM port to open
@@ -82,23 +294,16 @@ extern "C"
             return PORT_NOT_FOUND;
         }
 
-        ComPortList_s comList  = listPortSDK();
-        bool          findPort = false;
-
-        for (uint32_t i = 0; i < sizeof(comList.ComPort) / sizeof(comList.ComPort[0]); i++)
+        // In-memory loopback ports are never enumerated.
+        if (!IsLoopbackPortName(comSerial))
         {
-            if (std::strcmp(comList.ComPort[i].serial, comSerial) == 0)
+            SerialPortInfo info;
+            if (!SerialPortIndex::Instance().Find(comSerial, info))
             {
-                findPort = true;
-                break;
+                return PORT_NOT_FOUND;
             }
         }
 
-        if (!findPort)
-        {
-            return PORT_NOT_FOUND;
-        }
-
         if (!sdk.Open(comSerial))
         {
             return PORT_OPEN_FAILED;
@@ -131,10 +336,127 @@ extern "C"
         }
         else
         {
-            uint32_t received     = sdk.ReadResponse(resp.answer, sizeof(resp.answer) - 1, true);
+            uint32_t received     = sdk.ReadResponse(resp.answer, sizeof(resp.answer), SDK_RESPONSE_TIMEOUT_MS);
             resp.answer[received] = '\0';
+
+            // A timeout leaves the answer empty; a failing port is reported as such.
+            SerialResult io = sdk.LastIoResult();
+            if (io.Failed())
+            {
+                resp.error = io.status == SerialStatus::Disconnected ? PORT_DISCONNECTED : IO_FAILED;
+            }
         }
 
         return resp;
     }
+
+    /**
+     * @brief Sends several commands in one call, pipelining them, and collects their responses.
+     *
+     * The commands are framed and written back-to-back with up to OpenBSC::PIPELINE_WINDOW of
+     * them awaiting a response, which the device must send in order. Each outcome gets the
+     * answer of its command or its error: NO_DATA_RECEIVED when no response came before the
+     * deadline, INVALID_FORMAT for a bad BCC or an empty command, SEND_FAILED when the command
+     * was never written, IO_FAILED or PORT_DISCONNECTED when the port failed.
+     *
+     * @param cmds Commands, count entries
+     * @param lens Length of each command, or NULL for NUL-terminated commands
+     * @param count Number of commands
+     * @param outcomes Receives count outcomes, in the order of cmds
+     * @param timeoutMs Deadline of the whole batch in milliseconds, 0 for the default of OpenBSCSDKSend
+     * @return size_t Number of commands answered (error NONE)
+     */
+    BSC_SDK_EXPORT size_t OpenBSCSDKSendBatch(const char *const *cmds, const uint32_t *lens, size_t count, struct CommandOutcome_s *outcomes,
+                                              uint32_t timeoutMs)
+    {
+        if (!cmds || !outcomes)
+        {
+            return 0;
+        }
+
+        // Empty commands are rejected on their own; the others still go out.
+        std::vector<OpenBSC::PipelineRequest> requests;
+        std::vector<size_t>                   indexes;
+        requests.reserve(count);
+        indexes.reserve(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            outcomes[i].answer[0] = '\0';
+            uint32_t length       = !cmds[i] ? 0 : lens ? lens[i] : static_cast<uint32_t>(std::strlen(cmds[i]));
+            if (length == 0)
+            {
+                outcomes[i].error = INVALID_FORMAT;
+                continue;
+            }
+
+            OpenBSC::PipelineRequest request;
+            request.command    = cmds[i];
+            request.length     = length;
+            request.answer     = outcomes[i].answer;
+            request.answerSize = sizeof(outcomes[i].answer);
+            requests.push_back(request);
+            indexes.push_back(i);
+        }
+
+        size_t answered = sdk.Pipeline(requests.data(), requests.size(), timeoutMs ? timeoutMs : SDK_RESPONSE_TIMEOUT_MS);
+
+        SerialResult io = sdk.LastIoResult();
+        for (size_t r = 0; r < requests.size(); ++r)
+        {
+            CommandOutcome_s &outcome = outcomes[indexes[r]];
+            switch (requests[r].status)
+            {
+                case OpenBSC::ResponseStatus::Complete: outcome.error = NONE; break;
+                case OpenBSC::ResponseStatus::Timeout:  outcome.error = NO_DATA_RECEIVED; break;
+                case OpenBSC::ResponseStatus::BadBcc:   outcome.error = INVALID_FORMAT; break;
+                case OpenBSC::ResponseStatus::Pending:  outcome.error = SEND_FAILED; break;
+                case OpenBSC::ResponseStatus::Error:
+                    outcome.error = io.status == SerialStatus::Disconnected ? PORT_DISCONNECTED : IO_FAILED;
+                    break;
+            }
+        }
+
+        return answered;
+    }
+
+    /**
+     * @brief Copies the counters of the SDK session and of its serial port.
+     * @param stats Output structure
+     * @return errorList_e INVALID_FORMAT when stats is null, NONE otherwise
+     */
+    BSC_SDK_EXPORT enum errorList_e OpenBSCSDKGetStats(struct OpenBSCStats_s *stats)
+    {
+        if (!stats)
+        {
+            return INVALID_FORMAT;
+        }
+
+        OpenBSCStats snapshot    = sdk.Stats();
+        stats->commandsSent      = snapshot.commandsSent;
+        stats->responsesReceived = snapshot.responsesReceived;
+        stats->bccErrors         = snapshot.bccErrors;
+        stats->responseTimeouts  = snapshot.responseTimeouts;
+        std::memcpy(stats->responseUs, snapshot.responseUs, sizeof(stats->responseUs));
+
+        stats->bytesIn       = snapshot.serial.bytesIn;
+        stats->bytesOut      = snapshot.serial.bytesOut;
+        stats->readCalls     = snapshot.serial.readCalls;
+        stats->writeCalls    = snapshot.serial.writeCalls;
+        stats->pollWakeups   = snapshot.serial.pollWakeups;
+        stats->timeouts      = snapshot.serial.timeouts;
+        stats->partialWrites = snapshot.serial.partialWrites;
+        stats->errors        = snapshot.serial.errors;
+        stats->droppedBytes  = snapshot.serial.droppedBytes;
+        std::memcpy(stats->readWaitUs, snapshot.serial.readWaitUs, sizeof(stats->readWaitUs));
+        std::memcpy(stats->writeUs, snapshot.serial.writeUs, sizeof(stats->writeUs));
+        return NONE;
+    }
+
+    /**
+     * @brief Zeroes the counters of the SDK session and of its serial port.
+     */
+    BSC_SDK_EXPORT void OpenBSCSDKResetStats(void)
+    {
+        sdk.ResetStats();
+    }
 }
@@ -51,11 +51,10 @@ std::vector<std::string> FindPorts(unsigned short vid, unsigned short pid)
 
 #else
 
-#include <dirent.h>
-#include <regex>
+#include "SerialPortIndex.hpp"
 
 /**
- * @brief Lists available serial ports on Linux by scanning /dev
+ * @brief Lists available serial ports on Linux from the sysfs port index
  * @param vid Vendor ID (optional filter, 0 = ignore)
  * @param pid Product ID (optional filter, 0 = ignore)
  * @return Vector of port names (e.g., "/dev/ttyS0", "/dev/ttyUSB0")
@@ -63,27 +62,8 @@ std::vector<std::string> FindPorts(unsigned short vid, unsigned short pid)
 std::vector<std::string> FindPorts(unsigned short vid, unsigned short pid)
 {
     std::vector<std::string> ports;
-
-    const char* devDir = "/dev/";
-    DIR* dir = opendir(devDir);
-    if (!dir)
-        return ports;
-
-    std::regex serialRegex("(ttyS\\d+|ttyUSB\\d+|ttyACM\\d+)");
-
-    struct dirent* entry;
-    while ((entry = readdir(dir)) != nullptr)
-    {
-        std::string name(entry->d_name);
-        if (std::regex_match(name, serialRegex))
-        {
-            // Filtro por VID/PID ainda não implementado (para isso precisaria
-            // parsear /sys/class/tty/... e verificar os atributos USB).
-            ports.emplace_back(std::string(devDir) + name);
-        }
-    }
-
-    closedir(dir);
+    for (const SerialPortInfo& info : SerialPortIndex::Instance().List(vid, pid))
+        ports.push_back(info.device);
     return ports;
 }
 
@@ -8,7 +8,7 @@
  * @brief Lists available serial ports on the system.
  * 
  * On Windows, uses SetupAPI to find COM ports (e.g., "COM1", "COM3").
- * On Linux, scans /dev for serial devices (e.g., "/dev/ttyS0", "/dev/ttyUSB0").
+ * On Linux, reads the cached sysfs index of SerialPortIndex (e.g., "/dev/ttyS0", "/dev/ttyUSB0").
  * 
  * @return Vector of serial port names as strings.
  */
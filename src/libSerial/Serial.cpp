@@ -1,6 +1,14 @@
 #include "Serial.hpp"
+#include "SerialLoopback.hpp"
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <thread>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -11,16 +19,105 @@
 #include <sys/ioctl.h>
 #include <errno.h>
 #include <poll.h>
+#include <limits.h>
+#include <stdlib.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+#include "SerialUring.hpp"
+#include "SerialBaudRate.hpp"
+#include "SerialReactor.hpp"
+#endif
+
+// Longest time the receive thread blocks in the device before re-checking for a stop request
+static const unsigned int RX_POLL_SLICE_MS = 50;
+
+// Longest time Close() waits for the write queue to drain before dropping it
+static const unsigned int CLOSE_DRAIN_MS = 200;
+
+struct SerialCommunication::RxState
+{
+    explicit RxState(size_t capacity) : ring(capacity)
+    {
+    }
+
+    SpscRing                ring;
+    std::thread             thread;
+    std::atomic<bool>       running{true};
+    std::atomic<bool>       failed{false};
+    SerialResult            failure; // Written before failed is set
+    std::atomic<bool>       consumerWaiting{false};
+    std::atomic<bool>       producerWaiting{false};
+    std::mutex              mutex;
+    std::condition_variable dataReady;
+    std::condition_variable spaceReady;
+};
+
+// Largest deviation between requested and applied baud rate still considered usable (3%)
+static const uint32_t BAUD_TOLERANCE_PERCENT = 3;
+
+#ifndef _WIN32
+// Maps a rate to its termios constant; returns false for rates that need BOTHER.
+static bool standardSpeed(uint32_t baudRate, speed_t& speed)
+{
+    static const struct
+    {
+        uint32_t rate;
+        speed_t  speed;
+    } table[] = {
+        {50, B50},           {75, B75},           {110, B110},         {134, B134},         {150, B150},         {200, B200},
+        {300, B300},         {600, B600},         {1200, B1200},       {1800, B1800},       {2400, B2400},       {4800, B4800},
+        {9600, B9600},       {19200, B19200},     {38400, B38400},     {57600, B57600},     {115200, B115200},   {230400, B230400},
+#ifdef B460800
+        {460800, B460800},
+#endif
+#ifdef B500000
+        {500000, B500000},   {576000, B576000},   {921600, B921600},   {1000000, B1000000}, {1152000, B1152000}, {1500000, B1500000},
+        {2000000, B2000000}, {2500000, B2500000}, {3000000, B3000000}, {3500000, B3500000}, {4000000, B4000000},
+#endif
+    };
+
+    for (const auto& entry : table)
+    {
+        if (entry.rate == baudRate)
+        {
+            speed = entry.speed;
+            return true;
+        }
+    }
+    return false;
+}
 #endif
 
 // Factory method
 std::shared_ptr<SerialCommunication> SerialCommunication::Create(const std::string& portName, uint32_t baudRate, 
                                                                  uint8_t dataBits, uint8_t stopBits, char parity,
-                                                                 bool enableRts, bool enableDtr)
+                                                                 bool enableRts, bool enableDtr,
+                                                                 const SerialOptions& options)
 {
-    auto instance = std::shared_ptr<SerialCommunication>(
-        new SerialCommunication(portName, baudRate, dataBits, stopBits, parity, enableRts, enableDtr)
-    );
+    std::shared_ptr<SerialCommunication> instance;
+
+    if (IsLoopbackPortName(portName))
+        instance = std::make_shared<LoopbackSerialCommunication>(portName, baudRate, dataBits, stopBits, parity, enableRts, enableDtr,
+                                                                 options.loopback);
+
+#ifndef _WIN32
+    if (!instance && options.backend == SerialBackend::IoUring && UringRing::Available())
+        instance = std::make_shared<UringSerialCommunication>(portName, baudRate, dataBits, stopBits, parity, enableRts, enableDtr);
+#endif
+
+    if (!instance)
+        instance = std::shared_ptr<SerialCommunication>(
+            new SerialCommunication(portName, baudRate, dataBits, stopBits, parity, enableRts, enableDtr)
+        );
+
+    instance->rxRingCapacity_ = options.rxRingCapacity;
+    instance->lowLatency_     = options.lowLatency;
+    instance->writeHighWater_ = options.writeHighWater;
+    instance->writeTimeoutMs_ = options.writeTimeoutMs;
+    instance->readMode_       = options.readMode;
+    instance->capture_        = options.capture;
+    instance->capturePortId_  = options.capturePortId;
 
     if (!instance->Open())
         return nullptr;
@@ -31,7 +128,9 @@ std::shared_ptr<SerialCommunication> SerialCommunication::Create(const std::stri
 SerialCommunication::SerialCommunication(const std::string& portName, uint32_t baudRate, uint8_t dataBits,
                                          uint8_t stopBits, char parity, bool enableRts, bool enableDtr)
     : portName_(portName), baudRate_(baudRate), dataBits_(dataBits), stopBits_(stopBits),
-      parity_(parity), enableRts_(enableRts), enableDtr_(enableDtr), isOpen_(false)
+      parity_(parity), enableRts_(enableRts), enableDtr_(enableDtr), isOpen_(false), rxRingCapacity_(0), actualBaudRate_(0),
+      lowLatency_(false), savedSerialFlags_(-1), savedLatencyTimer_(-1), writeQueueHead_(0), writeHighWater_(SerialOptions().writeHighWater), flushArmed_(false),
+      writeTimeoutMs_(SerialOptions().writeTimeoutMs), capturePortId_(0), rxStashHead_(0)
 {
 #ifdef _WIN32
     handle_ = INVALID_HANDLE_VALUE;
@@ -46,6 +145,52 @@ SerialCommunication::~SerialCommunication()
 }
 
 bool SerialCommunication::Open()
+{
+    if (isOpen_)
+        return true;
+
+    if (!openDevice())
+        return false;
+
+    isOpen_ = true;
+
+    if (lowLatency_)
+        applyLowLatency();
+
+    if (rxRingCapacity_)
+        StartRxThread(rxRingCapacity_);
+
+    return true;
+}
+
+void SerialCommunication::Close()
+{
+    if (!isOpen_)
+        return;
+
+    StopRxThread();
+    restoreLowLatency();
+
+    {
+        // Give queued data a bounded time to leave; whatever is still queued after that is
+        // dropped and counted in Stats().droppedBytes.
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        drainWriteQueue(std::min(writeTimeoutMs_, CLOSE_DRAIN_MS));
+        if (pendingWriteLocked() > 0)
+            stats_.RecordDropped(pendingWriteLocked());
+        writeQueue_.clear();
+        writeQueueHead_ = 0;
+        disarmFlush();
+    }
+
+    rxStash_.clear();
+    rxStashHead_ = 0;
+
+    closeDevice();
+    isOpen_ = false;
+}
+
+bool SerialCommunication::openDevice()
 {
 #ifdef _WIN32
     handle_ = CreateFileA(portName_.c_str(),
@@ -61,7 +206,7 @@ bool SerialCommunication::Open()
 
     if (!configurePort())
     {
-        Close();
+        closeDevice();
         return false;
     }
 
@@ -70,76 +215,661 @@ bool SerialCommunication::Open()
     if (fd_ < 0)
         return false;
 
-    if (!configurePort())
+    if (!configurePort() || !applyReadMode())
     {
-        Close();
+        closeDevice();
         return false;
     }
 #endif
 
-    isOpen_ = true;
     return true;
 }
 
-void SerialCommunication::Close()
+void SerialCommunication::closeDevice()
 {
-    if (!isOpen_)
-        return;
-
 #ifdef _WIN32
-    CloseHandle(handle_);
+    if (handle_ != INVALID_HANDLE_VALUE)
+        CloseHandle(handle_);
     handle_ = INVALID_HANDLE_VALUE;
 #else
-    ::close(fd_);
+
+    if (fd_ >= 0)
+        ::close(fd_);
     fd_ = -1;
 #endif
+}
 
-    isOpen_ = false;
+const char* SerialStatusText(SerialStatus status) noexcept
+{
+    switch (status)
+    {
+        case SerialStatus::Ok:              return "Ok";
+        case SerialStatus::Timeout:         return "Timeout";
+        case SerialStatus::NotOpen:         return "Port not open";
+        case SerialStatus::IoError:         return "I/O error";
+        case SerialStatus::Disconnected:    return "Device disconnected";
+        case SerialStatus::InvalidArgument: return "Invalid argument";
+    }
+    return "Unknown status";
 }
 
+// Throwing layer over the Try* calls: a timeout returns what was transferred unless the
+// call treats it as a failure, everything else throws.
+static size_t valueOrThrow(const SerialResult& result, bool timeoutIsError = false)
+{
+    if (result.status == SerialStatus::Ok || (result.status == SerialStatus::Timeout && !timeoutIsError))
+        return result.bytes;
+    throw std::runtime_error(SerialStatusText(result.status));
+}
+
+#ifdef _WIN32
+static SerialResult systemFailure()
+{
+    return SerialResult::Failure(SerialStatus::IoError, static_cast<int>(GetLastError()));
+}
+#else
+// Classifies the errno of a failed call; unplugged USB adapters report EIO or ENXIO/ENODEV.
+static SerialResult systemFailure(int error = errno)
+{
+    switch (error)
+    {
+        case EIO:
+        case ENXIO:
+        case ENODEV: return SerialResult::Failure(SerialStatus::Disconnected, error);
+        case EBADF:  return SerialResult::Failure(SerialStatus::NotOpen, error);
+        default:     return SerialResult::Failure(SerialStatus::IoError, error);
+    }
+}
+#endif
+
 size_t SerialCommunication::Write(const void* buffer, size_t length)
+{
+    return valueOrThrow(TryWrite(buffer, length), true);
+}
+
+size_t SerialCommunication::WriteV(const iovec* iov, size_t count)
+{
+    return valueOrThrow(TryWriteV(iov, count), true);
+}
+
+SerialResult SerialCommunication::TryWrite(const void* buffer, size_t length) noexcept
+{
+    iovec segment;
+    segment.iov_base = const_cast<void*>(buffer);
+    segment.iov_len  = length;
+    return TryWriteV(&segment, 1);
+}
+
+SerialResult SerialCommunication::TryWriteV(const iovec* iov, size_t count) noexcept
+{
+    if (!isOpen_)
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+        total += iov[i].iov_len;
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    SerialResult result = submitWrite(iov, count, total);
+    if (!result)
+        return result;
+
+    // Backpressure: hold the caller while the queue is above the high-water mark.
+    while (pendingWriteLocked() > writeHighWater_)
+    {
+        SerialResult ready = deviceWaitWritable(writeTimeoutMs_);
+        if (ready.status == SerialStatus::Timeout)
+            return SerialResult::TimedOut(total);
+        if (!ready)
+            return ready;
+
+        SerialResult flushed = flushWriteQueue();
+        if (!flushed)
+            return flushed;
+    }
+
+    return result;
+}
+
+size_t SerialCommunication::QueueWrite(const void* buffer, size_t length)
 {
     if (!isOpen_)
         throw std::runtime_error("Port not open");
 
+    iovec segment;
+    segment.iov_base = const_cast<void*>(buffer);
+    segment.iov_len  = length;
+    return valueOrThrow(TryQueueWriteV(&segment, 1));
+}
+
+SerialResult SerialCommunication::TryQueueWriteV(const iovec* iov, size_t count) noexcept
+{
+    if (!isOpen_)
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+        total += iov[i].iov_len;
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    if (pendingWriteLocked() >= writeHighWater_)
+    {
+        SerialResult flushed = flushWriteQueue();
+        if (!flushed)
+            return flushed;
+        if (flushed.bytes >= writeHighWater_)
+            return SerialResult::TimedOut(0);
+    }
+    return submitWrite(iov, count, total);
+}
+
+size_t SerialCommunication::PendingWrite() const
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return pendingWriteLocked();
+}
+
+bool SerialCommunication::WriteBlocked() const
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return pendingWriteLocked() >= writeHighWater_;
+}
+
+void SerialCommunication::SetWriteHighWater(size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    writeHighWater_ = bytes;
+}
+
+size_t SerialCommunication::ProcessWritable()
+{
+    if (!isOpen_)
+        throw std::runtime_error("Port not open");
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return valueOrThrow(flushWriteQueue());
+}
+
+bool SerialCommunication::DrainWrites(unsigned int timeoutMs)
+{
+    SerialResult drained = TryDrainWrites(timeoutMs);
+    if (drained.status == SerialStatus::Timeout)
+        return false;
+    valueOrThrow(drained);
+    return true;
+}
+
+SerialResult SerialCommunication::TryDrainWrites(unsigned int timeoutMs) noexcept
+{
+    if (!isOpen_)
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    return drainWriteQueue(timeoutMs);
+}
+
+SerialResult SerialCommunication::drainWriteQueue(unsigned int timeoutMs)
+{
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    for (;;)
+    {
+        SerialResult flushed = flushWriteQueue();
+        if (!flushed || flushed.bytes == 0)
+            return flushed;
+
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0)
+            return SerialResult::TimedOut(flushed.bytes);
+
+        SerialResult ready = deviceWaitWritable(static_cast<unsigned int>(remaining.count()));
+        if (!ready && ready.status != SerialStatus::Timeout)
+            return ready;
+    }
+}
+
+// Writes directly when nothing is queued, so the common case never copies; the rest is queued.
+SerialResult SerialCommunication::submitWrite(const iovec* iov, size_t count, size_t total)
+{
+    size_t written = 0;
+    if (pendingWriteLocked() == 0)
+    {
+        SerialResult direct = deviceWrite(iov, count);
+        if (!direct)
+            return direct;
+        written = direct.bytes;
+    }
+
+    if (written < total)
+    {
+        if (writeQueueHead_ == writeQueue_.size())
+        {
+            writeQueue_.clear();
+            writeQueueHead_ = 0;
+        }
+
+        size_t skip = written;
+        for (size_t i = 0; i < count; ++i)
+        {
+            const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+            size_t         len  = iov[i].iov_len;
+            if (skip >= len)
+            {
+                skip -= len;
+                continue;
+            }
+            writeQueue_.insert(writeQueue_.end(), base + skip, base + len);
+            skip = 0;
+        }
+
+        SerialResult flushed = flushWriteQueue();
+        if (!flushed)
+            return flushed;
+        armFlush();
+    }
+
+    return SerialResult::Transferred(total);
+}
+
+#ifndef _WIN32
+// One shard thread sends queued data of every port once it becomes writable. It is never
+// destroyed: at exit it may still own the last reference to a port whose queue is draining.
+static SerialReactor& writeFlusher()
+{
+    static SerialReactor* reactor = [] {
+        SerialReactor* created = new SerialReactor(1);
+        created->Start();
+        return created;
+    }();
+    return *reactor;
+}
+#endif
+
+// Caller holds writeMutex_. The flusher keeps the port alive until the queue is empty.
+void SerialCommunication::armFlush() noexcept
+{
+#ifndef _WIN32
+    if (flushArmed_ || pendingWriteLocked() == 0)
+        return;
+
+    try
+    {
+        flushArmed_ = writeFlusher().Add(
+            shared_from_this(), [](SerialCommunication& port, uint32_t events) { port.flushWritable(events); },
+            SerialReactor::Writable);
+    }
+    catch (const std::exception&)
+    {
+        // Not owned by a shared_ptr, or no reactor: the queue moves on the next write or drain.
+    }
+#endif
+}
+
+// Caller holds writeMutex_.
+void SerialCommunication::disarmFlush() noexcept
+{
+#ifndef _WIN32
+    if (!flushArmed_)
+        return;
+    flushArmed_ = false;
+    writeFlusher().Remove(*this);
+#endif
+}
+
+void SerialCommunication::flushWritable(uint32_t events)
+{
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    SerialResult                flushed = flushWriteQueue();
+
+    // A failed or hung-up port stays writable forever; the next write arms the flusher again.
+    if (!flushed || flushed.bytes == 0 || (events & SerialReactor::Error))
+        disarmFlush();
+}
+
+SerialResult SerialCommunication::flushWriteQueue()
+{
+    SerialResult failure;
+    while (pendingWriteLocked() > 0)
+    {
+        iovec segment;
+        segment.iov_base = writeQueue_.data() + writeQueueHead_;
+        segment.iov_len  = pendingWriteLocked();
+
+        SerialResult written = deviceWrite(&segment, 1);
+        if (!written)
+            failure = written;
+        if (!written || written.bytes == 0)
+            break;
+        writeQueueHead_ += written.bytes;
+    }
+
+    if (writeQueueHead_ == writeQueue_.size())
+    {
+        writeQueue_.clear();
+        writeQueueHead_ = 0;
+    }
+    else if (writeQueueHead_ > writeQueue_.size() / 2)
+    {
+        // Reclaim the sent half so a queue that never fully drains does not keep growing.
+        writeQueue_.erase(writeQueue_.begin(), writeQueue_.begin() + static_cast<std::ptrdiff_t>(writeQueueHead_));
+        writeQueueHead_ = 0;
+    }
+
+    if (!failure)
+        return failure;
+    return SerialResult::Transferred(pendingWriteLocked());
+}
+
+size_t SerialCommunication::pendingWriteLocked() const
+{
+    return writeQueue_.size() - writeQueueHead_;
+}
+
+// Counted wrappers around the device hooks; every call site goes through these.
+SerialResult SerialCommunication::deviceRead(void* buffer, size_t length, unsigned int timeoutMs) noexcept
+{
+    auto         start  = std::chrono::steady_clock::now();
+    SerialResult result = readDevice(buffer, length, timeoutMs);
+    if (result.Failed())
+    {
+        stats_.RecordError();
+        return result;
+    }
+    stats_.RecordRead(result.bytes, timeoutMs > 0, std::chrono::steady_clock::now() - start);
+    if (capture_ && result.bytes)
+        capture_->Record(capturePortId_, CaptureDirection::Rx, buffer, result.bytes);
+    return result;
+}
+
+SerialResult SerialCommunication::deviceReadNow(void* buffer, size_t length) noexcept
+{
+    SerialResult result = readDeviceNow(buffer, length);
+    if (result.Failed())
+    {
+        stats_.RecordError();
+        return result;
+    }
+    stats_.RecordRead(result.bytes, false, std::chrono::steady_clock::duration::zero());
+    if (capture_ && result.bytes)
+        capture_->Record(capturePortId_, CaptureDirection::Rx, buffer, result.bytes);
+    return result;
+}
+
+SerialResult SerialCommunication::deviceWrite(const iovec* iov, size_t count) noexcept
+{
+    size_t requested = 0;
+    for (size_t i = 0; i < count; ++i)
+        requested += iov[i].iov_len;
+
+    auto         start  = std::chrono::steady_clock::now();
+    SerialResult result = writeDevice(iov, count);
+    if (result.Failed())
+    {
+        stats_.RecordError();
+        return result;
+    }
+    stats_.RecordWrite(requested, result.bytes, std::chrono::steady_clock::now() - start);
+    if (capture_ && result.bytes)
+        capture_->Record(capturePortId_, CaptureDirection::Tx, iov, count, result.bytes);
+    return result;
+}
+
+SerialResult SerialCommunication::deviceWaitWritable(unsigned int timeoutMs) noexcept
+{
+    SerialResult ready = waitWritable(timeoutMs);
+    if (ready.Failed())
+    {
+        stats_.RecordError();
+        return ready;
+    }
+    stats_.RecordWritableWait(ready.status == SerialStatus::Ok);
+    return ready;
+}
+
+SerialResult SerialCommunication::writeDevice(const iovec* iov, size_t count) noexcept
+{
 #ifdef _WIN32
-    DWORD written;
-    if (!WriteFile(handle_, buffer, static_cast<DWORD>(length), &written, nullptr))
-        throw std::runtime_error("Write failed");
-    if (written != length)
-        throw std::runtime_error("Incomplete write");
+    size_t total   = 0;
+    size_t written = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        total += iov[i].iov_len;
+
+        DWORD chunk;
+        if (!WriteFile(handle_, iov[i].iov_base, static_cast<DWORD>(iov[i].iov_len), &chunk, nullptr))
+            return systemFailure();
+        written += chunk;
+        if (chunk != iov[i].iov_len)
+            break;
+    }
+    // WriteFile blocks, so a short write means the write timeout expired.
+    if (written != total)
+        return SerialResult::TimedOut(written);
 
+    return SerialResult::Transferred(written);
 #else
-    ssize_t written = ::write(fd_, buffer, length);
+    if (count > IOV_MAX)
+        return SerialResult::Failure(SerialStatus::InvalidArgument);
+
+    ssize_t written = ::writev(fd_, iov, static_cast<int>(count));
     if (written < 0)
-        throw std::runtime_error("Write failed");
-    if (static_cast<size_t>(written) != length)
-        throw std::runtime_error("Incomplete write");
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return SerialResult::Transferred(0);
+        return systemFailure();
+    }
     
-    return static_cast<size_t>(written);
+    return SerialResult::Transferred(static_cast<size_t>(written));
+#endif
+}
+
+SerialResult SerialCommunication::waitWritable(unsigned int timeoutMs) noexcept
+{
+#ifdef _WIN32
+    (void)timeoutMs;
+    return SerialResult();
+#else
+    struct pollfd pfd;
+    pfd.fd     = fd_;
+    pfd.events = POLLOUT;
+
+    int ret = poll(&pfd, 1, static_cast<int>(timeoutMs));
+    if (ret < 0)
+    {
+        if (errno == EINTR)
+            return SerialResult();
+        return systemFailure();
+    }
+    if (ret > 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+        return SerialResult::Failure(SerialStatus::Disconnected);
+
+    return ret > 0 ? SerialResult() : SerialResult::TimedOut();
 #endif
 }
 
 size_t SerialCommunication::Read(void* buffer, size_t length, unsigned int timeoutMs)
+{
+    return valueOrThrow(TryRead(buffer, length, timeoutMs));
+}
+
+SerialResult SerialCommunication::TryRead(void* buffer, size_t length, unsigned int timeoutMs) noexcept
 {
     if (!isOpen_)
-        throw std::runtime_error("Port not open");
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    if (rxStashHead_ < rxStash_.size())
+        return SerialResult::Received(takeStash(buffer, length));
 
+    if (rx_)
+        return readFromRing(buffer, length, timeoutMs);
+
+    return deviceRead(buffer, length, timeoutMs);
+}
+
+// Milliseconds left until deadline, rounded up so a wait never ends just before it; 0 once passed.
+static unsigned int remainingMs(SerialCommunication::Deadline deadline)
+{
+    auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+    return remaining.count() > 0 ? static_cast<unsigned int>(remaining.count()) : 0;
+}
+
+size_t SerialCommunication::ReadExact(void* buffer, size_t length, Deadline deadline)
+{
+    return valueOrThrow(TryReadExact(buffer, length, deadline));
+}
+
+SerialResult SerialCommunication::TryReadExact(void* buffer, size_t length, Deadline deadline) noexcept
+{
+    if (!isOpen_)
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    uint8_t* out    = static_cast<uint8_t*>(buffer);
+    size_t   copied = takeStash(out, length);
+
+    while (copied < length)
+    {
+        unsigned int timeoutMs = remainingMs(deadline);
+        SerialResult result    = rx_ ? readFromRing(out + copied, length - copied, timeoutMs)
+                                     : deviceRead(out + copied, length - copied, timeoutMs);
+        if (result.Failed())
+        {
+            result.bytes = copied;
+            return result;
+        }
+        copied += result.bytes;
+
+        if (result.bytes == 0 && timeoutMs == 0)
+            return SerialResult::TimedOut(copied);
+    }
+
+    return SerialResult::Transferred(copied);
+}
+
+size_t SerialCommunication::ReadUntil(void* buffer, size_t maxLength, uint8_t delimiter, Deadline deadline)
+{
+    return valueOrThrow(TryReadUntil(buffer, maxLength, delimiter, deadline));
+}
+
+SerialResult SerialCommunication::TryReadUntil(void* buffer, size_t maxLength, uint8_t delimiter, Deadline deadline) noexcept
+{
+    if (!isOpen_)
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    uint8_t* out    = static_cast<uint8_t*>(buffer);
+    size_t   copied = 0;
+
+    // Leftovers of an earlier call come first; they may already hold a complete line.
+    if (rxStashHead_ < rxStash_.size())
+    {
+        const uint8_t* begin = rxStash_.data() + rxStashHead_;
+        size_t         n     = std::min(rxStash_.size() - rxStashHead_, maxLength);
+        const void*    found = std::memchr(begin, delimiter, n);
+        if (found)
+            n = static_cast<const uint8_t*>(found) - begin + 1;
+
+        copied = takeStash(out, n);
+        if (found)
+            return SerialResult::Transferred(copied);
+    }
+
+    while (copied < maxLength)
+    {
+        unsigned int timeoutMs = remainingMs(deadline);
+
+        if (rx_)
+        {
+            // Scan the ring in place and consume only up to the delimiter.
+            ByteSpan     span;
+            SerialResult peeked = TryPeekRx(timeoutMs, span);
+            if (peeked.Failed())
+            {
+                peeked.bytes = copied;
+                return peeked;
+            }
+            if (span.size == 0)
+            {
+                if (timeoutMs == 0)
+                    return SerialResult::TimedOut(copied);
+                continue;
+            }
+
+            size_t      n     = std::min(span.size, maxLength - copied);
+            const void* found = std::memchr(span.data, delimiter, n);
+            if (found)
+                n = static_cast<const uint8_t*>(found) - span.data + 1;
+
+            std::memcpy(out + copied, span.data, n);
+            ConsumeRx(n);
+            copied += n;
+            if (found)
+                return SerialResult::Transferred(copied);
+            continue;
+        }
+
+        SerialResult result = deviceRead(out + copied, maxLength - copied, timeoutMs);
+        if (result.Failed())
+        {
+            result.bytes = copied;
+            return result;
+        }
+
+        size_t n = result.bytes;
+        if (n == 0)
+        {
+            if (timeoutMs == 0)
+                return SerialResult::TimedOut(copied);
+            continue;
+        }
+
+        const uint8_t* chunk = out + copied;
+        const void*    found = std::memchr(chunk, delimiter, n);
+        copied += n;
+        if (found)
+        {
+            // Keep what arrived after the delimiter for the next read.
+            size_t used = static_cast<const uint8_t*>(found) - chunk + 1;
+            rxStash_.assign(chunk + used, chunk + n);
+            rxStashHead_ = 0;
+            return SerialResult::Transferred(copied - (n - used));
+        }
+    }
+
+    return SerialResult::Transferred(copied);
+}
+
+size_t SerialCommunication::takeStash(void* buffer, size_t length)
+{
+    size_t n = std::min(rxStash_.size() - rxStashHead_, length);
+    if (n == 0)
+        return 0;
+
+    std::memcpy(buffer, rxStash_.data() + rxStashHead_, n);
+    rxStashHead_ += n;
+    if (rxStashHead_ == rxStash_.size())
+    {
+        rxStash_.clear();
+        rxStashHead_ = 0;
+    }
+    return n;
+}
+
+SerialResult SerialCommunication::readDevice(void* buffer, size_t length, unsigned int timeoutMs) noexcept
+{
 #ifdef _WIN32
     // Setup timeout via COMMTIMEOUTS
     COMMTIMEOUTS timeouts = {0};
-    timeouts.ReadIntervalTimeout = timeoutMs;
+    timeouts.ReadIntervalTimeout = readMode_.interByteTimeout ? readMode_.interByteTimeout * 100u : timeoutMs;
     timeouts.ReadTotalTimeoutConstant = timeoutMs;
     timeouts.ReadTotalTimeoutMultiplier = 0;
 
     if (!SetCommTimeouts(handle_, &timeouts))
-        throw std::runtime_error("Failed to set timeouts");
+        return systemFailure();
 
     DWORD readBytes = 0;
     if (!ReadFile(handle_, buffer, static_cast<DWORD>(length), &readBytes, nullptr))
-        throw std::runtime_error("Read failed");
+        return systemFailure();
 
-    return static_cast<size_t>(readBytes);
+    return SerialResult::Received(static_cast<size_t>(readBytes));
 
 #else
     struct pollfd pfd;
@@ -148,32 +878,445 @@ size_t SerialCommunication::Read(void* buffer, size_t length, unsigned int timeo
 
     int ret = poll(&pfd, 1, timeoutMs);
     if (ret < 0)
-        throw std::runtime_error("Poll error");
+        return errno == EINTR ? SerialResult::TimedOut() : systemFailure();
     else if (ret == 0)
-        return 0; // timeout
+        return SerialResult::TimedOut();
 
     ssize_t n = ::read(fd_, buffer, length);
     if (n < 0)
-        throw std::runtime_error("Read error");
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return SerialResult::TimedOut();
+        return systemFailure();
+    }
+    // Readable but nothing to read: the line was hung up.
+    if (n == 0 && (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)))
+        return SerialResult::Failure(SerialStatus::Disconnected);
 
-    return static_cast<size_t>(n);
+    // The kernel ignores VTIME for non-blocking reads, so the inter-byte timer of a timed
+    // burst is run here: keep reading while the next byte follows within the timer.
+    size_t wanted = std::min<size_t>(readMode_.minBytes, length);
+    if (readMode_.interByteTimeout == 0)
+        wanted = 0;
+
+    size_t got = static_cast<size_t>(n);
+    while (got > 0 && got < wanted)
+    {
+        ret = poll(&pfd, 1, readMode_.interByteTimeout * 100);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            break;
+
+        n = ::read(fd_, static_cast<uint8_t*>(buffer) + got, length - got);
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+            continue;
+        if (n <= 0)
+            break; // Keep the bytes already read; the failure shows on the next read
+        got += static_cast<size_t>(n);
+    }
+
+    return SerialResult::Received(got);
 #endif
 }
 
 void SerialCommunication::Flush()
+{
+    valueOrThrow(TryFlush());
+}
+
+SerialResult SerialCommunication::TryFlush() noexcept
 {
     if (!isOpen_)
-        throw std::runtime_error("Port not open");
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    if (!flushDevice())
+        return systemFailure();
+
+    if (rx_)
+        rx_->ring.Clear();
+
+    rxStash_.clear();
+    rxStashHead_ = 0;
+
+    std::lock_guard<std::mutex> lock(writeMutex_);
+    writeQueue_.clear();
+    writeQueueHead_ = 0;
+    return SerialResult();
+}
+
+size_t SerialCommunication::ReadAvailable(void* buffer, size_t length)
+{
+    return valueOrThrow(TryReadAvailable(buffer, length));
+}
+
+SerialResult SerialCommunication::TryReadAvailable(void* buffer, size_t length) noexcept
+{
+    if (!isOpen_)
+        return SerialResult::Failure(SerialStatus::NotOpen);
+
+    if (rxStashHead_ < rxStash_.size())
+        return SerialResult::Received(takeStash(buffer, length));
+
+    if (rx_)
+        return readFromRing(buffer, length, 0);
+
+    return deviceReadNow(buffer, length);
+}
+
+bool SerialCommunication::flushDevice()
+{
+#ifdef _WIN32
+    return PurgeComm(handle_, PURGE_RXCLEAR | PURGE_TXCLEAR) != 0;
+#else
+    return tcflush(fd_, TCIOFLUSH) == 0;
+#endif
+}
+
+SerialResult SerialCommunication::readDeviceNow(void* buffer, size_t length) noexcept
+{
+#ifdef _WIN32
+    return readDevice(buffer, length, 0);
+#else
+    ssize_t n = ::read(fd_, buffer, length);
+    if (n < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)
+            return SerialResult::TimedOut();
+        return systemFailure();
+    }
+    // VMIN is at least 1, so an empty buffer gives EAGAIN; 0 bytes is end of file (hang-up).
+    if (n == 0 && length > 0)
+        return SerialResult::Failure(SerialStatus::Disconnected);
+
+    return SerialResult::Received(static_cast<size_t>(n));
+#endif
+}
+
+bool SerialCommunication::StartRxThread(size_t capacity)
+{
+    if (!isOpen_)
+        return false;
+    if (rx_)
+        return true;
+
+    rx_.reset(new RxState(capacity));
+    rx_->thread = std::thread(&SerialCommunication::rxLoop, this);
+    return true;
+}
+
+void SerialCommunication::StopRxThread()
+{
+    if (!rx_)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(rx_->mutex);
+        rx_->running = false;
+        rx_->spaceReady.notify_all();
+    }
+
+    if (rx_->thread.joinable())
+        rx_->thread.join();
+    rx_.reset();
+}
+
+bool SerialCommunication::RxThreadActive() const
+{
+    return rx_ != nullptr;
+}
+
+ByteSpan SerialCommunication::PeekRx(unsigned int timeoutMs)
+{
+    ByteSpan     span;
+    SerialResult result = TryPeekRx(timeoutMs, span);
+    if (result.status == SerialStatus::InvalidArgument)
+        throw std::runtime_error("Receive thread not running");
+    valueOrThrow(result);
+    return span;
+}
+
+SerialResult SerialCommunication::TryPeekRx(unsigned int timeoutMs, ByteSpan& span) noexcept
+{
+    span = ByteSpan();
+    if (!rx_)
+        return SerialResult::Failure(SerialStatus::InvalidArgument);
+
+    RxState& rx = *rx_;
+    span        = rx.ring.ReadableRegion();
+
+    if (span.size == 0 && timeoutMs > 0)
+    {
+        std::unique_lock<std::mutex> lock(rx.mutex);
+        rx.consumerWaiting = true;
+        rx.dataReady.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&rx] { return rx.ring.Size() > 0 || rx.failed; });
+        rx.consumerWaiting = false;
+        span               = rx.ring.ReadableRegion();
+    }
+
+    if (span.size == 0 && rx.failed)
+        return rx.failure;
+
+    return SerialResult::Received(span.size);
+}
+
+void SerialCommunication::ConsumeRx(size_t count)
+{
+    if (!rx_ || count == 0)
+        return;
+
+    rx_->ring.Consume(count);
+    if (rx_->producerWaiting)
+    {
+        std::lock_guard<std::mutex> lock(rx_->mutex);
+        rx_->spaceReady.notify_one();
+    }
+}
+
+SerialResult SerialCommunication::readFromRing(void* buffer, size_t length, unsigned int timeoutMs) noexcept
+{
+    uint8_t* out    = static_cast<uint8_t*>(buffer);
+    size_t   copied = 0;
+
+    // The readable region may wrap around the end of the ring: copy both halves if needed.
+    while (copied < length)
+    {
+        ByteSpan     span;
+        SerialResult result = TryPeekRx(copied == 0 ? timeoutMs : 0, span);
+        if (result.Failed() && copied == 0)
+            return result;
+        if (span.size == 0)
+            break;
+
+        size_t n = std::min(span.size, length - copied);
+        std::memcpy(out + copied, span.data, n);
+        ConsumeRx(n);
+        copied += n;
+    }
+
+    return SerialResult::Received(copied);
+}
+
+void SerialCommunication::rxLoop()
+{
+    RxState& rx = *rx_;
+
+    while (rx.running)
+    {
+        SpscRing::Region region = rx.ring.WritableRegion();
+        if (region.size == 0)
+        {
+            // Ring full: leave the data in the kernel until the consumer catches up.
+            std::unique_lock<std::mutex> lock(rx.mutex);
+            rx.producerWaiting = true;
+            rx.spaceReady.wait_for(lock, std::chrono::milliseconds(RX_POLL_SLICE_MS),
+                                   [&rx] { return !rx.running || rx.ring.Size() < rx.ring.Capacity(); });
+            rx.producerWaiting = false;
+            continue;
+        }
+
+        SerialResult result   = deviceRead(region.data, region.size, RX_POLL_SLICE_MS);
+        size_t       received = result.bytes;
+        if (result.Failed())
+        {
+            received   = 0;
+            rx.failure = result;
+            rx.failed  = true;
+            rx.running = false;
+        }
+
+        if (received > 0)
+            rx.ring.CommitWrite(received);
+
+        if (rx.consumerWaiting && (received > 0 || rx.failed))
+        {
+            std::lock_guard<std::mutex> lock(rx.mutex);
+            rx.dataReady.notify_one();
+        }
+    }
+}
+
+SerialStatsSnapshot SerialCommunication::Stats() const
+{
+    return stats_.Snapshot();
+}
+
+void SerialCommunication::ResetStats()
+{
+    stats_.Reset();
+}
+
+void SerialCommunication::SetCapture(std::shared_ptr<SerialCapture> capture, uint32_t portId)
+{
+    capture_       = std::move(capture);
+    capturePortId_ = portId;
+}
+
+bool SerialCommunication::IsOpen() const
+{
+    return isOpen_;
+}
+
+#ifdef __linux__
+// USB-serial latency_timer attribute of the tty behind portName, empty if the driver has none.
+static std::string latencyTimerPath(const std::string& portName)
+{
+    char resolved[PATH_MAX];
+    if (!realpath(portName.c_str(), resolved))
+        return std::string();
+
+    const char* tty = std::strrchr(resolved, '/');
+    tty             = tty ? tty + 1 : resolved;
+
+    std::string   path = std::string("/sys/bus/usb-serial/devices/") + tty + "/latency_timer";
+    std::ifstream probe(path);
+    return probe.good() ? path : std::string();
+}
+
+static int readLatencyTimer(const std::string& path)
+{
+    std::ifstream in(path);
+    int           value = -1;
+    if (!(in >> value))
+        return -1;
+    return value;
+}
+
+static bool writeLatencyTimer(const std::string& path, int value)
+{
+    std::ofstream out(path);
+    out << value;
+    out.flush();
+    return out.good();
+}
+#endif
+
+bool SerialCommunication::SetLowLatency(bool enable)
+{
+    lowLatency_ = enable;
+    if (!isOpen_)
+        return true;
+
+    return enable ? applyLowLatency() : restoreLowLatency();
+}
+
+bool SerialCommunication::applyLowLatency()
+{
+#ifdef __linux__
+    bool applied = false;
+
+    struct serial_struct info;
+    if (ioctl(fd_, TIOCGSERIAL, &info) == 0)
+    {
+        if (savedSerialFlags_ < 0)
+            savedSerialFlags_ = info.flags;
+        info.flags |= ASYNC_LOW_LATENCY;
+        applied |= ioctl(fd_, TIOCSSERIAL, &info) == 0;
+    }
+
+    std::string path = latencyTimerPath(portName_);
+    if (!path.empty())
+    {
+        int current = readLatencyTimer(path);
+        if (savedLatencyTimer_ < 0)
+            savedLatencyTimer_ = current;
+        applied |= current == 1 || writeLatencyTimer(path, 1);
+    }
+
+    return applied;
+#else
+    return false;
+#endif
+}
+
+bool SerialCommunication::restoreLowLatency()
+{
+#ifdef __linux__
+    bool restored = false;
+
+    if (savedSerialFlags_ >= 0)
+    {
+        struct serial_struct info;
+        if (ioctl(fd_, TIOCGSERIAL, &info) == 0)
+        {
+            info.flags = (info.flags & ~ASYNC_LOW_LATENCY) | (savedSerialFlags_ & ASYNC_LOW_LATENCY);
+            restored |= ioctl(fd_, TIOCSSERIAL, &info) == 0;
+        }
+        savedSerialFlags_ = -1;
+    }
+
+    if (savedLatencyTimer_ >= 0)
+    {
+        std::string path = latencyTimerPath(portName_);
+        if (!path.empty())
+            restored |= writeLatencyTimer(path, savedLatencyTimer_);
+        savedLatencyTimer_ = -1;
+    }
+
+    return restored;
+#else
+    return false;
+#endif
+}
+
+bool SerialCommunication::SetReadMode(const SerialReadMode& mode)
+{
+    readMode_ = mode;
+    if (!isOpen_)
+        return true;
+
+    return applyReadMode();
+}
 
+SerialReadMode SerialCommunication::ReadMode() const
+{
+    return readMode_;
+}
+
+bool SerialCommunication::applyReadMode()
+{
 #ifdef _WIN32
-    if (!PurgeComm(handle_, PURGE_RXCLEAR | PURGE_TXCLEAR))
-        throw std::runtime_error("Flush failed");
+    // Applied through COMMTIMEOUTS on every read.
+    return true;
 #else
-    if (tcflush(fd_, TCIOFLUSH) != 0)
-        throw std::runtime_error("Flush failed");
+    struct termios tty;
+    if (tcgetattr(fd_, &tty) != 0)
+        return false;
+
+    // VMIN is at least 1: fd_ is non-blocking, so this only matters for blocking readers
+    // (io_uring's worker threads), which would otherwise return 0 immediately. With an
+    // inter-byte timeout, poll() reports the first byte and readDevice() runs the timer.
+    tty.c_cc[VMIN]  = std::max<uint8_t>(readMode_.minBytes, 1);
+    tty.c_cc[VTIME] = readMode_.interByteTimeout;
+    return tcsetattr(fd_, TCSANOW, &tty) == 0;
 #endif
 }
 
+uint32_t SerialCommunication::ActualBaudRate() const
+{
+    return actualBaudRate_;
+}
+
+bool SerialCommunication::baudRateAccepted() const
+{
+    uint64_t requested = baudRate_;
+    uint64_t actual    = actualBaudRate_;
+    uint64_t delta     = requested > actual ? requested - actual : actual - requested;
+    return actual != 0 && delta * 100 <= requested * BAUD_TOLERANCE_PERCENT;
+}
+
+SerialBackend SerialCommunication::Backend() const
+{
+    return SerialBackend::Poll;
+}
+
+#ifndef _WIN32
+int SerialCommunication::NativeHandle() const
+{
+    return fd_;
+}
+#endif
+
 bool SerialCommunication::configurePort()
 {
 #ifdef _WIN32
@@ -222,6 +1365,13 @@ bool SerialCommunication::configurePort()
     if (!SetCommState(handle_, &dcb))
         return false;
 
+    if (!GetCommState(handle_, &dcb))
+        return false;
+
+    actualBaudRate_ = dcb.BaudRate;
+    if (!baudRateAccepted())
+        return false;
+
     // Setup timeouts
     COMMTIMEOUTS timeouts = {0};
     timeouts.ReadIntervalTimeout = 50;
@@ -240,17 +1390,16 @@ bool SerialCommunication::configurePort()
     if (tcgetattr(fd_, &tty) != 0)
         return false;
 
+    // Rates without a Bxxx constant are programmed through termios2/BOTHER after tcsetattr.
     speed_t speed;
-    switch (baudRate_)
+    bool    standardRate = standardSpeed(baudRate_, speed);
+    if (!standardRate)
     {
-        case 115200: speed = B115200; break;
-        case 57600: speed = B57600; break;
-        case 38400: speed = B38400; break;
-        case 19200: speed = B19200; break;
-        case 9600: speed = B9600; break;
-        case 4800: speed = B4800; break;
-        case 2400: speed = B2400; break;
-        default: speed = B9600; break;
+#ifdef __linux__
+        speed = B38400;
+#else
+        return false;
+#endif
     }
 
     cfsetospeed(&tty, speed);
@@ -307,12 +1456,21 @@ bool SerialCommunication::configurePort()
     tty.c_iflag &= ~(IXON | IXOFF | IXANY);
     tty.c_oflag &= ~OPOST;
 
-    tty.c_cc[VMIN] = 0;
-    tty.c_cc[VTIME] = 10; // 1 second timeout
+    // VMIN/VTIME are programmed by applyReadMode()
 
     if (tcsetattr(fd_, TCSANOW, &tty) != 0)
         return false;
 
-    return true;
+#ifdef __linux__
+    if (!standardRate && !SetCustomBaudRate(fd_, baudRate_))
+        return false;
+
+    if (!GetActualBaudRate(fd_, actualBaudRate_))
+        actualBaudRate_ = baudRate_;
+#else
+    actualBaudRate_ = baudRate_;
+#endif
+
+    return baudRateAccepted();
 #endif
 }
@@ -4,29 +4,225 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <atomic>
 #include <cstdint>
+#include <chrono>
+#include <mutex>
+
+#include "SerialCapture.hpp"
+#include "SerialStats.hpp"
+#include "SpscRing.hpp"
+
+#ifdef _WIN32
+/**
+ * @brief Gather segment, laid out like the POSIX struct iovec
+ */
+struct iovec
+{
+    void*  iov_base; ///< Start of the segment
+    size_t iov_len;  ///< Length of the segment in bytes
+};
+#else
+#include <sys/uio.h>
+#endif
+
+/**
+ * @brief I/O backend used for Read/Write on Linux
+ */
+enum class SerialBackend
+{
+    Poll,    ///< poll() followed by read()/write() for every call (default)
+    IoUring, ///< io_uring submissions; Create() falls back to Poll when unavailable
+    Loopback ///< In-memory transport selected by "loop://" port names, no hardware involved
+};
+
+/**
+ * @brief Line simulation of the in-memory loopback transport
+ */
+struct LoopbackOptions
+{
+    bool     simulateBaud = true; ///< Pace delivery at the configured baud rate and frame format
+    uint32_t latencyUs    = 0;    ///< Fixed delay added to every write
+    uint32_t jitterUs     = 0;    ///< Random extra delay of 0..jitterUs per write
+};
+
+/**
+ * @brief Driver-side read batching (termios VMIN/VTIME)
+ *
+ * Lets the tty layer collect bytes before waking the reader:
+ * - minBytes = 0: every read returns as soon as any byte is available (default)
+ * - minBytes > 0, interByteTimeout = 0: wait until minBytes bytes are buffered
+ * - minBytes > 0, interByteTimeout > 0: after the first byte, return once minBytes bytes
+ *   arrived or the line stayed idle for interByteTimeout, i.e. one wakeup per burst
+ * The overall timeout of Read/ReadExact/ReadUntil still applies in every mode.
+ */
+struct SerialReadMode
+{
+    uint8_t minBytes         = 0; ///< VMIN: bytes to collect before a read completes
+    uint8_t interByteTimeout = 0; ///< VTIME: inter-byte timer in tenths of a second (0 = none)
+
+    /**
+     * @brief Return as soon as data is available
+     */
+    static SerialReadMode Immediate()
+    {
+        return SerialReadMode();
+    }
+
+    /**
+     * @brief Wait until count bytes are buffered
+     */
+    static SerialReadMode WaitFor(uint8_t count)
+    {
+        SerialReadMode mode;
+        mode.minBytes = count;
+        return mode;
+    }
+
+    /**
+     * @brief Collect up to count bytes, ending the read when the line is idle for deciseconds
+     */
+    static SerialReadMode Burst(uint8_t count, uint8_t deciseconds)
+    {
+        SerialReadMode mode;
+        mode.minBytes         = count;
+        mode.interByteTimeout = deciseconds;
+        return mode;
+    }
+};
+
+/**
+ * @brief Optional settings for SerialCommunication::Create
+ */
+struct SerialOptions
+{
+    SerialBackend backend        = SerialBackend::Poll; ///< Requested I/O backend
+    size_t        rxRingCapacity = 0;                   ///< Run a receive thread with this ring size on Open() (0 = off)
+    bool          lowLatency     = false;               ///< Apply SetLowLatency(true) on Open()
+    size_t        writeHighWater = 64 * 1024;           ///< Queued bytes above which Write() waits and QueueWrite() refuses
+    unsigned int  writeTimeoutMs = 5000;                ///< Longest Write() waits without the port accepting any byte
+    SerialReadMode readMode;                            ///< Driver-side read batching applied on Open()
+    LoopbackOptions loopback;                           ///< Line simulation for "loop://" ports
+    std::shared_ptr<SerialCapture> capture;             ///< Record all traffic of the port here (nullptr = off)
+    uint32_t      capturePortId  = 0;                   ///< Port id written to the capture records
+};
+
+/**
+ * @brief Outcome of the non-throwing Try* calls
+ */
+enum class SerialStatus : uint8_t
+{
+    Ok,             ///< Completed
+    Timeout,        ///< Nothing (or not everything) arrived or left before the timeout
+    NotOpen,        ///< The port is closed
+    IoError,        ///< The device reported an error, see SerialResult::sysError
+    Disconnected,   ///< The device went away (hang-up, EIO/ENXIO/ENODEV)
+    InvalidArgument ///< Too many segments, or no receive thread for TryPeekRx()
+};
+
+/**
+ * @brief Text for a status, e.g. for logs; never nullptr
+ */
+const char* SerialStatusText(SerialStatus status) noexcept;
+
+/**
+ * @brief Compact result of a Try* call: no exception, no allocation
+ *
+ * bytes holds what was transferred, also when the status is not Ok (e.g. the part of a
+ * ReadExact that arrived before the deadline).
+ */
+struct SerialResult
+{
+    size_t       bytes    = 0;
+    SerialStatus status   = SerialStatus::Ok;
+    int          sysError = 0; ///< errno (GetLastError() on Windows) for IoError and Disconnected
+
+    explicit operator bool() const
+    {
+        return status == SerialStatus::Ok;
+    }
+
+    /**
+     * @brief Whether the port failed, as opposed to Ok or a plain timeout
+     */
+    bool Failed() const
+    {
+        return status != SerialStatus::Ok && status != SerialStatus::Timeout;
+    }
+
+    static SerialResult Transferred(size_t bytes)
+    {
+        SerialResult result;
+        result.bytes = bytes;
+        return result;
+    }
+
+    /**
+     * @brief Ok when bytes > 0, Timeout otherwise
+     */
+    static SerialResult Received(size_t bytes)
+    {
+        SerialResult result;
+        result.bytes  = bytes;
+        result.status = bytes > 0 ? SerialStatus::Ok : SerialStatus::Timeout;
+        return result;
+    }
+
+    static SerialResult TimedOut(size_t bytes = 0)
+    {
+        SerialResult result;
+        result.bytes  = bytes;
+        result.status = SerialStatus::Timeout;
+        return result;
+    }
+
+    static SerialResult Failure(SerialStatus status, int sysError = 0)
+    {
+        SerialResult result;
+        result.status   = status;
+        result.sysError = sysError;
+        return result;
+    }
+};
 
 /**
  * @brief Cross-platform serial communication class supporting Windows and Linux
+ *
+ * Every I/O call exists twice: Try* variants are noexcept and return a SerialResult,
+ * the plain ones are a thin layer on top that throws std::runtime_error on failure.
  */
-class SerialCommunication
+class SerialCommunication : public std::enable_shared_from_this<SerialCommunication>
 {
 public:
+    /**
+     * @brief Absolute point in time used by the deadline based reads
+     */
+    using Deadline = std::chrono::steady_clock::time_point;
+
     /**
      * @brief Factory method to create and configure a SerialCommunication instance
-     * @param portName Port name string (e.g., "COM3" or "/dev/ttyUSB0")
+     * @param portName Port name string (e.g., "COM3", "/dev/ttyUSB0", or "loop://<channel>/a"
+     *                 and "loop://<channel>/b" for the two ends of an in-memory loopback)
      * @param baudRate Baud rate (e.g., 9600, 115200)
      * @param dataBits Number of data bits (5,6,7,8)
      * @param stopBits Number of stop bits (1 or 2)
      * @param parity Parity character: 'N' (none), 'E' (even), 'O' (odd)
      * @param enableRts Enable RTS line (true/false)
      * @param enableDtr Enable DTR line (true/false)
+     * @param options Optional settings such as the I/O backend
      * @return shared_ptr to SerialCommunication instance or nullptr on failure
      */
     static std::shared_ptr<SerialCommunication> Create(const std::string& portName, uint32_t baudRate, 
                                                       uint8_t dataBits, uint8_t stopBits, char parity,
-                                                      bool enableRts, bool enableDtr);
+                                                      bool enableRts, bool enableDtr,
+                                                      const SerialOptions& options = SerialOptions());
 
+    /**
+     * @brief Closes the port
+     *
+     * Derived classes that override device hooks must call Close() from their own destructor:
+     * the receive thread calls readDevice() and has to stop before the derived part is destroyed.
+     */
     virtual ~SerialCommunication();
 
     /**
@@ -42,12 +238,99 @@ public:
 
     /**
      * @brief Write data to the serial port
+     *
+     * Whatever the kernel does not take immediately is kept in a per-port write queue.
+     * On Linux, a library thread sends it as soon as the port becomes writable, provided
+     * the port is owned by a shared_ptr (as returned by Create()); otherwise the queue only
+     * moves on later writes, ProcessWritable() or DrainWrites(). The call only waits while the queue is above
+     * the high-water mark, and fails if the port accepts nothing for writeTimeoutMs.
      * @param buffer Pointer to data buffer
      * @param length Number of bytes to write
-     * @throws std::runtime_error on failure
+     * @return Number of bytes accepted (always length on success)
+     * @throws std::runtime_error on failure or write timeout
      */
     virtual size_t Write(const void* buffer, size_t length);
 
+    /**
+     * @brief Write several buffers as one contiguous transmission (gather write)
+     *
+     * On Linux the segments go out through a single writev() call, so headers,
+     * payload and trailers never need to be copied into one packet first.
+     * Queued and throttled like Write().
+     * @param iov Array of segments
+     * @param count Number of segments
+     * @return Total number of bytes accepted
+     * @throws std::runtime_error on failure or write timeout
+     */
+    virtual size_t WriteV(const iovec* iov, size_t count);
+
+    /**
+     * @brief Write() without exceptions
+     * @return Ok with bytes = length; Timeout if the port accepted nothing for writeTimeoutMs
+     *         (the data stays queued); NotOpen, IoError or Disconnected
+     */
+    SerialResult TryWrite(const void* buffer, size_t length) noexcept;
+
+    /**
+     * @brief WriteV() without exceptions, with the results of TryWrite()
+     */
+    SerialResult TryWriteV(const iovec* iov, size_t count) noexcept;
+
+    /**
+     * @brief Non-blocking write: accept data only while the queue is below the high-water mark
+     * @param buffer Pointer to data buffer
+     * @param length Number of bytes to write
+     * @return length if accepted, 0 when the queue is full (backpressure)
+     * @throws std::runtime_error on failure
+     */
+    size_t QueueWrite(const void* buffer, size_t length);
+
+    /**
+     * @brief QueueWrite() of several segments, without exceptions
+     * @return Ok with bytes = total of the segments; Timeout with bytes = 0 when the queue is
+     *         full (backpressure, nothing taken); NotOpen, IoError or Disconnected
+     */
+    SerialResult TryQueueWriteV(const iovec* iov, size_t count) noexcept;
+
+    /**
+     * @brief Bytes accepted by Write/QueueWrite but not yet handed to the kernel
+     */
+    size_t PendingWrite() const;
+
+    /**
+     * @brief Whether the write queue is at or above the high-water mark
+     */
+    bool WriteBlocked() const;
+
+    /**
+     * @brief Change the high-water mark of the write queue
+     */
+    void SetWriteHighWater(size_t bytes);
+
+    /**
+     * @brief Send as much of the write queue as the port accepts, without waiting
+     *
+     * Meant for event loops: call it when the port reports writable (POLLOUT).
+     * @return Bytes still pending
+     * @throws std::runtime_error on failure
+     */
+    size_t ProcessWritable();
+
+    /**
+     * @brief Wait until the write queue has been handed to the kernel
+     * @param timeoutMs Maximum wait in milliseconds
+     * @return true if the queue is empty
+     * @throws std::runtime_error on failure
+     */
+    bool DrainWrites(unsigned int timeoutMs);
+
+    /**
+     * @brief DrainWrites() without exceptions
+     * @return Ok once the queue is empty; Timeout with bytes = still pending;
+     *         NotOpen, IoError or Disconnected
+     */
+    SerialResult TryDrainWrites(unsigned int timeoutMs) noexcept;
+
     /**
      * @brief Read data from the serial port with timeout
      * @param buffer Pointer to buffer to fill
@@ -58,18 +341,233 @@ public:
      */
     virtual size_t Read(void* buffer, size_t length, unsigned int timeoutMs);
 
+    /**
+     * @brief Read() without exceptions
+     * @return Ok with the bytes read, Timeout when nothing arrived, or the failure
+     */
+    SerialResult TryRead(void* buffer, size_t length, unsigned int timeoutMs) noexcept;
+
+    /**
+     * @brief Read exactly length bytes unless the deadline passes first
+     *
+     * Waits only while data is missing and always against the same absolute deadline,
+     * so partial reads do not extend the total wait. Each wakeup reads everything the
+     * driver has buffered up to the missing amount.
+     * @param buffer Pointer to buffer to fill
+     * @param length Number of bytes wanted
+     * @param deadline Point in time after which no more waiting is done
+     * @return Number of bytes read; less than length only when the deadline passed
+     * @throws std::runtime_error on failure
+     */
+    size_t ReadExact(void* buffer, size_t length, Deadline deadline);
+
+    /**
+     * @brief ReadExact() without exceptions
+     * @return Ok once length bytes were read, Timeout with the partial count, or the failure
+     */
+    SerialResult TryReadExact(void* buffer, size_t length, Deadline deadline) noexcept;
+
+    /**
+     * @brief Read up to and including a delimiter byte, or until the deadline passes
+     *
+     * Bytes received after the delimiter are kept for the next Read/ReadExact/ReadUntil
+     * call, so data is read in bulk without being lost. When the receive thread runs,
+     * the ring is scanned in place and only the bytes up to the delimiter are consumed.
+     * @param buffer Pointer to buffer to fill
+     * @param maxLength Capacity of buffer
+     * @param delimiter Byte that ends the read
+     * @param deadline Point in time after which no more waiting is done
+     * @return Number of bytes stored. The last one is the delimiter if it was found;
+     *         otherwise the deadline passed or the buffer filled up first.
+     * @throws std::runtime_error on failure
+     */
+    size_t ReadUntil(void* buffer, size_t maxLength, uint8_t delimiter, Deadline deadline);
+
+    /**
+     * @brief ReadUntil() without exceptions
+     * @return Ok when the delimiter was found or the buffer filled up, Timeout with the
+     *         partial count, or the failure
+     */
+    SerialResult TryReadUntil(void* buffer, size_t maxLength, uint8_t delimiter, Deadline deadline) noexcept;
+
     /**
      * @brief Flush input and output buffers
      * @throws std::runtime_error on failure
      */
     virtual void Flush();
 
+    /**
+     * @brief Flush() without exceptions
+     */
+    SerialResult TryFlush() noexcept;
+
+    /**
+     * @brief Read whatever is already buffered, without waiting
+     * @param buffer Pointer to buffer to fill
+     * @param length Maximum bytes to read
+     * @return Number of bytes read, 0 when nothing is pending
+     * @throws std::runtime_error on failure
+     */
+    virtual size_t ReadAvailable(void* buffer, size_t length);
+
+    /**
+     * @brief ReadAvailable() without exceptions
+     * @return Ok with the bytes read, Timeout when nothing is pending, or the failure
+     */
+    SerialResult TryReadAvailable(void* buffer, size_t length) noexcept;
+
+    /**
+     * @brief Start a dedicated thread that drains the port into a lock-free ring buffer
+     *
+     * While the thread runs, Read() and ReadAvailable() are served from the ring and
+     * PeekRx()/ConsumeRx() give direct access to it. Only one thread may consume.
+     * The thread stops on StopRxThread() or Close().
+     * @param capacity Ring size in bytes (rounded up to a power of two)
+     * @return true if the thread is running
+     */
+    bool StartRxThread(size_t capacity = 64 * 1024);
+
+    /**
+     * @brief Stop the receive thread; bytes still in the ring are discarded
+     */
+    void StopRxThread();
+
+    /**
+     * @brief Check whether the receive thread is running
+     */
+    bool RxThreadActive() const;
+
+    /**
+     * @brief Wait for received bytes and return a view of the contiguous readable region
+     * @param timeoutMs Maximum wait in milliseconds when the ring is empty
+     * @return View into the ring (size 0 on timeout); valid until ConsumeRx()
+     * @throws std::runtime_error if the receive thread is not running or the device failed
+     */
+    ByteSpan PeekRx(unsigned int timeoutMs);
+
+    /**
+     * @brief PeekRx() without exceptions
+     * @param timeoutMs Maximum wait in milliseconds when the ring is empty
+     * @param span Receives the view (size 0 unless the status is Ok)
+     * @return Ok, Timeout, InvalidArgument without receive thread, or the failure of the device
+     */
+    SerialResult TryPeekRx(unsigned int timeoutMs, ByteSpan& span) noexcept;
+
+    /**
+     * @brief Release bytes obtained through PeekRx()
+     * @param count Number of bytes consumed, at most the size of the last view
+     */
+    void ConsumeRx(size_t count);
+
+    /**
+     * @brief Counters and latency histograms of this port
+     *
+     * Every device read, write and readiness wait is counted with relaxed atomics, so the
+     * snapshot may be taken from any thread while the port is in use.
+     */
+    SerialStatsSnapshot Stats() const;
+
+    /**
+     * @brief Zero all counters and histograms
+     */
+    void ResetStats();
+
+    /**
+     * @brief Record every chunk read from or written to the device
+     *
+     * Each device read and write appends one record to the capture, so replaying it
+     * reproduces the chunking and timing the application saw. Several ports may share a
+     * capture, told apart by portId. Not synchronised with I/O in flight: change it
+     * while the port is closed or while no other thread is using it.
+     * @param capture Capture to append to, nullptr to stop capturing
+     * @param portId Id stored in the records of this port
+     */
+    void SetCapture(std::shared_ptr<SerialCapture> capture, uint32_t portId = 0);
+
+    /**
+     * @brief Check whether the port is open
+     */
+    bool IsOpen() const;
+
+    /**
+     * @brief Enable or disable low-latency receive handling (Linux)
+     *
+     * Sets ASYNC_LOW_LATENCY through TIOCSSERIAL and, for USB-serial adapters exposing
+     * /sys/bus/usb-serial/devices/<tty>/latency_timer (e.g. FTDI), lowers the latency
+     * timer to 1 ms. The original values are restored when disabled or on Close().
+     * The setting is remembered and re-applied by Open().
+     * @param enable true to enable
+     * @return true if at least one of the settings could be applied (or restored)
+     */
+    bool SetLowLatency(bool enable);
+
+    /**
+     * @brief Change how the driver batches received bytes before a read completes
+     *
+     * On Linux the mode maps to VMIN/VTIME. With minBytes only, poll() itself waits for
+     * that many bytes; bytes short of it stay in the driver until a later read. With an
+     * inter-byte timeout as well, a read returns once the first byte has arrived and
+     * minBytes are in, or when the line stays silent for the timeout; the timer runs in
+     * the read itself, since the kernel ignores VTIME on the non-blocking descriptor.
+     * On Windows only the inter-byte timeout is mapped (ReadIntervalTimeout).
+     * The mode is remembered and re-applied by Open().
+     * @param mode New read mode
+     * @return true on success (always true while the port is closed)
+     */
+    bool SetReadMode(const SerialReadMode& mode);
+
+    /**
+     * @brief Read mode currently configured
+     */
+    SerialReadMode ReadMode() const;
+
+    /**
+     * @brief Baud rate read back from the driver after configuration
+     *
+     * Any rate is accepted on Linux (standard Bxxx constants up to 4 Mbaud, termios2/BOTHER
+     * otherwise). Open() fails when the driver applies a rate more than 3% away from the
+     * requested one instead of silently running at another speed.
+     * @return Applied rate in bits per second, 0 before the port was configured
+     */
+    uint32_t ActualBaudRate() const;
+
+    /**
+     * @brief Backend actually serving Read/Write for this instance
+     */
+    virtual SerialBackend Backend() const;
+
+#ifndef _WIN32
+    /**
+     * @brief Native file descriptor, for use with poll/epoll based event loops
+     * @return File descriptor, or -1 when the port is closed
+     */
+    int NativeHandle() const;
+#endif
+
 protected:
     SerialCommunication(const std::string& portName, uint32_t baudRate, uint8_t dataBits,
                         uint8_t stopBits, char parity, bool enableRts, bool enableDtr);
 
     // Internal initialization/configuration function
     virtual bool configurePort();
+    virtual bool applyReadMode();
+    bool baudRateAccepted() const;
+    bool applyLowLatency();
+    bool restoreLowLatency();
+
+    // Device hooks behind Open/Close/Flush; openDevice also configures the port.
+    virtual bool openDevice();
+    virtual void closeDevice();
+    virtual bool flushDevice();
+
+    // Platform read/write used by the public API once the port is known to be open.
+    // Reads return Timeout when no byte came. writeDevice returns what the port accepted
+    // right now (Ok with 0 bytes if it would block), readDeviceNow what is buffered without
+    // waiting, waitWritable Ok once the port is writable. None of them may throw.
+    virtual SerialResult readDevice(void* buffer, size_t length, unsigned int timeoutMs) noexcept;
+    virtual SerialResult readDeviceNow(void* buffer, size_t length) noexcept;
+    virtual SerialResult writeDevice(const iovec* iov, size_t count) noexcept;
+    virtual SerialResult waitWritable(unsigned int timeoutMs) noexcept;
 
     // Port parameters
     std::string portName_;
@@ -86,7 +584,52 @@ protected:
     int fd_;       // File descriptor on Linux
 #endif
 
-    bool isOpen_;
+    std::atomic<bool> isOpen_; // Read without locks by the I/O calls of other threads
+
+    size_t rxRingCapacity_; // Receive thread ring size started by Open(), 0 when disabled
+    uint32_t actualBaudRate_; // Rate reported by the driver after configurePort()
+    SerialReadMode readMode_; // VMIN/VTIME configuration
+
+    bool lowLatency_;        // Low-latency mode requested
+    int  savedSerialFlags_;  // serial_struct flags before low latency was applied, -1 if untouched
+    int  savedLatencyTimer_; // latency_timer value before low latency was applied, -1 if untouched
+
+private:
+    struct RxState;
+
+    SerialResult submitWrite(const iovec* iov, size_t count, size_t total);
+    SerialResult flushWriteQueue(); // bytes = still pending
+    SerialResult drainWriteQueue(unsigned int timeoutMs); // flushWriteQueue() until empty or timeout
+    void         armFlush() noexcept;                     // Let the flusher thread send the queue
+    void         disarmFlush() noexcept;
+    void         flushWritable(uint32_t events);          // Flusher handler
+    size_t pendingWriteLocked() const;
+
+    mutable std::mutex   writeMutex_;     // Guards the write queue
+    std::vector<uint8_t> writeQueue_;     // Bytes waiting for the port, starting at writeQueueHead_
+    size_t               writeQueueHead_;
+    size_t               writeHighWater_;
+    bool                 flushArmed_;     // Registered with the flusher thread while data is queued
+    unsigned int         writeTimeoutMs_;
+
+    SerialResult deviceRead(void* buffer, size_t length, unsigned int timeoutMs) noexcept;
+    SerialResult deviceReadNow(void* buffer, size_t length) noexcept;
+    SerialResult deviceWrite(const iovec* iov, size_t count) noexcept;
+    SerialResult deviceWaitWritable(unsigned int timeoutMs) noexcept;
+
+    SerialStats stats_;
+
+    std::shared_ptr<SerialCapture> capture_;       // Traffic capture, nullptr when off
+    uint32_t                       capturePortId_;
+
+    void rxLoop();
+    SerialResult readFromRing(void* buffer, size_t length, unsigned int timeoutMs) noexcept;
+    size_t takeStash(void* buffer, size_t length);
+
+    std::vector<uint8_t> rxStash_;     // Bytes read past a ReadUntil delimiter, starting at rxStashHead_
+    size_t               rxStashHead_;
+
+    std::unique_ptr<RxState> rx_; // Present while the receive thread runs
 };
 
 #endif // SERIAL_HPP
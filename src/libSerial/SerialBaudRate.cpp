@@ -0,0 +1,34 @@
+#include "SerialBaudRate.hpp"
+
+#ifdef __linux__
+
+#include <sys/ioctl.h>
+#include <asm/termbits.h>
+
+bool SetCustomBaudRate(int fd, uint32_t baudRate)
+{
+    struct termios2 tty;
+    if (ioctl(fd, TCGETS2, &tty) != 0)
+        return false;
+
+    tty.c_cflag &= ~CBAUD;
+    tty.c_cflag |= BOTHER;
+    tty.c_cflag &= ~(CBAUD << IBSHIFT);
+    tty.c_cflag |= BOTHER << IBSHIFT;
+    tty.c_ospeed = baudRate;
+    tty.c_ispeed = baudRate;
+
+    return ioctl(fd, TCSETS2, &tty) == 0;
+}
+
+bool GetActualBaudRate(int fd, uint32_t& baudRate)
+{
+    struct termios2 tty;
+    if (ioctl(fd, TCGETS2, &tty) != 0)
+        return false;
+
+    baudRate = tty.c_ospeed;
+    return true;
+}
+
+#endif // __linux__
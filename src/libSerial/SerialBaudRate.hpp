@@ -0,0 +1,31 @@
+#ifndef SERIAL_BAUD_RATE_HPP
+#define SERIAL_BAUD_RATE_HPP
+
+#ifdef __linux__
+
+#include <cstdint>
+
+/*
+ * termios2 helpers. They live in their own translation unit because <asm/termbits.h>
+ * cannot be included together with the glibc <termios.h> used by Serial.cpp.
+ */
+
+/**
+ * @brief Program an arbitrary baud rate through termios2/BOTHER
+ * @param fd Open tty descriptor, already configured with tcsetattr
+ * @param baudRate Requested rate in bits per second
+ * @return true if the driver accepted the request
+ */
+bool SetCustomBaudRate(int fd, uint32_t baudRate);
+
+/**
+ * @brief Read back the output rate the driver actually applied
+ * @param fd Open tty descriptor
+ * @param baudRate Receives the rate in bits per second
+ * @return true on success
+ */
+bool GetActualBaudRate(int fd, uint32_t& baudRate);
+
+#endif // __linux__
+
+#endif // SERIAL_BAUD_RATE_HPP
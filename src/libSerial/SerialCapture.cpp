@@ -0,0 +1,314 @@
+#include "SerialCapture.hpp"
+#include "Serial.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char     CAPTURE_MAGIC[8] = {'B', 'S', 'C', 'C', 'A', 'P', '\r', '\n'};
+static const uint32_t CAPTURE_VERSION  = 1;
+
+// Set in lengthAndDirection for Tx records; the low 31 bits hold the payload length.
+static const uint32_t TX_FLAG    = 0x80000000u;
+static const uint32_t LENGTH_MAX = 0x7FFFFFFFu;
+
+namespace
+{
+struct FileHeader
+{
+    char     magic[8];
+    uint32_t version;
+    uint32_t headerSize;
+    uint64_t steadyOriginNs;
+    uint64_t wallOriginNs;
+    uint8_t  reserved[32];
+};
+
+// lengthAndDirection is stored last, with release semantics: a record whose field is
+// still zero was never completed and ends the capture for readers.
+struct RecordHeader
+{
+    uint64_t timestampNs;
+    uint32_t portId;
+    uint32_t lengthAndDirection;
+};
+} // namespace
+
+static_assert(sizeof(FileHeader) == 64, "capture file header must stay 64 bytes");
+static_assert(sizeof(RecordHeader) == 16, "capture record header must stay 16 bytes");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "record length is published through std::atomic<uint32_t>");
+
+static size_t recordSize(size_t length)
+{
+    return (sizeof(RecordHeader) + length + 7) & ~static_cast<size_t>(7);
+}
+
+static uint64_t nowNs(std::chrono::steady_clock::time_point time)
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+SerialCapture::SerialCapture() : base_(nullptr), capacity_(0), tail_(sizeof(FileHeader)), dropped_(0),
+#ifdef _WIN32
+    file_(INVALID_HANDLE_VALUE), mapping_(nullptr)
+#else
+    fd_(-1)
+#endif
+{
+}
+
+std::shared_ptr<SerialCapture> SerialCapture::Create(const std::string& path, size_t capacity)
+{
+    if (capacity < sizeof(FileHeader) + sizeof(RecordHeader))
+        return nullptr;
+
+    std::shared_ptr<SerialCapture> capture(new SerialCapture());
+    capture->capacity_ = capacity;
+
+#ifdef _WIN32
+    capture->file_ = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                                 FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (capture->file_ == INVALID_HANDLE_VALUE)
+        return nullptr;
+
+    ULARGE_INTEGER size;
+    size.QuadPart     = capacity;
+    capture->mapping_ = CreateFileMappingA(capture->file_, nullptr, PAGE_READWRITE, size.HighPart, size.LowPart, nullptr);
+    if (!capture->mapping_)
+        return nullptr;
+
+    capture->base_ = static_cast<uint8_t*>(MapViewOfFile(capture->mapping_, FILE_MAP_WRITE, 0, 0, capacity));
+    if (!capture->base_)
+        return nullptr;
+#else
+    capture->fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (capture->fd_ < 0 || ::ftruncate(capture->fd_, static_cast<off_t>(capacity)) != 0)
+        return nullptr;
+
+    int flags = MAP_SHARED;
+#ifdef MAP_POPULATE
+    // Fault the pages in now rather than on the I/O path.
+    flags |= MAP_POPULATE;
+#endif
+    void* base = ::mmap(nullptr, capacity, PROT_READ | PROT_WRITE, flags, capture->fd_, 0);
+    if (base == MAP_FAILED)
+        return nullptr;
+    capture->base_ = static_cast<uint8_t*>(base);
+#endif
+
+    FileHeader header{};
+    std::memcpy(header.magic, CAPTURE_MAGIC, sizeof(header.magic));
+    header.version        = CAPTURE_VERSION;
+    header.headerSize     = sizeof(FileHeader);
+    header.steadyOriginNs = nowNs(std::chrono::steady_clock::now());
+    header.wallOriginNs   = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+    std::memcpy(capture->base_, &header, sizeof(header));
+
+    return capture;
+}
+
+SerialCapture::~SerialCapture()
+{
+    size_t used = Size();
+
+#ifdef _WIN32
+    if (base_)
+        UnmapViewOfFile(base_);
+    if (mapping_)
+        CloseHandle(mapping_);
+    if (file_ != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER end;
+        end.QuadPart = static_cast<LONGLONG>(used);
+        if (base_ && SetFilePointerEx(file_, end, nullptr, FILE_BEGIN))
+            SetEndOfFile(file_);
+        CloseHandle(file_);
+    }
+#else
+    if (base_)
+        ::munmap(base_, capacity_);
+    if (fd_ >= 0)
+    {
+        if (base_ && ::ftruncate(fd_, static_cast<off_t>(used)) != 0)
+        {
+            // The unused tail is zero and ends the capture for readers anyway.
+        }
+        ::close(fd_);
+    }
+#endif
+}
+
+uint8_t* SerialCapture::reserve(uint32_t portId, size_t length, uint32_t*& lengthField)
+{
+    if (length == 0)
+        return nullptr;
+
+    size_t size   = recordSize(length);
+    size_t offset = tail_.load(std::memory_order_relaxed);
+
+    // Only advance the tail when the record fits, so a full capture stops growing it.
+    do
+    {
+        if (length > LENGTH_MAX || offset + size > capacity_)
+        {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    } while (!tail_.compare_exchange_weak(offset, offset + size, std::memory_order_relaxed));
+
+    RecordHeader* header = reinterpret_cast<RecordHeader*>(base_ + offset);
+    header->timestampNs  = nowNs(std::chrono::steady_clock::now());
+    header->portId       = portId;
+
+    lengthField = &header->lengthAndDirection;
+    return base_ + offset + sizeof(RecordHeader);
+}
+
+static void publish(uint32_t* lengthField, CaptureDirection direction, size_t length)
+{
+    uint32_t value = static_cast<uint32_t>(length) | (direction == CaptureDirection::Tx ? TX_FLAG : 0);
+    reinterpret_cast<std::atomic<uint32_t>*>(lengthField)->store(value, std::memory_order_release);
+}
+
+void SerialCapture::Record(uint32_t portId, CaptureDirection direction, const void* data, size_t length)
+{
+    uint32_t* lengthField;
+    uint8_t*  payload = reserve(portId, length, lengthField);
+    if (!payload)
+        return;
+
+    std::memcpy(payload, data, length);
+    publish(lengthField, direction, length);
+}
+
+void SerialCapture::Record(uint32_t portId, CaptureDirection direction, const iovec* iov, size_t count, size_t length)
+{
+    uint32_t* lengthField;
+    uint8_t*  payload = reserve(portId, length, lengthField);
+    if (!payload)
+        return;
+
+    size_t copied = 0;
+    for (size_t i = 0; i < count && copied < length; ++i)
+    {
+        size_t n = std::min(iov[i].iov_len, length - copied);
+        std::memcpy(payload + copied, iov[i].iov_base, n);
+        copied += n;
+    }
+    publish(lengthField, direction, length);
+}
+
+size_t SerialCapture::Size() const
+{
+    return std::min(tail_.load(std::memory_order_relaxed), capacity_);
+}
+
+uint64_t SerialCapture::Dropped() const
+{
+    return dropped_.load(std::memory_order_relaxed);
+}
+
+bool SerialCaptureReader::Open(const std::string& path)
+{
+    data_.clear();
+    offset_ = 0;
+
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        return false;
+
+    data_.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    FileHeader header;
+    if (data_.size() < sizeof(header))
+        return false;
+    std::memcpy(&header, data_.data(), sizeof(header));
+    if (std::memcmp(header.magic, CAPTURE_MAGIC, sizeof(header.magic)) != 0 || header.version != CAPTURE_VERSION ||
+        header.headerSize < sizeof(FileHeader) || header.headerSize > data_.size())
+    {
+        data_.clear();
+        return false;
+    }
+
+    offset_ = header.headerSize;
+    return true;
+}
+
+bool SerialCaptureReader::Next(CaptureRecord& record)
+{
+    if (offset_ + sizeof(RecordHeader) > data_.size())
+        return false;
+
+    RecordHeader header;
+    std::memcpy(&header, data_.data() + offset_, sizeof(header));
+
+    uint32_t length = header.lengthAndDirection & LENGTH_MAX;
+    if (length == 0 || offset_ + sizeof(RecordHeader) + length > data_.size())
+        return false;
+
+    record.timestampNs = header.timestampNs;
+    record.portId      = header.portId;
+    record.direction   = (header.lengthAndDirection & TX_FLAG) ? CaptureDirection::Tx : CaptureDirection::Rx;
+    record.data        = data_.data() + offset_ + sizeof(RecordHeader);
+    record.length      = length;
+
+    offset_ += recordSize(length);
+    return true;
+}
+
+void SerialCaptureReader::Rewind()
+{
+    offset_ = data_.size() >= sizeof(FileHeader) ? reinterpret_cast<const FileHeader*>(data_.data())->headerSize : 0;
+}
+
+uint64_t SerialCaptureReader::WallClockOriginNs() const
+{
+    return data_.size() >= sizeof(FileHeader) ? reinterpret_cast<const FileHeader*>(data_.data())->wallOriginNs : 0;
+}
+
+uint64_t SerialCaptureReader::SteadyOriginNs() const
+{
+    return data_.size() >= sizeof(FileHeader) ? reinterpret_cast<const FileHeader*>(data_.data())->steadyOriginNs : 0;
+}
+
+size_t ReplayCapture(SerialCaptureReader& reader, SerialCommunication& target, const CaptureReplayOptions& options)
+{
+    auto          start   = std::chrono::steady_clock::now();
+    bool          first   = true;
+    uint64_t      firstNs = 0;
+    size_t        written = 0;
+    CaptureRecord record;
+
+    while (reader.Next(record))
+    {
+        if (record.direction != options.direction)
+            continue;
+        if (options.portId != CAPTURE_ANY_PORT && record.portId != options.portId)
+            continue;
+
+        if (options.speed > 0)
+        {
+            if (first)
+            {
+                firstNs = record.timestampNs;
+                first   = false;
+            }
+            auto offset = std::chrono::nanoseconds(static_cast<int64_t>((record.timestampNs - firstNs) / options.speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        written += target.Write(record.data, record.length);
+    }
+
+    return written;
+}
@@ -0,0 +1,169 @@
+#ifndef SERIAL_CAPTURE_HPP
+#define SERIAL_CAPTURE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct iovec;
+class SerialCommunication;
+
+/**
+ * @brief Direction of a captured chunk
+ */
+enum class CaptureDirection : uint8_t
+{
+    Rx = 0, ///< Received from the device
+    Tx = 1  ///< Handed to the device
+};
+
+/**
+ * @brief Port id matching every port when replaying
+ */
+static const uint32_t CAPTURE_ANY_PORT = 0xFFFFFFFFu;
+
+/**
+ * @brief Append-only, memory-mapped log of serial traffic
+ *
+ * The file starts with a 64 byte header followed by records, each made of a 16 byte
+ * header (steady_clock timestamp in ns, port id, direction and length) and the payload,
+ * padded to 8 bytes. The whole file is sized and mapped up front, so recording a chunk
+ * is an atomic reservation, a copy and a release store; no system call, no lock. Several
+ * ports may share one capture and write concurrently. Chunks that no longer fit are
+ * dropped and counted. The file is cut to the recorded size on destruction; after a
+ * crash, readers stop at the first record that was never completed.
+ */
+class SerialCapture
+{
+public:
+    static const size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+
+    /**
+     * @brief Create (or truncate) a capture file and map it
+     * @param path File to write
+     * @param capacity Largest size the file may reach, header included
+     * @return Capture, or nullptr when the file cannot be created or mapped
+     */
+    static std::shared_ptr<SerialCapture> Create(const std::string& path, size_t capacity = DEFAULT_CAPACITY);
+
+    ~SerialCapture();
+
+    SerialCapture(const SerialCapture&)            = delete;
+    SerialCapture& operator=(const SerialCapture&) = delete;
+
+    /**
+     * @brief Append one chunk
+     */
+    void Record(uint32_t portId, CaptureDirection direction, const void* data, size_t length);
+
+    /**
+     * @brief Append the first length bytes of a gather list as one chunk
+     */
+    void Record(uint32_t portId, CaptureDirection direction, const iovec* iov, size_t count, size_t length);
+
+    /**
+     * @brief Bytes of the file used so far, header included
+     */
+    size_t Size() const;
+
+    /**
+     * @brief Chunks dropped because the file was full
+     */
+    uint64_t Dropped() const;
+
+private:
+    SerialCapture();
+
+    uint8_t* reserve(uint32_t portId, size_t length, uint32_t*& lengthField);
+
+    uint8_t*              base_;
+    size_t                capacity_;
+    std::atomic<size_t>   tail_;
+    std::atomic<uint64_t> dropped_;
+
+#ifdef _WIN32
+    void* file_;
+    void* mapping_;
+#else
+    int fd_;
+#endif
+};
+
+/**
+ * @brief One chunk read back from a capture
+ */
+struct CaptureRecord
+{
+    uint64_t         timestampNs; ///< steady_clock time of the capture, in ns
+    uint32_t         portId;      ///< Id given to the port when capturing
+    CaptureDirection direction;   ///< Rx or Tx
+    const uint8_t*   data;        ///< Payload, valid while the reader lives
+    uint32_t         length;      ///< Payload length in bytes
+};
+
+/**
+ * @brief Sequential reader of a capture file
+ */
+class SerialCaptureReader
+{
+public:
+    /**
+     * @brief Load a capture file
+     * @return false when the file cannot be read or is not a capture
+     */
+    bool Open(const std::string& path);
+
+    /**
+     * @brief Fetch the next record
+     * @return false at the end of the capture
+     */
+    bool Next(CaptureRecord& record);
+
+    /**
+     * @brief Start again from the first record
+     */
+    void Rewind();
+
+    /**
+     * @brief system_clock time in ns at which the capture was created, for wall-clock display
+     */
+    uint64_t WallClockOriginNs() const;
+
+    /**
+     * @brief steady_clock time in ns at which the capture was created
+     */
+    uint64_t SteadyOriginNs() const;
+
+private:
+    std::vector<uint8_t> data_;
+    size_t               offset_ = 0;
+};
+
+/**
+ * @brief Settings of ReplayCapture
+ */
+struct CaptureReplayOptions
+{
+    uint32_t         portId    = CAPTURE_ANY_PORT;     ///< Replay only this port
+    CaptureDirection direction = CaptureDirection::Rx; ///< Replay only this direction
+    double           speed     = 1.0;                  ///< Time scale: 1 original, 10 ten times faster, 0 no pacing
+};
+
+/**
+ * @brief Write the selected chunks of a capture to a port, keeping their original spacing
+ *
+ * Pointed at one end of a loopback ("loop://<channel>/b"), the other end then receives
+ * the captured traffic as the device sent it, e.g. to feed OpenBSC::ReadResponse. Starts
+ * at the reader's current record.
+ * @param reader Capture to play
+ * @param target Open port receiving the chunks
+ * @param options Selection and speed
+ * @return Bytes written
+ */
+size_t ReplayCapture(SerialCaptureReader& reader, SerialCommunication& target, const CaptureReplayOptions& options = CaptureReplayOptions());
+
+#endif // SERIAL_CAPTURE_HPP
@@ -0,0 +1,565 @@
+#include "SerialChecksum.hpp"
+
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define CHECKSUM_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define CHECKSUM_TARGET(isa)
+#else
+// Kernels are compiled for their instruction set only; the rest of the library stays generic.
+#define CHECKSUM_TARGET(isa) __attribute__((target(isa)))
+#endif
+#elif defined(__aarch64__)
+#define CHECKSUM_NEON 1
+#include <arm_neon.h>
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+#endif
+
+// Bytes below which a CRC is not worth the folding setup; the folding loop needs 64 bytes.
+static const size_t CLMUL_MIN_LENGTH = 64;
+
+// Bytes below which BCC and LRC stay on the word-wide scalar code, typical command frames.
+static const size_t VECTOR_MIN_LENGTH = 32;
+
+// ---------------------------------------------------------------------------------------
+// CPU support and level selection
+
+static ChecksumLevel detectLevel()
+{
+#if defined(CHECKSUM_X86)
+    bool sse2 = false, pclmul = false, ssse3 = false, avx2 = false;
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    sse2        = (info[3] & (1 << 26)) != 0;
+    pclmul      = (info[2] & (1 << 1)) != 0;
+    ssse3       = (info[2] & (1 << 9)) != 0;
+    bool osAvx  = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    if (maxLeaf >= 7 && osAvx)
+    {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    sse2   = __builtin_cpu_supports("sse2");
+    pclmul = __builtin_cpu_supports("pclmul");
+    ssse3  = __builtin_cpu_supports("ssse3");
+    avx2   = __builtin_cpu_supports("avx2");
+#endif
+    if (!sse2 || !pclmul || !ssse3)
+        return ChecksumLevel::Scalar;
+    return avx2 ? ChecksumLevel::Simd256 : ChecksumLevel::Simd128;
+#elif defined(CHECKSUM_NEON)
+    return ChecksumLevel::Simd128; // NEON is part of the aarch64 baseline
+#else
+    return ChecksumLevel::Scalar;
+#endif
+}
+
+static ChecksumLevel supportedLevel()
+{
+    static const ChecksumLevel level = detectLevel();
+    return level;
+}
+
+static std::atomic<ChecksumLevel>& activeLevel()
+{
+    static std::atomic<ChecksumLevel> level(supportedLevel());
+    return level;
+}
+
+ChecksumLevel ChecksumSupportedLevel()
+{
+    return supportedLevel();
+}
+
+ChecksumLevel ChecksumActiveLevel()
+{
+    return activeLevel().load(std::memory_order_relaxed);
+}
+
+void ChecksumSetLevel(ChecksumLevel level)
+{
+    activeLevel().store(level < supportedLevel() ? level : supportedLevel(), std::memory_order_relaxed);
+}
+
+const char* ChecksumLevelName(ChecksumLevel level)
+{
+    switch (level)
+    {
+        case ChecksumLevel::Scalar:
+            return "scalar";
+#if defined(CHECKSUM_NEON)
+        case ChecksumLevel::Simd128:
+            return "neon";
+#else
+        case ChecksumLevel::Simd128:
+            return "sse2+pclmul";
+#endif
+        case ChecksumLevel::Simd256:
+            return "avx2+pclmul";
+    }
+    return "unknown";
+}
+
+// ---------------------------------------------------------------------------------------
+// BCC and LRC
+
+// A plain byte loop: for the short inputs this sees it beats folding 64-bit words, and
+// the compiler vectorises it where the target allows.
+static uint8_t bccScalar(const uint8_t* p, size_t n, uint8_t bcc)
+{
+    for (size_t i = 0; i < n; ++i)
+        bcc ^= p[i];
+    return bcc;
+}
+
+static uint32_t sumScalar(const uint8_t* p, size_t n)
+{
+    uint32_t sum = 0;
+    for (; n >= 8; p += 8, n -= 8)
+        sum += uint32_t(p[0]) + p[1] + p[2] + p[3] + p[4] + p[5] + p[6] + p[7];
+    while (n--)
+        sum += *p++;
+    return sum;
+}
+
+#if defined(CHECKSUM_X86)
+
+CHECKSUM_TARGET("sse2")
+static uint8_t bccSse2(const uint8_t* p, size_t n, uint8_t bcc)
+{
+    __m128i a = _mm_setzero_si128(), b = _mm_setzero_si128();
+    for (; n >= 32; p += 32, n -= 32)
+    {
+        a = _mm_xor_si128(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        b = _mm_xor_si128(b, _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)));
+    }
+
+    alignas(16) uint8_t lanes[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), _mm_xor_si128(a, b));
+    return bccScalar(p, n, bccScalar(lanes, sizeof(lanes), bcc));
+}
+
+CHECKSUM_TARGET("avx2")
+static uint8_t bccAvx2(const uint8_t* p, size_t n, uint8_t bcc)
+{
+    __m256i a = _mm256_setzero_si256(), b = _mm256_setzero_si256();
+    for (; n >= 64; p += 64, n -= 64)
+    {
+        a = _mm256_xor_si256(a, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)));
+        b = _mm256_xor_si256(b, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)));
+    }
+
+    alignas(32) uint8_t lanes[32];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_xor_si256(a, b));
+    return bccScalar(p, n, bccScalar(lanes, sizeof(lanes), bcc));
+}
+
+CHECKSUM_TARGET("sse2")
+static uint32_t sumSse2(const uint8_t* p, size_t n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i       acc  = zero;
+    for (; n >= 32; p += 32, n -= 32)
+    {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), zero));
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16)), zero));
+    }
+
+    alignas(16) uint64_t lanes[2];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    return static_cast<uint32_t>(lanes[0] + lanes[1]) + sumScalar(p, n);
+}
+
+CHECKSUM_TARGET("avx2")
+static uint32_t sumAvx2(const uint8_t* p, size_t n)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i       acc  = zero;
+    for (; n >= 64; p += 64, n -= 64)
+    {
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), zero));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), zero));
+    }
+
+    alignas(32) uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+    return static_cast<uint32_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + sumScalar(p, n);
+}
+
+#elif defined(CHECKSUM_NEON)
+
+static uint8_t bccNeon(const uint8_t* p, size_t n, uint8_t bcc)
+{
+    uint8x16_t a = vdupq_n_u8(0), b = vdupq_n_u8(0);
+    for (; n >= 32; p += 32, n -= 32)
+    {
+        a = veorq_u8(a, vld1q_u8(p));
+        b = veorq_u8(b, vld1q_u8(p + 16));
+    }
+
+    uint8_t lanes[16];
+    vst1q_u8(lanes, veorq_u8(a, b));
+    return bccScalar(p, n, bccScalar(lanes, sizeof(lanes), bcc));
+}
+
+static uint32_t sumNeon(const uint8_t* p, size_t n)
+{
+    uint32_t sum = 0;
+    for (; n >= 32; p += 32, n -= 32)
+        sum += uint32_t(vaddlvq_u8(vld1q_u8(p))) + vaddlvq_u8(vld1q_u8(p + 16));
+    return sum + sumScalar(p, n);
+}
+
+#endif
+
+uint8_t ChecksumBcc(const void* data, size_t length, uint8_t bcc)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    if (length < VECTOR_MIN_LENGTH)
+        return bccScalar(p, length, bcc);
+#if defined(CHECKSUM_X86)
+    switch (ChecksumActiveLevel())
+    {
+        case ChecksumLevel::Simd256:
+            return bccAvx2(p, length, bcc);
+        case ChecksumLevel::Simd128:
+            return bccSse2(p, length, bcc);
+        case ChecksumLevel::Scalar:
+            break;
+    }
+#elif defined(CHECKSUM_NEON)
+    if (ChecksumActiveLevel() != ChecksumLevel::Scalar)
+        return bccNeon(p, length, bcc);
+#endif
+    return bccScalar(p, length, bcc);
+}
+
+uint8_t ChecksumLrc(const void* data, size_t length)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    uint32_t       sum;
+    if (length < VECTOR_MIN_LENGTH)
+        return static_cast<uint8_t>(0u - sumScalar(p, length));
+#if defined(CHECKSUM_X86)
+    switch (ChecksumActiveLevel())
+    {
+        case ChecksumLevel::Simd256:
+            sum = sumAvx2(p, length);
+            break;
+        case ChecksumLevel::Simd128:
+            sum = sumSse2(p, length);
+            break;
+        default:
+            sum = sumScalar(p, length);
+            break;
+    }
+#elif defined(CHECKSUM_NEON)
+    sum = ChecksumActiveLevel() != ChecksumLevel::Scalar ? sumNeon(p, length) : sumScalar(p, length);
+#else
+    sum = sumScalar(p, length);
+#endif
+    return static_cast<uint8_t>(0u - sum);
+}
+
+// ---------------------------------------------------------------------------------------
+// CRCs
+//
+// Reflected CRCs of any width up to 32 run as a 32-bit reflected CRC with the polynomial
+// G = P * x^(32 - width): its register holds the narrow register in the low bits. A CRC
+// that is not reflected equals the reflected one over bit-reversed bytes, with reversed
+// initial and final registers; both the folding kernel and the table-driven code reverse the
+// bytes as they load them.
+
+// Every byte of value in reverse bit order.
+static uint32_t reflectBytes(uint32_t value)
+{
+    value = ((value >> 1) & 0x55555555) | ((value & 0x55555555) << 1);
+    value = ((value >> 2) & 0x33333333) | ((value & 0x33333333) << 2);
+    return ((value >> 4) & 0x0F0F0F0F) | ((value & 0x0F0F0F0F) << 4);
+}
+
+// The low bits of value in reverse order.
+static uint32_t reflect(uint32_t value, unsigned int bits)
+{
+    value = reflectBytes(value);
+    value = ((value >> 8) & 0x00FF00FF) | ((value & 0x00FF00FF) << 8);
+    value = (value >> 16) | (value << 16);
+    return value >> (32 - bits);
+}
+
+struct CrcModel
+{
+    unsigned int width;
+    uint32_t     poly; // Normal form, without the x^width term
+    bool         reflected;
+    uint32_t     init;
+
+    uint32_t table[8][256]; // Slicing-by-8 over the reflected 32-bit register
+
+    // PCLMULQDQ folding constants of G, bit-reflected as in Intel's "Fast CRC Computation
+    // for Generic Polynomials Using PCLMULQDQ Instruction": x^n mod G for the fold distances,
+    // then G and floor(x^64 / G) for the Barrett reduction.
+    alignas(16) uint64_t k1k2[2];
+    alignas(16) uint64_t k3k4[2];
+    alignas(16) uint64_t k5k0[2];
+    alignas(16) uint64_t barrett[2];
+
+    CrcModel(unsigned int width, uint32_t poly, bool reflected, uint32_t init) : width(width), poly(poly), reflected(reflected), init(init)
+    {
+        uint32_t reversed = reflect(poly << (32 - width), 32);
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ ((crc & 1) ? reversed : 0);
+            table[0][i] = crc;
+        }
+        for (uint32_t i = 0; i < 256; ++i)
+            for (int k = 1; k < 8; ++k)
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+
+        uint64_t g = ((uint64_t(1) << width) | poly) << (32 - width);
+        k1k2[0]    = uint64_t(reflect(xPowerMod(4 * 128 + 32, g), 32)) << 1;
+        k1k2[1]    = uint64_t(reflect(xPowerMod(4 * 128 - 32, g), 32)) << 1;
+        k3k4[0]    = uint64_t(reflect(xPowerMod(128 + 32, g), 32)) << 1;
+        k3k4[1]    = uint64_t(reflect(xPowerMod(128 - 32, g), 32)) << 1;
+        k5k0[0]    = uint64_t(reflect(xPowerMod(64, g), 32)) << 1;
+        k5k0[1]    = 0;
+        barrett[0] = reflect33(g);
+        barrett[1] = reflect33(x64DivBy(g));
+    }
+
+    // x^n mod g for a 33-bit g.
+    static uint32_t xPowerMod(unsigned int n, uint64_t g)
+    {
+        uint64_t r = 1;
+        while (n--)
+        {
+            r <<= 1;
+            if (r & (uint64_t(1) << 32))
+                r ^= g;
+        }
+        return static_cast<uint32_t>(r);
+    }
+
+    // floor(x^64 / g) for a 33-bit g, by long division.
+    static uint64_t x64DivBy(uint64_t g)
+    {
+        uint64_t quotient = 0, window = uint64_t(1) << 32;
+        for (int bit = 32; bit >= 0; --bit)
+        {
+            if (window & (uint64_t(1) << 32))
+            {
+                quotient |= uint64_t(1) << bit;
+                window ^= g;
+            }
+            window <<= 1;
+        }
+        return quotient;
+    }
+
+    static uint64_t reflect33(uint64_t value)
+    {
+        return uint64_t(reflect(static_cast<uint32_t>(value >> 1), 32)) | ((value & 1) << 32);
+    }
+};
+
+struct CrcModels
+{
+    CrcModel crc32{32, 0x04C11DB7, true, 0xFFFFFFFF};
+    CrcModel arc{16, 0x8005, true, 0x0000};
+    CrcModel modbus{16, 0x8005, true, 0xFFFF};
+    CrcModel kermit{16, 0x1021, true, 0x0000};
+    CrcModel xmodem{16, 0x1021, false, 0x0000};
+    CrcModel ccittFalse{16, 0x1021, false, 0xFFFF};
+};
+
+static const CrcModels& models()
+{
+    static const CrcModels instance;
+    return instance;
+}
+
+static const CrcModel& modelOf(Crc16 kind)
+{
+    switch (kind)
+    {
+        case Crc16::Arc:
+            return models().arc;
+        case Crc16::Modbus:
+            return models().modbus;
+        case Crc16::Kermit:
+            return models().kermit;
+        case Crc16::Xmodem:
+            return models().xmodem;
+        case Crc16::CcittFalse:
+            break;
+    }
+    return models().ccittFalse;
+}
+
+static uint32_t load32(const uint8_t* p)
+{
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// Reflected 32-bit register over n bytes, bit-reversed first for a model that is not reflected.
+template <bool ReverseBits>
+static uint32_t crcScalar(const CrcModel& model, uint32_t crc, const uint8_t* p, size_t n)
+{
+    const uint32_t (*t)[256] = model.table;
+    for (; n >= 8; p += 8, n -= 8)
+    {
+        uint32_t lo = load32(p), hi = load32(p + 4);
+        if (ReverseBits)
+        {
+            lo = reflectBytes(lo);
+            hi = reflectBytes(hi);
+        }
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^ t[3][hi & 0xFF] ^
+              t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    while (n--)
+        crc = (crc >> 8) ^ t[0][(crc ^ (ReverseBits ? reflectBytes(*p++) : *p++)) & 0xFF];
+    return crc;
+}
+
+#if defined(CHECKSUM_X86)
+
+template <bool ReverseBits>
+CHECKSUM_TARGET("sse2,ssse3,pclmul")
+static inline __m128i loadBlock(const uint8_t* p)
+{
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    if (ReverseBits)
+    {
+        // Reverse the bits of every byte with two nibble lookups.
+        const __m128i nibble  = _mm_set1_epi8(0x0F);
+        const __m128i lowRev  = _mm_setr_epi8(0x00, char(0x80), 0x40, char(0xC0), 0x20, char(0xA0), 0x60, char(0xE0), 0x10, char(0x90), 0x50,
+                                              char(0xD0), 0x30, char(0xB0), 0x70, char(0xF0));
+        const __m128i highRev = _mm_setr_epi8(0x00, 0x08, 0x04, 0x0C, 0x02, 0x0A, 0x06, 0x0E, 0x01, 0x09, 0x05, 0x0D, 0x03, 0x0B, 0x07, 0x0F);
+        block                 = _mm_or_si128(_mm_shuffle_epi8(lowRev, _mm_and_si128(block, nibble)),
+                                             _mm_shuffle_epi8(highRev, _mm_and_si128(_mm_srli_epi16(block, 4), nibble)));
+    }
+    return block;
+}
+
+CHECKSUM_TARGET("sse2,ssse3,pclmul")
+static inline __m128i fold(__m128i x, __m128i k, __m128i next)
+{
+    return _mm_xor_si128(_mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11), _mm_clmulepi64_si128(x, k, 0x00)), next);
+}
+
+// Reflected 32-bit register over n bytes; n >= 64 and a multiple of 16.
+template <bool ReverseBits>
+CHECKSUM_TARGET("sse2,ssse3,pclmul")
+static uint32_t crcClmul(const CrcModel& model, uint32_t crc, const uint8_t* p, size_t n)
+{
+    __m128i x1 = _mm_xor_si128(loadBlock<ReverseBits>(p), _mm_cvtsi32_si128(static_cast<int>(crc)));
+    __m128i x2 = loadBlock<ReverseBits>(p + 16);
+    __m128i x3 = loadBlock<ReverseBits>(p + 32);
+    __m128i x4 = loadBlock<ReverseBits>(p + 48);
+    p += 64;
+    n -= 64;
+
+    // Four independent streams, folded 512 bits ahead.
+    __m128i k = _mm_load_si128(reinterpret_cast<const __m128i*>(model.k1k2));
+    for (; n >= 64; p += 64, n -= 64)
+    {
+        x1 = fold(x1, k, loadBlock<ReverseBits>(p));
+        x2 = fold(x2, k, loadBlock<ReverseBits>(p + 16));
+        x3 = fold(x3, k, loadBlock<ReverseBits>(p + 32));
+        x4 = fold(x4, k, loadBlock<ReverseBits>(p + 48));
+    }
+
+    // Merge them, then take the remaining 16-byte blocks one by one.
+    k  = _mm_load_si128(reinterpret_cast<const __m128i*>(model.k3k4));
+    x1 = fold(x1, k, x2);
+    x1 = fold(x1, k, x3);
+    x1 = fold(x1, k, x4);
+    for (; n >= 16; p += 16, n -= 16)
+        x1 = fold(x1, k, loadBlock<ReverseBits>(p));
+
+    // 128 to 64 bits.
+    const __m128i low32 = _mm_setr_epi32(~0, 0, ~0, 0);
+    x2                  = _mm_clmulepi64_si128(x1, k, 0x10);
+    x1                  = _mm_xor_si128(_mm_srli_si128(x1, 8), x2);
+
+    k  = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(model.k5k0));
+    x2 = _mm_srli_si128(x1, 4);
+    x1 = _mm_xor_si128(_mm_clmulepi64_si128(_mm_and_si128(x1, low32), k, 0x00), x2);
+
+    // Barrett reduction to 32 bits.
+    k  = _mm_load_si128(reinterpret_cast<const __m128i*>(model.barrett));
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x1, low32), k, 0x10);
+    x2 = _mm_clmulepi64_si128(_mm_and_si128(x2, low32), k, 0x00);
+    x1 = _mm_xor_si128(x1, x2);
+
+    return static_cast<uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(x1, 4)));
+}
+
+#endif
+
+// Reflected 32-bit register of model over the data.
+static uint32_t crcReflected(const CrcModel& model, uint32_t crc, const uint8_t* p, size_t n)
+{
+#if defined(CHECKSUM_X86)
+    if (n >= CLMUL_MIN_LENGTH && ChecksumActiveLevel() != ChecksumLevel::Scalar)
+    {
+        size_t bulk = n & ~size_t(15);
+        crc         = model.reflected ? crcClmul<false>(model, crc, p, bulk) : crcClmul<true>(model, crc, p, bulk);
+        p += bulk;
+        n -= bulk;
+    }
+#elif defined(CHECKSUM_NEON) && defined(__ARM_FEATURE_CRC32)
+    if (&model == &models().crc32 && ChecksumActiveLevel() != ChecksumLevel::Scalar)
+    {
+        for (; n >= 8; p += 8, n -= 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, p, sizeof(word));
+            crc = __crc32d(crc, word);
+        }
+        while (n--)
+            crc = __crc32b(crc, *p++);
+        return crc;
+    }
+#endif
+    return model.reflected ? crcScalar<false>(model, crc, p, n) : crcScalar<true>(model, crc, p, n);
+}
+
+// Register of model over the data; crc and the result use the model's own bit order.
+static uint32_t crcUpdate(const CrcModel& model, uint32_t crc, const uint8_t* p, size_t n)
+{
+    if (model.reflected)
+        return crcReflected(model, crc, p, n);
+    return reflect(crcReflected(model, reflect(crc, model.width), p, n), model.width);
+}
+
+uint16_t ChecksumCrc16(Crc16 kind, const void* data, size_t length)
+{
+    const CrcModel& model = modelOf(kind);
+    return static_cast<uint16_t>(crcUpdate(model, model.init, static_cast<const uint8_t*>(data), length));
+}
+
+uint16_t ChecksumCrc16(Crc16 kind, uint16_t crc, const void* data, size_t length)
+{
+    return static_cast<uint16_t>(crcUpdate(modelOf(kind), crc, static_cast<const uint8_t*>(data), length));
+}
+
+uint32_t ChecksumCrc32(const void* data, size_t length, uint32_t crc)
+{
+    return ~crcUpdate(models().crc32, ~crc, static_cast<const uint8_t*>(data), length);
+}
@@ -0,0 +1,81 @@
+#ifndef SERIAL_CHECKSUM_HPP
+#define SERIAL_CHECKSUM_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief CRC-16 parameter sets, named as in the CRC catalogue
+ *
+ * All of them have a final XOR of 0, so a CRC can be continued over further data by passing
+ * the previous result as crc.
+ */
+enum class Crc16 : uint8_t
+{
+    Arc,        ///< Poly 0x8005, reflected, init 0x0000 (CRC-16/ARC, "CRC-16")
+    Modbus,     ///< Poly 0x8005, reflected, init 0xFFFF (Modbus RTU)
+    Kermit,     ///< Poly 0x1021, reflected, init 0x0000 (CRC-16/CCITT)
+    Xmodem,     ///< Poly 0x1021, init 0x0000 (XMODEM, ZMODEM)
+    CcittFalse  ///< Poly 0x1021, init 0xFFFF (CRC-16/IBM-3740)
+};
+
+/**
+ * @brief Instruction set level of the checksum kernels
+ *
+ * The best level the CPU supports is selected on first use. Lowering it is meant for tests
+ * and benchmarks.
+ */
+enum class ChecksumLevel : uint8_t
+{
+    Scalar,  ///< Portable code: word-wide XOR and sums, table-driven CRCs (slicing-by-8)
+    Simd128, ///< x86: SSE2 BCC/LRC and PCLMULQDQ folding for all CRCs (needs SSSE3);
+             ///< aarch64: NEON BCC/LRC, CRC32 instructions when built with the CRC extension
+    Simd256  ///< x86: AVX2 BCC/LRC on top of Simd128
+};
+
+/**
+ * @brief XOR of all bytes (Block Check Character), continued from bcc
+ */
+uint8_t ChecksumBcc(const void* data, size_t length, uint8_t bcc = 0);
+
+/**
+ * @brief Longitudinal redundancy check: two's complement of the byte sum (Modbus ASCII)
+ */
+uint8_t ChecksumLrc(const void* data, size_t length);
+
+/**
+ * @brief CRC-16 of data with the initial value of kind
+ */
+uint16_t ChecksumCrc16(Crc16 kind, const void* data, size_t length);
+
+/**
+ * @brief CRC-16 of data continued from crc, the result of a previous call
+ */
+uint16_t ChecksumCrc16(Crc16 kind, uint16_t crc, const void* data, size_t length);
+
+/**
+ * @brief CRC-32 (IEEE 802.3, as zlib and Ethernet), continued from crc; start with 0
+ */
+uint32_t ChecksumCrc32(const void* data, size_t length, uint32_t crc = 0);
+
+/**
+ * @brief Best level this CPU supports
+ */
+ChecksumLevel ChecksumSupportedLevel();
+
+/**
+ * @brief Level the kernels currently use
+ */
+ChecksumLevel ChecksumActiveLevel();
+
+/**
+ * @brief Use level, or the supported level when the CPU lacks it; affects all threads
+ */
+void ChecksumSetLevel(ChecksumLevel level);
+
+/**
+ * @brief Name of a level for reports, e.g. "avx2"
+ */
+const char* ChecksumLevelName(ChecksumLevel level);
+
+#endif // SERIAL_CHECKSUM_HPP
@@ -0,0 +1,612 @@
+#ifndef SERIAL_COROUTINE_HPP
+#define SERIAL_COROUTINE_HPP
+
+// C++20 only: the library itself builds as C++17, applications opt in by compiling with coroutines.
+#if defined(__cpp_impl_coroutine) && !defined(_WIN32)
+
+#include "SerialReactor.hpp"
+
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+/**
+ * @brief Outcome of an asynchronous serial operation
+ */
+enum class AsyncStatus
+{
+    Ok,        ///< Completed
+    Timeout,   ///< The deadline passed first
+    Cancelled, ///< AsyncPort::Cancel() was called
+    Busy,      ///< Another operation of the same direction is already pending on the port
+    Error      ///< The port failed or hung up
+};
+
+/**
+ * @brief Result of co_await on an AsyncPort operation
+ */
+struct AsyncResult
+{
+    AsyncStatus status = AsyncStatus::Ok;
+    size_t      bytes  = 0; ///< Bytes read, or bytes accepted for writing
+
+    explicit operator bool() const
+    {
+        return status == AsyncStatus::Ok;
+    }
+};
+
+template <typename T = void>
+class SerialTask;
+
+namespace serial_detail
+{
+template <typename T>
+struct TaskResult
+{
+    std::optional<T> value;
+
+    void return_value(T result)
+    {
+        value.emplace(std::move(result));
+    }
+
+    T take()
+    {
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskResult<void>
+{
+    void return_void()
+    {
+    }
+
+    void take()
+    {
+    }
+};
+} // namespace serial_detail
+
+/**
+ * @brief Lazily started coroutine returning T, resumed by whoever co_awaits it
+ *
+ * The body starts when the task is awaited (or handed to Spawn) and its caller resumes
+ * directly when it finishes (symmetric transfer), so chains of tasks use no extra stack.
+ */
+template <typename T>
+class SerialTask
+{
+public:
+    struct promise_type : serial_detail::TaskResult<T>
+    {
+        std::coroutine_handle<> continuation;
+        std::exception_ptr      error;
+
+        SerialTask get_return_object()
+        {
+            return SerialTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> finished) noexcept
+            {
+                std::coroutine_handle<> next = finished.promise().continuation;
+                return next ? next : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept
+            {
+            }
+        };
+
+        FinalAwaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void unhandled_exception()
+        {
+            error = std::current_exception();
+        }
+    };
+
+    SerialTask(SerialTask&& other) noexcept : handle_(std::exchange(other.handle_, {}))
+    {
+    }
+
+    SerialTask& operator=(SerialTask&& other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+
+    ~SerialTask()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    bool await_ready() const noexcept
+    {
+        return false;
+    }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+
+    T await_resume()
+    {
+        if (handle_.promise().error)
+            std::rethrow_exception(handle_.promise().error);
+        return handle_.promise().take();
+    }
+
+private:
+    explicit SerialTask(std::coroutine_handle<promise_type> handle) : handle_(handle)
+    {
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+namespace serial_detail
+{
+struct Detached
+{
+    struct promise_type
+    {
+        Detached get_return_object() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void() noexcept
+        {
+        }
+
+        void unhandled_exception() noexcept
+        {
+            // Like a reactor handler, a failing session must not take the loop down.
+        }
+    };
+};
+
+inline Detached runDetached(SerialTask<void> task)
+{
+    co_await task;
+}
+} // namespace serial_detail
+
+/**
+ * @brief Start a task on the calling thread and let it run to completion on its own
+ *
+ * Exceptions escaping the task are dropped.
+ */
+inline void Spawn(SerialTask<void> task)
+{
+    serial_detail::runDetached(std::move(task));
+}
+
+/**
+ * @brief Start a task on the reactor shard serving affinity
+ *
+ * Every resumption of operations on that port happens on the same shard thread, so a
+ * session spawned this way runs entirely on one thread and needs no locking of its own.
+ */
+inline void Spawn(SerialReactor& reactor, SerialTask<void> task, const SerialCommunication* affinity = nullptr)
+{
+    auto pending = std::make_shared<SerialTask<void>>(std::move(task));
+    reactor.Post([pending] { Spawn(std::move(*pending)); }, affinity);
+}
+
+/**
+ * @brief Awaitable reads and writes on a port served by a SerialReactor
+ *
+ * The port is registered with the reactor for the lifetime of this object. Operations
+ * try the port first and only suspend when they would block; the reactor resumes the
+ * coroutine from the shard thread on readiness, on the deadline, or on Cancel(). At most
+ * one read-side (Read/WaitReadable) and one write operation may be pending at a time.
+ * Do not combine with a receive thread on the same port. Destroy only when no operation
+ * is pending.
+ *
+ * @code
+ * SerialTask<> session(AsyncPort& port)
+ * {
+ *     char buffer[64];
+ *     auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+ *     co_await port.Write("V", 1, deadline);
+ *     AsyncResult r = co_await port.Read(buffer, sizeof(buffer), deadline);
+ * }
+ * @endcode
+ */
+class AsyncPort
+{
+public:
+    using Deadline = SerialCommunication::Deadline;
+
+private:
+    enum class Kind
+    {
+        Wait,
+        Read,
+        Write
+    };
+
+    struct Waiter
+    {
+        Kind                    kind;
+        std::coroutine_handle<> handle;
+        AsyncResult             result;
+        uint8_t*                buffer = nullptr;
+        size_t                  length = 0;
+        bool                    queued = false; // Write: data accepted by the write queue
+        uint64_t                seq    = 0;
+        SerialReactor::TimerId  timer  = 0;
+    };
+
+    struct State
+    {
+        State(SerialReactor& r, std::shared_ptr<SerialCommunication> p) : reactor(r), port(std::move(p))
+        {
+        }
+
+        SerialReactor&                       reactor;
+        std::shared_ptr<SerialCommunication> port;
+        std::mutex                           mutex;
+        Waiter*                              reader   = nullptr;
+        Waiter*                              writer   = nullptr;
+        uint64_t                             seq      = 0;
+        bool                                 attached = false;
+
+        // Caller holds mutex.
+        void updateEvents()
+        {
+            if (attached)
+                reactor.Modify(*port, (reader ? SerialReactor::Readable : 0u) | (writer ? SerialReactor::Writable : 0u));
+        }
+
+        // Caller holds lock; releases it before resuming the coroutine.
+        void complete(Waiter*& slot, AsyncStatus status, std::unique_lock<std::mutex>& lock)
+        {
+            Waiter* waiter        = slot;
+            slot                  = nullptr;
+            waiter->result.status = status;
+            updateEvents();
+            lock.unlock();
+
+            if (waiter->timer)
+                reactor.CancelTimer(waiter->timer);
+            waiter->handle.resume();
+        }
+
+        void serviceRead(bool failed)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!reader)
+                return;
+            if (failed)
+                return complete(reader, AsyncStatus::Error, lock);
+            if (reader->kind == Kind::Wait)
+                return complete(reader, AsyncStatus::Ok, lock);
+
+            try
+            {
+                reader->result.bytes = port->ReadAvailable(reader->buffer, reader->length);
+            }
+            catch (const std::runtime_error&)
+            {
+                return complete(reader, AsyncStatus::Error, lock);
+            }
+            if (reader->result.bytes > 0)
+                complete(reader, AsyncStatus::Ok, lock);
+        }
+
+        void serviceWrite(bool failed)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (!writer)
+                return;
+            if (failed)
+                return complete(writer, AsyncStatus::Error, lock);
+
+            try
+            {
+                if (!writer->queued)
+                {
+                    port->ProcessWritable();
+                    writer->queued = port->QueueWrite(writer->buffer, writer->length) > 0;
+                    if (writer->queued)
+                        writer->result.bytes = writer->length;
+                }
+                if (writer->queued && port->ProcessWritable() == 0)
+                    complete(writer, AsyncStatus::Ok, lock);
+            }
+            catch (const std::runtime_error&)
+            {
+                complete(writer, AsyncStatus::Error, lock);
+            }
+        }
+
+        void expire(uint64_t id)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (reader && reader->seq == id)
+            {
+                reader->timer = 0;
+                complete(reader, AsyncStatus::Timeout, lock);
+            }
+            else if (writer && writer->seq == id)
+            {
+                writer->timer = 0;
+                complete(writer, AsyncStatus::Timeout, lock);
+            }
+        }
+
+        void cancel()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (reader)
+            {
+                complete(reader, AsyncStatus::Cancelled, lock);
+                lock.lock();
+            }
+            if (writer)
+                complete(writer, AsyncStatus::Cancelled, lock);
+        }
+
+        bool suspend(Waiter& waiter, Deadline deadline, std::coroutine_handle<> handle)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            Waiter*&                    slot = waiter.kind == Kind::Write ? writer : reader;
+            if (slot || !attached)
+            {
+                waiter.result.status = slot ? AsyncStatus::Busy : AsyncStatus::Error;
+                return false;
+            }
+
+            waiter.handle = handle;
+            waiter.seq    = ++seq;
+            slot          = &waiter;
+
+            if (deadline != Deadline::max())
+            {
+                std::weak_ptr<State> self = selfRef;
+                uint64_t             id   = waiter.seq;
+                waiter.timer              = reactor.AddTimer(deadline, [self, id] {
+                    if (auto state = self.lock())
+                        state->expire(id);
+                }, port.get());
+            }
+            updateEvents();
+            return true;
+        }
+
+        std::weak_ptr<State> selfRef;
+    };
+
+public:
+    /**
+     * @brief Operation returned by Read(), Write() and WaitReadable(); co_await it once
+     */
+    class Operation
+    {
+    public:
+        bool await_ready()
+        {
+            if (!state_->attached)
+            {
+                waiter_.result.status = AsyncStatus::Error;
+                return true;
+            }
+
+            try
+            {
+                switch (waiter_.kind)
+                {
+                    case Kind::Wait:
+                        break;
+
+                    case Kind::Read:
+                        waiter_.result.bytes = state_->port->ReadAvailable(waiter_.buffer, waiter_.length);
+                        if (waiter_.result.bytes > 0 || waiter_.length == 0)
+                            return true;
+                        break;
+
+                    case Kind::Write:
+                        waiter_.queued = state_->port->QueueWrite(waiter_.buffer, waiter_.length) > 0 || waiter_.length == 0;
+                        if (waiter_.queued)
+                        {
+                            waiter_.result.bytes = waiter_.length;
+                            if (state_->port->PendingWrite() == 0)
+                                return true;
+                        }
+                        break;
+                }
+            }
+            catch (const std::runtime_error&)
+            {
+                waiter_.result.status = AsyncStatus::Error;
+                return true;
+            }
+
+            if (std::chrono::steady_clock::now() >= deadline_)
+            {
+                waiter_.result.status = AsyncStatus::Timeout;
+                return true;
+            }
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            return state_->suspend(waiter_, deadline_, handle);
+        }
+
+        AsyncResult await_resume() const
+        {
+            return waiter_.result;
+        }
+
+    private:
+        friend class AsyncPort;
+
+        Operation(std::shared_ptr<State> state, Kind kind, uint8_t* buffer, size_t length, Deadline deadline) :
+            state_(std::move(state)), deadline_(deadline)
+        {
+            waiter_.kind   = kind;
+            waiter_.buffer = buffer;
+            waiter_.length = length;
+        }
+
+        std::shared_ptr<State> state_;
+        Deadline               deadline_;
+        Waiter                 waiter_;
+    };
+
+    /**
+     * @brief Register port with reactor
+     * @param reactor Reactor driving the operations
+     * @param port Open port; Valid() is false if it could not be registered
+     */
+    AsyncPort(SerialReactor& reactor, std::shared_ptr<SerialCommunication> port) :
+        state_(std::make_shared<State>(reactor, std::move(port)))
+    {
+        state_->selfRef = state_;
+        if (!state_->port)
+            return;
+
+        // Held across Add() so an early Error from the shard thread cannot be overwritten.
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        std::weak_ptr<State>        self = state_;
+        state_->attached                 = reactor.Add(
+            state_->port,
+            [self](SerialCommunication&, uint32_t events) {
+                auto state = self.lock();
+                if (!state)
+                    return;
+
+                bool failed = (events & SerialReactor::Error) != 0;
+                if (failed)
+                {
+                    // A hung-up port reports Error forever; stop watching it.
+                    std::unique_lock<std::mutex> lock(state->mutex);
+                    state->attached = false;
+                    state->reactor.Remove(*state->port);
+                }
+                if (events & (SerialReactor::Readable | SerialReactor::Error))
+                    state->serviceRead(failed);
+                if (events & (SerialReactor::Writable | SerialReactor::Error))
+                    state->serviceWrite(failed);
+            },
+            0);
+    }
+
+    ~AsyncPort()
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        if (state_->attached)
+            state_->reactor.Remove(*state_->port);
+        state_->attached = false;
+    }
+
+    AsyncPort(const AsyncPort&)            = delete;
+    AsyncPort& operator=(const AsyncPort&) = delete;
+
+    /**
+     * @brief Whether the port is registered and has not failed
+     */
+    bool Valid() const
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->attached;
+    }
+
+    /**
+     * @brief Underlying port
+     */
+    SerialCommunication& Port() const
+    {
+        return *state_->port;
+    }
+
+    /**
+     * @brief Read whatever is available, waiting until at least one byte arrives or deadline
+     */
+    Operation Read(void* buffer, size_t length, Deadline deadline = Deadline::max())
+    {
+        return Operation(state_, Kind::Read, static_cast<uint8_t*>(buffer), length, deadline);
+    }
+
+    /**
+     * @brief Write all bytes, completing once they were handed to the driver or at deadline
+     *
+     * On timeout, bytes is length when the data sits in the write queue and 0 when the
+     * queue was too full to take it.
+     */
+    Operation Write(const void* buffer, size_t length, Deadline deadline = Deadline::max())
+    {
+        return Operation(state_, Kind::Write, static_cast<uint8_t*>(const_cast<void*>(buffer)), length, deadline);
+    }
+
+    /**
+     * @brief Wait until the port is readable, without reading
+     */
+    Operation WaitReadable(Deadline deadline = Deadline::max())
+    {
+        return Operation(state_, Kind::Wait, nullptr, 0, deadline);
+    }
+
+    /**
+     * @brief Resume pending operations with AsyncStatus::Cancelled. Thread-safe.
+     *
+     * The coroutines are resumed from the shard thread serving the port.
+     */
+    void Cancel()
+    {
+        std::shared_ptr<State> state = state_;
+        state_->reactor.Post([state] { state->cancel(); }, state_->port.get());
+    }
+
+private:
+    std::shared_ptr<State> state_;
+};
+
+#endif // __cpp_impl_coroutine && !_WIN32
+
+#endif // SERIAL_COROUTINE_HPP
@@ -0,0 +1,95 @@
+#include "SerialHandleTable.hpp"
+
+SerialHandleTable::~SerialHandleTable()
+{
+    for (auto& segment : segments_)
+        delete segment.load(std::memory_order_relaxed);
+}
+
+SerialHandleTable::Slot* SerialHandleTable::slotOf(int handle) const
+{
+    if (handle < 0)
+        return nullptr;
+
+    uint32_t index   = static_cast<uint32_t>(handle) & INDEX_MASK;
+    Segment* segment = segments_[index / SEGMENT_SIZE].load(std::memory_order_acquire);
+    return segment ? &segment->slots[index % SEGMENT_SIZE] : nullptr;
+}
+
+int SerialHandleTable::Insert(std::shared_ptr<SerialCommunication> port)
+{
+    if (!port)
+        return -1;
+
+    uint32_t index;
+    {
+        std::lock_guard<std::mutex> lock(allocMutex_);
+        if (!freeSlots_.empty())
+        {
+            index = freeSlots_.front();
+            freeSlots_.pop_front();
+        }
+        else
+        {
+            if (nextSlot_ >= CAPACITY)
+                return -1;
+            index = nextSlot_++;
+
+            std::atomic<Segment*>& segment = segments_[index / SEGMENT_SIZE];
+            if (!segment.load(std::memory_order_relaxed))
+                segment.store(new Segment(), std::memory_order_release);
+        }
+    }
+
+    Slot&                               slot = segments_[index / SEGMENT_SIZE].load(std::memory_order_acquire)->slots[index % SEGMENT_SIZE];
+    std::unique_lock<std::shared_mutex> lock(slot.access);
+    slot.port = std::move(port);
+    return static_cast<int>(((slot.generation & GENERATION_MASK) << INDEX_BITS) | index);
+}
+
+// Called with the access lock of slot held, which keeps generation and port from changing.
+bool SerialHandleTable::matches(const Slot& slot, int handle) const
+{
+    uint32_t generation = static_cast<uint32_t>(handle) >> INDEX_BITS;
+    return (slot.generation & GENERATION_MASK) == generation && slot.port;
+}
+
+SerialHandleTable::SharedLease SerialHandleTable::Use(int handle) const
+{
+    Slot* slot = slotOf(handle);
+    if (!slot)
+        return SharedLease();
+
+    // Looked up after locking: a Deinit() that held the lock has invalidated the handle by now.
+    std::shared_lock<std::shared_mutex> lock(slot->access);
+    if (!matches(*slot, handle))
+        return SharedLease();
+    return SharedLease(slot, static_cast<uint32_t>(handle) & INDEX_MASK, std::move(lock));
+}
+
+SerialHandleTable::ExclusiveLease SerialHandleTable::Own(int handle) const
+{
+    Slot* slot = slotOf(handle);
+    if (!slot)
+        return ExclusiveLease();
+
+    std::unique_lock<std::shared_mutex> lock(slot->access);
+    if (!matches(*slot, handle))
+        return ExclusiveLease();
+    return ExclusiveLease(slot, static_cast<uint32_t>(handle) & INDEX_MASK, std::move(lock));
+}
+
+std::shared_ptr<SerialCommunication> SerialHandleTable::Remove(ExclusiveLease& lease)
+{
+    if (!lease)
+        return nullptr;
+
+    std::shared_ptr<SerialCommunication> port = std::move(lease.slot_->port);
+    ++lease.slot_->generation;
+    uint32_t index = lease.index_;
+    lease          = ExclusiveLease();
+
+    std::lock_guard<std::mutex> lock(allocMutex_);
+    freeSlots_.push_back(index);
+    return port;
+}
@@ -0,0 +1,141 @@
+#ifndef SERIAL_HANDLE_TABLE_HPP
+#define SERIAL_HANDLE_TABLE_HPP
+
+#include "Serial.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+
+/**
+ * @brief Maps the int instance IDs of the C API to SerialCommunication objects
+ *
+ * A handle packs a slot index (low 16 bits) and the generation of that slot (next 15 bits),
+ * so it is never negative. Removing a port bumps the generation of its slot: a stale handle
+ * no longer matches and is rejected instead of reaching the port that reuses the slot.
+ * Freed slots are reused oldest first, so a slot goes through 32768 generations before an
+ * old handle could match again.
+ *
+ * Slots live in segments of SEGMENT_SIZE that are allocated on demand and never freed while
+ * the table exists, so finding the slot of a handle takes no lock.
+ *
+ * The port and generation of a slot are guarded by its access lock alone. Use() holds it
+ * shared for the duration of an I/O call, Own() holds it exclusive, so Close/Open/Deinit wait
+ * for calls in flight on that port and calls made meanwhile wait for them. Insert() and
+ * Remove() change a slot only while holding it exclusive. Threads driving different ports
+ * never contend; the free list is the only state shared between slots.
+ */
+class SerialHandleTable
+{
+public:
+    static const unsigned int INDEX_BITS   = 16;
+    static const size_t       SEGMENT_SIZE = 256;
+    static const size_t       CAPACITY     = size_t(1) << INDEX_BITS; ///< Ports open at the same time at most
+
+private:
+    struct Slot;
+
+public:
+    /**
+     * @brief A port together with its access lock; empty when the handle was invalid or stale
+     */
+    template <typename Lock>
+    class Lease
+    {
+    public:
+        Lease() = default;
+
+        explicit operator bool() const
+        {
+            return slot_ != nullptr;
+        }
+        SerialCommunication* operator->() const
+        {
+            return slot_->port.get();
+        }
+        SerialCommunication& operator*() const
+        {
+            return *slot_->port;
+        }
+        const std::shared_ptr<SerialCommunication>& Port() const
+        {
+            return slot_->port;
+        }
+
+    private:
+        friend class SerialHandleTable;
+
+        Lease(Slot* slot, uint32_t index, Lock lock) : slot_(slot), index_(index), lock_(std::move(lock))
+        {
+        }
+
+        Slot*    slot_  = nullptr;
+        uint32_t index_ = 0;
+        Lock     lock_;
+    };
+
+    using SharedLease    = Lease<std::shared_lock<std::shared_mutex>>;
+    using ExclusiveLease = Lease<std::unique_lock<std::shared_mutex>>;
+
+    SerialHandleTable() = default;
+    ~SerialHandleTable();
+
+    SerialHandleTable(const SerialHandleTable&)            = delete;
+    SerialHandleTable& operator=(const SerialHandleTable&) = delete;
+
+    /**
+     * @brief Store port in a free slot
+     * @return Handle of the port, -1 if the table is full
+     */
+    int Insert(std::shared_ptr<SerialCommunication> port);
+
+    /**
+     * @brief Port of handle, locked for I/O: Close, Open and Deinit wait until the lease is gone
+     * @note A thread must not hold two leases of the same port
+     */
+    SharedLease Use(int handle) const;
+
+    /**
+     * @brief Port of handle, locked exclusively: waits for the I/O leases of the port to end
+     */
+    ExclusiveLease Own(int handle) const;
+
+    /**
+     * @brief Take the owned port out of the table and invalidate its handle
+     *
+     * Ends the lease; calls waiting for the port find the handle stale afterwards.
+     * @return The removed port, nullptr if the lease is empty
+     */
+    std::shared_ptr<SerialCommunication> Remove(ExclusiveLease& lease);
+
+private:
+    static const uint32_t INDEX_MASK      = (1u << INDEX_BITS) - 1;
+    static const uint32_t GENERATION_MASK = 0x7FFF;
+    static const size_t   SEGMENT_COUNT   = CAPACITY / SEGMENT_SIZE;
+
+    struct Slot
+    {
+        mutable std::shared_mutex            access;        // Held by leases; guards the fields below
+        uint32_t                             generation = 1;
+        std::shared_ptr<SerialCommunication> port;
+    };
+
+    struct Segment
+    {
+        Slot slots[SEGMENT_SIZE];
+    };
+
+    Slot* slotOf(int handle) const;
+    bool  matches(const Slot& slot, int handle) const;
+
+    std::atomic<Segment*> segments_[SEGMENT_COUNT] = {};
+
+    std::mutex           allocMutex_; // Guards freeSlots_, nextSlot_ and segment allocation
+    std::deque<uint32_t> freeSlots_;
+    uint32_t             nextSlot_ = 0;
+};
+
+#endif // SERIAL_HANDLE_TABLE_HPP
@@ -0,0 +1,276 @@
+#include "SerialHotplug.hpp"
+
+#include <atomic>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+#include <cerrno>
+#include <linux/netlink.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Receive buffer of the uevent socket; large enough for the burst of a hub with many adapters.
+static const int UEVENT_SOCKET_BUFFER = 4 * 1024 * 1024;
+
+// Largest uevent message; the kernel limits the environment to 2048 bytes.
+static const size_t UEVENT_MESSAGE_SIZE = 8192;
+
+struct SerialHotplug::Monitor
+{
+    int               socketFd = -1;
+    int               wakeFd   = -1;
+    std::atomic<bool> running{true};
+
+    ~Monitor()
+    {
+#ifndef _WIN32
+        if (socketFd >= 0)
+            ::close(socketFd);
+        if (wakeFd >= 0)
+            ::close(wakeFd);
+#endif
+    }
+};
+
+SerialHotplug& SerialHotplug::Instance()
+{
+    static SerialHotplug instance;
+    return instance;
+}
+
+SerialHotplug::~SerialHotplug()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    subscriptions_.clear();
+    stop(lock);
+}
+
+int SerialHotplug::Subscribe(Callback callback, uint16_t vendorId, uint16_t productId)
+{
+    if (!callback)
+        return 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!monitor_ && !start())
+        return 0;
+
+    int id             = nextId_++;
+    subscriptions_[id] = Subscription{std::move(callback), vendorId, productId};
+    return id;
+}
+
+void SerialHotplug::Unsubscribe(int id)
+{
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (subscriptions_.erase(id) == 0)
+            return;
+        if (subscriptions_.empty())
+            stop(lock);
+    }
+
+    // Wait for a callback in flight; passes at once when called from that callback.
+    std::lock_guard<std::recursive_mutex> callLock(callMutex_);
+}
+
+#ifdef _WIN32
+
+bool SerialHotplug::start()
+{
+    return false;
+}
+
+void SerialHotplug::stop(std::unique_lock<std::mutex>&)
+{
+}
+
+void SerialHotplug::run(std::shared_ptr<Monitor>)
+{
+}
+
+void SerialHotplug::handleMessage(const char*, size_t)
+{
+}
+
+#else
+
+bool SerialHotplug::start()
+{
+    auto monitor = std::make_shared<Monitor>();
+
+    monitor->socketFd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_KOBJECT_UEVENT);
+    monitor->wakeFd   = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (monitor->socketFd < 0 || monitor->wakeFd < 0)
+        return false;
+
+    // Needs no privileges beyond the default; SO_RCVBUFFORCE succeeds only with CAP_NET_ADMIN.
+    if (::setsockopt(monitor->socketFd, SOL_SOCKET, SO_RCVBUFFORCE, &UEVENT_SOCKET_BUFFER, sizeof(UEVENT_SOCKET_BUFFER)) != 0)
+        ::setsockopt(monitor->socketFd, SOL_SOCKET, SO_RCVBUF, &UEVENT_SOCKET_BUFFER, sizeof(UEVENT_SOCKET_BUFFER));
+
+    sockaddr_nl address{};
+    address.nl_family = AF_NETLINK;
+    address.nl_groups = 1; // Kernel events; group 2 carries the rebroadcasts of udev
+    if (::bind(monitor->socketFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        return false;
+
+    // Scan once the socket is bound, so that no event falls between the scan and the monitor.
+    SerialPortIndex::Instance().SetLive(true);
+
+    monitor_ = monitor;
+    thread_  = std::thread(&SerialHotplug::run, this, monitor);
+    return true;
+}
+
+void SerialHotplug::stop(std::unique_lock<std::mutex>& lock)
+{
+    if (!monitor_)
+        return;
+
+    monitor_->running = false;
+    uint64_t one      = 1;
+    (void)!::write(monitor_->wakeFd, &one, sizeof(one));
+    monitor_.reset();
+    SerialPortIndex::Instance().SetLive(false);
+
+    // The thread may be waiting for mutex_ in notify(); join it without holding the lock.
+    std::thread thread = std::move(thread_);
+    lock.unlock();
+    if (thread.get_id() == std::this_thread::get_id())
+        thread.detach();
+    else
+        thread.join();
+}
+
+void SerialHotplug::run(std::shared_ptr<Monitor> monitor)
+{
+    std::vector<char> message(UEVENT_MESSAGE_SIZE);
+
+    pollfd fds[2] = {{monitor->socketFd, POLLIN, 0}, {monitor->wakeFd, POLLIN, 0}};
+    while (monitor->running)
+    {
+        if (::poll(fds, 2, -1) < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        if (!(fds[0].revents & POLLIN))
+            continue;
+
+        sockaddr_nl sender{};
+        iovec       buffer{message.data(), message.size() - 1};
+        msghdr      header{};
+        header.msg_name    = &sender;
+        header.msg_namelen = sizeof(sender);
+        header.msg_iov     = &buffer;
+        header.msg_iovlen  = 1;
+
+        ssize_t length = ::recvmsg(monitor->socketFd, &header, MSG_DONTWAIT);
+        if (length < 0)
+        {
+            // Events were dropped: rebuild the port set and report what changed.
+            if (errno == ENOBUFS)
+                resync();
+            continue;
+        }
+
+        // Only the kernel may report devices; ignore anything another process sent.
+        if (sender.nl_pid != 0 || (header.msg_flags & MSG_TRUNC))
+            continue;
+
+        message[static_cast<size_t>(length)] = '\0';
+        handleMessage(message.data(), static_cast<size_t>(length));
+    }
+}
+
+// A message is "ACTION@DEVPATH" followed by KEY=VALUE strings, each terminated by '\0'.
+void SerialHotplug::handleMessage(const char* message, size_t length)
+{
+    const char* action    = nullptr;
+    const char* subsystem = nullptr;
+    const char* devName   = nullptr;
+
+    for (const char* field = message + std::strlen(message) + 1; field < message + length; field += std::strlen(field) + 1)
+    {
+        if (std::strncmp(field, "ACTION=", 7) == 0)
+            action = field + 7;
+        else if (std::strncmp(field, "SUBSYSTEM=", 10) == 0)
+            subsystem = field + 10;
+        else if (std::strncmp(field, "DEVNAME=", 8) == 0)
+            devName = field + 8;
+    }
+
+    if (!action || !subsystem || !devName || std::strcmp(subsystem, "tty") != 0)
+        return;
+
+    // DEVNAME is relative to /dev, as the index spells names.
+    SerialPortInfo port;
+    if (std::strcmp(action, "add") == 0)
+    {
+        if (SerialPortIndex::Instance().AddPort(devName, port))
+            notify(Event::Added, port);
+    }
+    else if (std::strcmp(action, "remove") == 0)
+    {
+        if (SerialPortIndex::Instance().RemovePort(std::string("/dev/") + devName, port))
+            notify(Event::Removed, port);
+    }
+}
+
+#endif
+
+void SerialHotplug::resync()
+{
+    SerialPortIndex& index = SerialPortIndex::Instance();
+
+    std::unordered_map<std::string, SerialPortInfo> before;
+    for (SerialPortInfo& port : index.List())
+    {
+        std::string device = port.device;
+        before.emplace(std::move(device), std::move(port));
+    }
+
+    index.Invalidate();
+    for (const SerialPortInfo& port : index.List())
+    {
+        if (before.erase(port.device) == 0)
+            notify(Event::Added, port);
+    }
+    for (const auto& gone : before)
+        notify(Event::Removed, gone.second);
+}
+
+void SerialHotplug::notify(Event event, const SerialPortInfo& port)
+{
+    std::lock_guard<std::recursive_mutex> callLock(callMutex_);
+
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& entry : subscriptions_)
+            ids.push_back(entry.first);
+    }
+
+    for (int id : ids)
+    {
+        // Look the subscription up again: an earlier callback may have removed it.
+        Callback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto                        it = subscriptions_.find(id);
+            if (it == subscriptions_.end())
+                continue;
+            const Subscription& subscription = it->second;
+            if ((subscription.vendorId != 0 && subscription.vendorId != port.vendorId) ||
+                (subscription.productId != 0 && subscription.productId != port.productId))
+                continue;
+            callback = subscription.callback;
+        }
+        callback(event, port);
+    }
+}
@@ -0,0 +1,84 @@
+#ifndef SERIAL_HOTPLUG_HPP
+#define SERIAL_HOTPLUG_HPP
+
+#include "SerialPortIndex.hpp"
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * @brief Reports serial ports appearing and disappearing, from kernel uevents
+ *
+ * The first subscription opens a NETLINK_KOBJECT_UEVENT socket (no libudev needed) and
+ * starts a monitor thread; the last unsubscription stops it. While the monitor runs,
+ * SerialPortIndex is live: the tty add/remove events update it incrementally, so lookups
+ * neither scan sysfs nor stat /dev. If the socket overflows during an event burst, the index
+ * is rescanned and the difference is reported as events.
+ *
+ * Callbacks run on the monitor thread, one at a time. Once Unsubscribe() returns the
+ * callback is not running and will not run again, unless Unsubscribe() was called from
+ * inside a callback. Not available on Windows.
+ */
+class SerialHotplug
+{
+public:
+    enum class Event
+    {
+        Added,
+        Removed
+    };
+
+    using Callback = std::function<void(Event event, const SerialPortInfo& port)>;
+
+    /**
+     * @brief Process-wide monitor used by the C APIs
+     */
+    static SerialHotplug& Instance();
+
+    SerialHotplug() = default;
+    ~SerialHotplug();
+
+    SerialHotplug(const SerialHotplug&)            = delete;
+    SerialHotplug& operator=(const SerialHotplug&) = delete;
+
+    /**
+     * @brief Call callback for ports of vendorId:productId (0 = any) that come or go
+     * @return Subscription ID (> 0), 0 if the kernel events cannot be received
+     */
+    int Subscribe(Callback callback, uint16_t vendorId = 0, uint16_t productId = 0);
+
+    /**
+     * @brief Stop a subscription; stops the monitor with the last one
+     */
+    void Unsubscribe(int id);
+
+private:
+    struct Subscription
+    {
+        Callback callback;
+        uint16_t vendorId;
+        uint16_t productId;
+    };
+
+    struct Monitor;
+
+    bool start();                                  // Caller holds mutex_
+    void stop(std::unique_lock<std::mutex>& lock); // Releases lock to join the thread
+    void run(std::shared_ptr<Monitor> monitor);
+    void handleMessage(const char* message, size_t length);
+    void resync();
+    void notify(Event event, const SerialPortInfo& port);
+
+    std::mutex                  mutex_;     // Guards subscriptions_, nextId_, monitor_ and thread_
+    std::recursive_mutex        callMutex_; // Held while calling back; recursive for Unsubscribe() from a callback
+    std::map<int, Subscription> subscriptions_;
+    int                         nextId_ = 1;
+    std::shared_ptr<Monitor>    monitor_;   // Shared with the thread, which may outlive stop() when detached
+    std::thread                 thread_;
+};
+
+#endif // SERIAL_HOTPLUG_HPP
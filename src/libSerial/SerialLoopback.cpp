@@ -0,0 +1,325 @@
+#include "SerialLoopback.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <random>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+static const char LOOPBACK_PREFIX[] = "loop://";
+
+// Unread bytes buffered per direction before writers see backpressure, like a tty buffer.
+static const size_t PIPE_CAPACITY = 64 * 1024;
+
+// Data becomes readable in packets of this size, as with USB-serial bulk transfers.
+static const size_t PACKET_SIZE = 64;
+
+namespace
+{
+// One write; its bytes become readable packet by packet from `arrival` on.
+struct Chunk
+{
+    std::vector<uint8_t> data;
+    size_t               offset;  // Bytes already read
+    Clock::time_point    arrival; // When the first byte has fully arrived
+};
+
+// One direction of a channel.
+struct Pipe
+{
+    std::mutex              mutex;
+    std::condition_variable readable;
+    std::condition_variable writable;
+    std::deque<Chunk>       chunks;
+    size_t                  unread = 0;
+    Clock::time_point       lineFree;    // When the transmitter finishes the bytes queued so far
+    Clock::time_point       lastArrival; // Keeps arrivals in order when jitter is applied
+    std::minstd_rand        random{std::random_device{}()};
+};
+} // namespace
+
+struct LoopbackChannel
+{
+    Pipe              pipes[2]; // pipes[i] carries data towards endpoint i
+    std::atomic<bool> open[2];  // Changed under the registry mutex, read lock-free by writers
+
+    LoopbackChannel()
+    {
+        open[0] = false;
+        open[1] = false;
+    }
+};
+
+static std::mutex                                             s_registryMutex;
+static std::map<std::string, std::weak_ptr<LoopbackChannel>> s_channels;
+
+bool IsLoopbackPortName(const std::string& portName)
+{
+    return portName.compare(0, sizeof(LOOPBACK_PREFIX) - 1, LOOPBACK_PREFIX) == 0;
+}
+
+// Splits "loop://<channel>/a|b" into channel name and endpoint index.
+static bool parsePortName(const std::string& portName, std::string& channel, int& endpoint)
+{
+    if (!IsLoopbackPortName(portName))
+        return false;
+
+    std::string rest = portName.substr(sizeof(LOOPBACK_PREFIX) - 1);
+    if (rest.size() < 3 || rest[rest.size() - 2] != '/')
+        return false;
+
+    char end = rest.back();
+    if (end != 'a' && end != 'b')
+        return false;
+
+    channel  = rest.substr(0, rest.size() - 2);
+    endpoint = end == 'a' ? 0 : 1;
+    return true;
+}
+
+// Bytes of the pipe readable at `now`; `next` receives the time the next packet arrives.
+static size_t readyBytes(const Pipe& pipe, std::chrono::nanoseconds byteTime, Clock::time_point now, Clock::time_point& next)
+{
+    size_t ready = 0;
+    next         = Clock::time_point::max();
+
+    for (const Chunk& chunk : pipe.chunks)
+    {
+        size_t size = chunk.data.size();
+        size_t arrived;
+        if (now < chunk.arrival)
+            arrived = 0;
+        else if (byteTime.count() == 0)
+            arrived = size;
+        else
+        {
+            size_t received = 1 + static_cast<size_t>((now - chunk.arrival) / byteTime);
+            arrived         = received >= size ? size : received - received % PACKET_SIZE;
+        }
+
+        if (arrived > chunk.offset)
+            ready += arrived - chunk.offset;
+
+        if (arrived < size)
+        {
+            size_t packetEnd = std::min(size, (arrived / PACKET_SIZE + 1) * PACKET_SIZE);
+            next             = chunk.arrival + byteTime * static_cast<long long>(packetEnd - 1);
+            break;
+        }
+    }
+
+    return ready;
+}
+
+// Moves up to length readable bytes out of the pipe. Caller holds the pipe mutex.
+static size_t takeBytes(Pipe& pipe, uint8_t* out, size_t length)
+{
+    size_t copied = 0;
+    while (copied < length && !pipe.chunks.empty())
+    {
+        Chunk& chunk = pipe.chunks.front();
+        size_t n     = std::min(length - copied, chunk.data.size() - chunk.offset);
+        std::memcpy(out + copied, chunk.data.data() + chunk.offset, n);
+        chunk.offset += n;
+        copied += n;
+
+        if (chunk.offset == chunk.data.size())
+            pipe.chunks.pop_front();
+    }
+
+    pipe.unread -= copied;
+    if (copied > 0)
+        pipe.writable.notify_all();
+    return copied;
+}
+
+static void clearPipe(Pipe& pipe)
+{
+    std::lock_guard<std::mutex> lock(pipe.mutex);
+    pipe.chunks.clear();
+    pipe.unread = 0;
+    pipe.writable.notify_all();
+}
+
+LoopbackSerialCommunication::LoopbackSerialCommunication(const std::string& portName, uint32_t baudRate, uint8_t dataBits,
+                                                         uint8_t stopBits, char parity, bool enableRts, bool enableDtr,
+                                                         const LoopbackOptions& options) :
+    SerialCommunication(portName, baudRate, dataBits, stopBits, parity, enableRts, enableDtr), options_(options), endpoint_(0),
+    byteTime_(0)
+{
+}
+
+LoopbackSerialCommunication::~LoopbackSerialCommunication()
+{
+    // The base destructor can no longer reach closeDevice() of this class.
+    Close();
+}
+
+SerialBackend LoopbackSerialCommunication::Backend() const
+{
+    return SerialBackend::Loopback;
+}
+
+bool LoopbackSerialCommunication::configurePort()
+{
+    byteTime_ = std::chrono::nanoseconds(0);
+    if (options_.simulateBaud && baudRate_ > 0)
+    {
+        bool     parityBit = parity_ != 'N' && parity_ != 'n';
+        uint32_t frameBits = 1 + dataBits_ + (parityBit ? 1 : 0) + (stopBits_ == 2 ? 2 : 1);
+        byteTime_          = std::chrono::nanoseconds(1000000000ULL * frameBits / baudRate_);
+    }
+
+    actualBaudRate_ = baudRate_;
+    return true;
+}
+
+bool LoopbackSerialCommunication::applyReadMode()
+{
+    // Minimums are honoured by readDevice(); there is no inter-byte timer to program.
+    return true;
+}
+
+bool LoopbackSerialCommunication::openDevice()
+{
+    std::string name;
+    int         endpoint;
+    if (!parsePortName(portName_, name, endpoint))
+        return false;
+
+    std::shared_ptr<LoopbackChannel> channel;
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+
+        for (auto it = s_channels.begin(); it != s_channels.end();)
+            it = it->second.expired() ? s_channels.erase(it) : std::next(it);
+
+        channel = s_channels[name].lock();
+        if (!channel)
+        {
+            channel          = std::make_shared<LoopbackChannel>();
+            s_channels[name] = channel;
+        }
+
+        if (channel->open[endpoint])
+            return false;
+        channel->open[endpoint] = true;
+    }
+
+    // Whatever was sent while this end was closed never reached it.
+    clearPipe(channel->pipes[endpoint]);
+
+    channel_  = channel;
+    endpoint_ = endpoint;
+    return configurePort();
+}
+
+void LoopbackSerialCommunication::closeDevice()
+{
+    if (!channel_)
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(s_registryMutex);
+        channel_->open[endpoint_] = false;
+    }
+
+    channel_.reset();
+}
+
+bool LoopbackSerialCommunication::flushDevice()
+{
+    clearPipe(channel_->pipes[endpoint_]);
+    return true;
+}
+
+SerialResult LoopbackSerialCommunication::readDevice(void* buffer, size_t length, unsigned int timeoutMs) noexcept
+{
+    Pipe&             in       = channel_->pipes[endpoint_];
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    size_t            wanted   = std::max<size_t>(1, std::min<size_t>(readMode_.minBytes, length));
+
+    std::unique_lock<std::mutex> lock(in.mutex);
+    for (;;)
+    {
+        Clock::time_point now = Clock::now();
+        Clock::time_point next;
+        size_t            ready = readyBytes(in, byteTime_, now, next);
+
+        if (ready >= wanted)
+            return SerialResult::Received(takeBytes(in, static_cast<uint8_t*>(buffer), std::min(ready, length)));
+        if (now >= deadline)
+            return SerialResult::TimedOut();
+
+        in.readable.wait_until(lock, std::min(deadline, next));
+    }
+}
+
+SerialResult LoopbackSerialCommunication::readDeviceNow(void* buffer, size_t length) noexcept
+{
+    Pipe&                       in = channel_->pipes[endpoint_];
+    std::lock_guard<std::mutex> lock(in.mutex);
+
+    Clock::time_point next;
+    size_t            ready = readyBytes(in, byteTime_, Clock::now(), next);
+    return SerialResult::Received(takeBytes(in, static_cast<uint8_t*>(buffer), std::min(ready, length)));
+}
+
+SerialResult LoopbackSerialCommunication::writeDevice(const iovec* iov, size_t count) noexcept
+{
+    size_t total = 0;
+    for (size_t i = 0; i < count; ++i)
+        total += iov[i].iov_len;
+
+    // Nobody listening: the bytes go out on the line and are lost.
+    if (!channel_->open[1 - endpoint_])
+        return SerialResult::Transferred(total);
+
+    Pipe&                       out = channel_->pipes[1 - endpoint_];
+    std::lock_guard<std::mutex> lock(out.mutex);
+
+    size_t accepted = std::min(total, PIPE_CAPACITY - out.unread);
+    if (accepted == 0)
+        return SerialResult::Transferred(0);
+
+    Chunk chunk;
+    chunk.offset = 0;
+    chunk.data.reserve(accepted);
+    for (size_t i = 0; i < count && chunk.data.size() < accepted; ++i)
+    {
+        const uint8_t* base = static_cast<const uint8_t*>(iov[i].iov_base);
+        size_t         n    = std::min(iov[i].iov_len, accepted - chunk.data.size());
+        chunk.data.insert(chunk.data.end(), base, base + n);
+    }
+
+    // The transmitter sends back to back; latency and jitter delay the arrival on top.
+    Clock::time_point now   = Clock::now();
+    Clock::time_point start = std::max(now, out.lineFree);
+    out.lineFree            = start + byteTime_ * static_cast<long long>(accepted);
+
+    std::chrono::microseconds delay(options_.latencyUs);
+    if (options_.jitterUs > 0)
+        delay += std::chrono::microseconds(out.random() % (options_.jitterUs + 1));
+
+    chunk.arrival   = std::max(start + byteTime_ + delay, out.lastArrival);
+    out.lastArrival = chunk.arrival;
+
+    out.chunks.push_back(std::move(chunk));
+    out.unread += accepted;
+    out.readable.notify_all();
+    return SerialResult::Transferred(accepted);
+}
+
+SerialResult LoopbackSerialCommunication::waitWritable(unsigned int timeoutMs) noexcept
+{
+    Pipe&                        out = channel_->pipes[1 - endpoint_];
+    std::unique_lock<std::mutex> lock(out.mutex);
+    bool ready = out.writable.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&out] { return out.unread < PIPE_CAPACITY; });
+    return ready ? SerialResult() : SerialResult::TimedOut();
+}
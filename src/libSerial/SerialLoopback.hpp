@@ -0,0 +1,62 @@
+#ifndef SERIAL_LOOPBACK_HPP
+#define SERIAL_LOOPBACK_HPP
+
+#include "Serial.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+struct LoopbackChannel;
+
+/**
+ * @brief Check whether a port name selects the in-memory loopback transport ("loop://...")
+ */
+bool IsLoopbackPortName(const std::string& portName);
+
+/**
+ * @brief SerialCommunication connected in-process to a peer endpoint, no hardware involved
+ *
+ * Port names have the form "loop://<channel>/a" and "loop://<channel>/b"; what one end
+ * writes, the other end reads. Each end can be open in one instance at a time.
+ *
+ * Delivery is paced like a USB-serial line: a byte takes (start + data + parity + stop
+ * bits) / baudRate to transmit, data becomes readable in packets of up to 64 bytes, and
+ * every write is delayed by LoopbackOptions::latencyUs plus a random 0..jitterUs. Up to
+ * 64 KiB of unread data are buffered per direction before writers see backpressure; data
+ * written while the peer is closed is lost, as on a real line.
+ *
+ * SerialReadMode minimums are honoured. NativeHandle() returns -1, so loopback ports
+ * cannot be registered with SerialReactor; SetLowLatency() has no effect.
+ */
+class LoopbackSerialCommunication : public SerialCommunication
+{
+public:
+    LoopbackSerialCommunication(const std::string& portName, uint32_t baudRate, uint8_t dataBits, uint8_t stopBits, char parity,
+                                bool enableRts, bool enableDtr, const LoopbackOptions& options);
+
+    ~LoopbackSerialCommunication() override;
+
+    SerialBackend Backend() const override;
+
+protected:
+    bool configurePort() override;
+    bool applyReadMode() override;
+
+    bool openDevice() override;
+    void closeDevice() override;
+    bool flushDevice() override;
+
+    SerialResult readDevice(void* buffer, size_t length, unsigned int timeoutMs) noexcept override;
+    SerialResult readDeviceNow(void* buffer, size_t length) noexcept override;
+    SerialResult writeDevice(const iovec* iov, size_t count) noexcept override;
+    SerialResult waitWritable(unsigned int timeoutMs) noexcept override;
+
+private:
+    LoopbackOptions                  options_;
+    std::shared_ptr<LoopbackChannel> channel_;
+    int                              endpoint_; // 0 for "/a", 1 for "/b"
+    std::chrono::nanoseconds         byteTime_; // Time on the wire per byte, 0 when not simulated
+};
+
+#endif // SERIAL_LOOPBACK_HPP
@@ -0,0 +1,52 @@
+#ifndef SERIAL_PARALLEL_HPP
+#define SERIAL_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Threads a batch call uses at most; opens and reads mostly wait on the device
+ */
+static const size_t PARALLEL_MAX_THREADS = 64;
+
+/**
+ * @brief Run task(i) for every i < count on up to maxThreads threads, the caller included
+ *
+ * Indices are handed out one at a time, so slow elements (a port that takes long to open)
+ * do not hold up the rest. When no more threads can be created, the threads already running
+ * finish the work. task must not throw.
+ * @param count Number of elements
+ * @param task Callable taking the element index
+ * @param maxThreads Threads at most, including the caller
+ */
+template <typename Task>
+void ParallelFor(size_t count, const Task& task, size_t maxThreads = PARALLEL_MAX_THREADS)
+{
+    std::atomic<size_t> next(0);
+    auto                worker = [&] {
+        for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1))
+            task(i);
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < std::min(count, maxThreads); ++t)
+    {
+        try
+        {
+            threads.emplace_back(worker);
+        }
+        catch (const std::system_error&)
+        {
+            break;
+        }
+    }
+    worker();
+    for (auto& thread : threads)
+        thread.join();
+}
+
+#endif // SERIAL_PARALLEL_HPP
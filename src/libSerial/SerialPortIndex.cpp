@@ -0,0 +1,342 @@
+#include "SerialPortIndex.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#ifdef _WIN32
+#include "PortManager.hpp"
+#else
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+SerialPortIndex& SerialPortIndex::Instance()
+{
+    static SerialPortIndex instance;
+    return instance;
+}
+
+// Orders embedded numbers by value, so that ttyUSB2 comes before ttyUSB10.
+static bool naturalLess(const std::string& a, const std::string& b)
+{
+    size_t i = 0, j = 0;
+    while (i < a.size() && j < b.size())
+    {
+        if (std::isdigit(static_cast<unsigned char>(a[i])) && std::isdigit(static_cast<unsigned char>(b[j])))
+        {
+            size_t endA = i, endB = j;
+            while (endA < a.size() && std::isdigit(static_cast<unsigned char>(a[endA])))
+                ++endA;
+            while (endB < b.size() && std::isdigit(static_cast<unsigned char>(b[endB])))
+                ++endB;
+
+            std::string numA = a.substr(i, endA - i), numB = b.substr(j, endB - j);
+            numA.erase(0, std::min(numA.find_first_not_of('0'), numA.size()));
+            numB.erase(0, std::min(numB.find_first_not_of('0'), numB.size()));
+            if (numA.size() != numB.size())
+                return numA.size() < numB.size();
+            if (numA != numB)
+                return numA < numB;
+            i = endA;
+            j = endB;
+            continue;
+        }
+        if (a[i] != b[j])
+            return a[i] < b[j];
+        ++i;
+        ++j;
+    }
+    return a.size() - i < b.size() - j;
+}
+
+#ifdef _WIN32
+
+static std::vector<SerialPortInfo> scanPorts()
+{
+    std::vector<SerialPortInfo> ports;
+    for (const std::string& name : FindPorts(0, 0))
+    {
+        SerialPortInfo info;
+        info.device = name;
+        info.name   = name;
+        ports.push_back(std::move(info));
+    }
+    return ports;
+}
+
+static bool resolvePort(const std::string&, SerialPortInfo&)
+{
+    return false;
+}
+
+#else
+
+static const std::string TTY_CLASS_DIR = "/sys/class/tty/";
+
+// First line of a sysfs attribute, "" if it does not exist.
+static std::string readAttribute(const std::string& path)
+{
+    std::ifstream file(path);
+    std::string   line;
+    std::getline(file, line);
+    while (!line.empty() && std::isspace(static_cast<unsigned char>(line.back())))
+        line.pop_back();
+    return line;
+}
+
+// Last path component of the target of a symlink, "" if it is not one.
+static std::string linkTarget(const std::string& path)
+{
+    char    target[PATH_MAX];
+    ssize_t length = readlink(path.c_str(), target, sizeof(target) - 1);
+    if (length <= 0)
+        return "";
+    target[length] = '\0';
+
+    const char* slash = std::strrchr(target, '/');
+    return slash ? slash + 1 : target;
+}
+
+static bool exists(const std::string& path)
+{
+    return access(path.c_str(), F_OK) == 0;
+}
+
+// Fills the USB fields from the interface and device directories above the port.
+static void resolveUsb(std::string path, SerialPortInfo& info)
+{
+    while (path.size() > sizeof("/sys/devices") - 1)
+    {
+        if (info.interfaceNumber < 0 && exists(path + "/bInterfaceNumber"))
+            info.interfaceNumber = static_cast<int>(std::strtol(readAttribute(path + "/bInterfaceNumber").c_str(), nullptr, 16));
+
+        if (exists(path + "/idVendor"))
+        {
+            info.vendorId     = static_cast<uint16_t>(std::strtoul(readAttribute(path + "/idVendor").c_str(), nullptr, 16));
+            info.productId    = static_cast<uint16_t>(std::strtoul(readAttribute(path + "/idProduct").c_str(), nullptr, 16));
+            info.serialNumber = readAttribute(path + "/serial");
+            info.manufacturer = readAttribute(path + "/manufacturer");
+            info.product      = readAttribute(path + "/product");
+            return;
+        }
+
+        path.erase(path.rfind('/'));
+    }
+}
+
+// Reads the port named name (as in /sys/class/tty) from sysfs; false if it is not a serial port.
+static bool resolvePort(std::string name, SerialPortInfo& info)
+{
+    std::replace(name.begin(), name.end(), '/', '!'); // sysfs spelling of '/' in names
+
+    std::string classPath = TTY_CLASS_DIR + name;
+    char        devicePath[PATH_MAX];
+    if (!realpath((classPath + "/device").c_str(), devicePath))
+        return false;
+
+    // serial_core reports PORT_UNKNOWN (0) for UART slots without hardware.
+    if (readAttribute(classPath + "/type") == "0")
+        return false;
+
+    info      = SerialPortInfo();
+    info.name = name;
+    std::replace(info.name.begin(), info.name.end(), '!', '/');
+    info.device = "/dev/" + info.name;
+
+    // Since Linux 6.5 UARTs hang below serial-base port devices; the driver is the controller's.
+    std::string hardware = devicePath;
+    while (linkTarget(hardware + "/subsystem") == "serial-base" && hardware.rfind('/') > 0)
+        hardware.erase(hardware.rfind('/'));
+    info.driver = linkTarget(hardware + "/driver");
+    resolveUsb(devicePath, info);
+    return true;
+}
+
+static std::vector<SerialPortInfo> scanPorts()
+{
+    std::vector<SerialPortInfo> ports;
+
+    DIR* dir = opendir(TTY_CLASS_DIR.c_str());
+    if (!dir)
+        return ports;
+
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr)
+    {
+        SerialPortInfo info;
+        if (entry->d_name[0] != '.' && resolvePort(entry->d_name, info))
+            ports.push_back(std::move(info));
+    }
+
+    closedir(dir);
+    return ports;
+}
+
+// Modification time of /dev in ns, -1 if it cannot be read.
+static int64_t devStamp()
+{
+    struct stat st;
+    if (stat("/dev", &st) != 0)
+        return -1;
+    return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+#endif
+
+static uint32_t vidPidKey(const SerialPortInfo& info)
+{
+    return (uint32_t(info.vendorId) << 16) | info.productId;
+}
+
+void SerialPortIndex::insert(SerialPortInfo info)
+{
+    if (info.vendorId != 0)
+        byVidPid_.emplace(vidPidKey(info), info.device);
+    std::string device = info.device;
+    ports_[device]     = std::move(info);
+}
+
+void SerialPortIndex::erase(std::unordered_map<std::string, SerialPortInfo>::iterator it)
+{
+    auto range = byVidPid_.equal_range(vidPidKey(it->second));
+    for (auto entry = range.first; entry != range.second; ++entry)
+    {
+        if (entry->second == it->first)
+        {
+            byVidPid_.erase(entry);
+            break;
+        }
+    }
+    ports_.erase(it);
+}
+
+void SerialPortIndex::refresh()
+{
+#ifdef _WIN32
+    valid_ = false; // No cheap change check, scan on every query
+#else
+    if (!live_)
+    {
+        int64_t stamp = devStamp();
+        if (stamp < 0 || stamp != devStamp_)
+            valid_ = false;
+        devStamp_ = stamp;
+    }
+#endif
+    if (valid_)
+        return;
+
+    ports_.clear();
+    byVidPid_.clear();
+    for (SerialPortInfo& info : scanPorts())
+        insert(std::move(info));
+
+    valid_ = true;
+    ++generation_;
+}
+
+// Puts ports in natural order of their names.
+static std::vector<SerialPortInfo> sortedByName(std::vector<SerialPortInfo> ports)
+{
+    std::sort(ports.begin(), ports.end(), [](const SerialPortInfo& a, const SerialPortInfo& b) { return naturalLess(a.name, b.name); });
+    return ports;
+}
+
+std::vector<SerialPortInfo> SerialPortIndex::List(uint16_t vendorId, uint16_t productId)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+
+    std::vector<SerialPortInfo> result;
+    if (vendorId != 0 && productId != 0)
+    {
+        auto range = byVidPid_.equal_range((uint32_t(vendorId) << 16) | productId);
+        for (auto it = range.first; it != range.second; ++it)
+            result.push_back(ports_.at(it->second));
+        return sortedByName(std::move(result));
+    }
+
+    for (const auto& entry : ports_)
+    {
+        const SerialPortInfo& info = entry.second;
+        if ((vendorId == 0 || info.vendorId == vendorId) && (productId == 0 || info.productId == productId))
+            result.push_back(info);
+    }
+    return sortedByName(std::move(result));
+}
+
+bool SerialPortIndex::Find(const std::string& device, SerialPortInfo& info)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+
+    auto it = ports_.find(device);
+    if (it == ports_.end())
+        return false;
+    info = it->second;
+    return true;
+}
+
+void SerialPortIndex::Invalidate()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    valid_ = false;
+}
+
+uint64_t SerialPortIndex::Generation()
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+    return generation_;
+}
+
+void SerialPortIndex::SetLive(bool live)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    live_  = live;
+    valid_ = false;
+}
+
+bool SerialPortIndex::AddPort(const std::string& name, SerialPortInfo& info)
+{
+    SerialPortInfo resolved;
+    if (!resolvePort(name, resolved))
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+
+    auto it = ports_.find(resolved.device);
+    if (it != ports_.end())
+    {
+        // Already known, e.g. found by the scan that followed the event; refresh the entry.
+        erase(it);
+        insert(resolved);
+        return false;
+    }
+
+    info = resolved;
+    insert(std::move(resolved));
+    ++generation_;
+    return true;
+}
+
+bool SerialPortIndex::RemovePort(const std::string& device, SerialPortInfo& info)
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh();
+
+    auto it = ports_.find(device);
+    if (it == ports_.end())
+        return false;
+
+    info = std::move(it->second);
+    erase(it);
+    ++generation_;
+    return true;
+}
@@ -0,0 +1,110 @@
+#ifndef SERIAL_PORT_INDEX_HPP
+#define SERIAL_PORT_INDEX_HPP
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief One serial port of the system and the identity of the device behind it
+ *
+ * The USB fields are empty (0, "" or -1) for ports that are not on a USB device.
+ */
+struct SerialPortInfo
+{
+    std::string device;               ///< Path to open, e.g. "/dev/ttyUSB0" or "COM3"
+    std::string name;                 ///< Kernel name, e.g. "ttyUSB0"
+    std::string driver;               ///< Kernel driver, e.g. "ftdi_sio", "cdc_acm"
+    uint16_t    vendorId  = 0;        ///< USB idVendor
+    uint16_t    productId = 0;        ///< USB idProduct
+    std::string serialNumber;         ///< USB iSerial string
+    std::string manufacturer;         ///< USB iManufacturer string
+    std::string product;              ///< USB iProduct string
+    int         interfaceNumber = -1; ///< USB bInterfaceNumber of the port
+};
+
+/**
+ * @brief Cached list of the serial ports of the system
+ *
+ * On Linux the ports are read from /sys/class/tty: every entry with a device link is a
+ * port (virtual consoles and ptys have none), and the USB attributes come from the sysfs
+ * directories above the device. UART ports whose type is unknown are left out: they are the
+ * placeholders of the 8250 driver, with no hardware behind them.
+ *
+ * The ports are kept in lookup tables by device path and by VID:PID. Every query costs one
+ * stat() of /dev: the ports are scanned again only when /dev has changed since the last scan
+ * (devtmpfs updates it whenever a node is added or removed) or after Invalidate(). While
+ * live, SerialHotplug keeps the tables current through AddPort() and RemovePort() and
+ * queries skip the stat() as well. On Windows the ports come from FindPorts() on every query.
+ */
+class SerialPortIndex
+{
+public:
+    /**
+     * @brief Process-wide index used by FindPorts() and the C APIs
+     */
+    static SerialPortIndex& Instance();
+
+    SerialPortIndex() = default;
+
+    SerialPortIndex(const SerialPortIndex&)            = delete;
+    SerialPortIndex& operator=(const SerialPortIndex&) = delete;
+
+    /**
+     * @brief Ports matching the filter, in natural order of their names (ttyUSB2 before ttyUSB10)
+     * @param vendorId  USB vendor ID, 0 = any
+     * @param productId USB product ID, 0 = any
+     */
+    std::vector<SerialPortInfo> List(uint16_t vendorId = 0, uint16_t productId = 0);
+
+    /**
+     * @brief Look up one port by the path it is opened with
+     * @return true and info filled if the port exists
+     */
+    bool Find(const std::string& device, SerialPortInfo& info);
+
+    /**
+     * @brief Force a scan on the next query
+     */
+    void Invalidate();
+
+    /**
+     * @brief Changes whenever the list may have changed (scans and live updates)
+     */
+    uint64_t Generation();
+
+    /**
+     * @brief Rely on AddPort()/RemovePort() instead of watching /dev; rescans on the next query
+     */
+    void SetLive(bool live);
+
+    /**
+     * @brief Add the port called name in /sys/class/tty (e.g. "ttyUSB0")
+     * @return true and info filled if the port is new to the index
+     */
+    bool AddPort(const std::string& name, SerialPortInfo& info);
+
+    /**
+     * @brief Drop the port opened as device
+     * @return true and info set to the dropped entry if the port was in the index
+     */
+    bool RemovePort(const std::string& device, SerialPortInfo& info);
+
+private:
+    // Callers of the following hold mutex_.
+    void refresh();
+    void insert(SerialPortInfo info);
+    void erase(std::unordered_map<std::string, SerialPortInfo>::iterator it);
+
+    std::mutex                                      mutex_;
+    std::unordered_map<std::string, SerialPortInfo> ports_;    // By device
+    std::unordered_multimap<uint32_t, std::string>  byVidPid_; // (vendorId << 16) | productId to device
+    bool                                            valid_      = false;
+    bool                                            live_       = false;
+    uint64_t                                        generation_ = 0;
+    int64_t                                         devStamp_   = 0; // mtime of /dev at the last scan, in ns
+};
+
+#endif // SERIAL_PORT_INDEX_HPP
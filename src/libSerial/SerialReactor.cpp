@@ -0,0 +1,475 @@
+#include "SerialReactor.hpp"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+static const int MAX_EVENTS = 64;
+
+// epoll data of a shard's own descriptors; port registrations count up from FIRST_PORT_TOKEN.
+static const uint64_t WAKE_TOKEN       = 0;
+static const uint64_t TIMER_TOKEN      = 1;
+static const uint64_t FIRST_PORT_TOKEN = 2;
+
+// Pause of a shard thread after epoll_wait failed, so a persistent error does not spin.
+static const auto LOOP_ERROR_BACKOFF = std::chrono::milliseconds(10);
+
+static uint32_t toEpoll(uint32_t events)
+{
+    uint32_t mask = 0;
+    if (events & SerialReactor::Readable)
+        mask |= EPOLLIN;
+    if (events & SerialReactor::Writable)
+        mask |= EPOLLOUT;
+    return mask;
+}
+
+static uint32_t fromEpoll(uint32_t mask)
+{
+    uint32_t events = 0;
+    if (mask & EPOLLIN)
+        events |= SerialReactor::Readable;
+    if (mask & EPOLLOUT)
+        events |= SerialReactor::Writable;
+    if (mask & (EPOLLERR | EPOLLHUP))
+        events |= SerialReactor::Error;
+    return events;
+}
+
+SerialReactor::SerialReactor(unsigned int shards, bool pinThreads) :
+    masterFd_(-1), pinThreads_(pinThreads), running_(false), nextTimerId_(1), nextToken_(FIRST_PORT_TOKEN)
+{
+    if (shards == 0)
+        shards = std::max(1u, std::thread::hardware_concurrency());
+
+    masterFd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    if (masterFd_ < 0)
+        throw std::runtime_error("epoll_create1 failed");
+
+    for (unsigned int i = 0; i < shards; ++i)
+    {
+        auto shard     = std::unique_ptr<Shard>(new Shard());
+        shard->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        shard->wakeFd  = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        shard->timerFd = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (shard->epollFd < 0 || shard->wakeFd < 0 || shard->timerFd < 0)
+        {
+            if (shard->epollFd >= 0)
+                ::close(shard->epollFd);
+            if (shard->wakeFd >= 0)
+                ::close(shard->wakeFd);
+            if (shard->timerFd >= 0)
+                ::close(shard->timerFd);
+            for (auto& s : shards_)
+            {
+                ::close(s->epollFd);
+                ::close(s->wakeFd);
+                ::close(s->timerFd);
+            }
+            ::close(masterFd_);
+            throw std::runtime_error("Failed to create reactor shard");
+        }
+
+        struct epoll_event ev{};
+        ev.events   = EPOLLIN;
+        ev.data.u64 = WAKE_TOKEN;
+        ::epoll_ctl(shard->epollFd, EPOLL_CTL_ADD, shard->wakeFd, &ev);
+
+        ev.events   = EPOLLIN;
+        ev.data.u64 = TIMER_TOKEN;
+        ::epoll_ctl(shard->epollFd, EPOLL_CTL_ADD, shard->timerFd, &ev);
+
+        ev.events   = EPOLLIN;
+        ev.data.u32 = i;
+        ::epoll_ctl(masterFd_, EPOLL_CTL_ADD, shard->epollFd, &ev);
+
+        shards_.push_back(std::move(shard));
+    }
+}
+
+SerialReactor::~SerialReactor()
+{
+    Stop();
+
+    for (auto& shard : shards_)
+    {
+        ::close(shard->epollFd);
+        ::close(shard->wakeFd);
+        ::close(shard->timerFd);
+    }
+    ::close(masterFd_);
+}
+
+bool SerialReactor::Add(const std::shared_ptr<SerialCommunication>& port, Handler handler, uint32_t events)
+{
+    if (!port || !port->IsOpen() || !handler)
+        return false;
+
+    int fd = port->NativeHandle();
+
+    std::lock_guard<std::mutex> mapLock(mapMutex_);
+    if (owners_.count(port.get()))
+        return false;
+
+    // Least loaded shard keeps the ports evenly spread over the threads.
+    Shard* target = nullptr;
+    size_t load   = 0;
+    for (auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        if (!target || shard->entries.size() < load)
+        {
+            target = shard.get();
+            load   = shard->entries.size();
+        }
+    }
+
+    auto entry     = std::make_shared<Entry>();
+    entry->port    = port;
+    entry->handler = std::move(handler);
+    entry->fd      = fd;
+
+    uint64_t token = nextToken_++;
+    {
+        std::lock_guard<std::mutex> lock(target->mutex);
+        struct epoll_event          ev{};
+        ev.events   = toEpoll(events);
+        ev.data.u64 = token;
+        if (::epoll_ctl(target->epollFd, EPOLL_CTL_ADD, fd, &ev) != 0)
+            return false;
+        target->entries[token] = entry;
+    }
+
+    owners_[port.get()] = Owner{target, token};
+    return true;
+}
+
+bool SerialReactor::Modify(const SerialCommunication& port, uint32_t events)
+{
+    Owner owner;
+    if (!ownerOf(&port, owner))
+        return false;
+
+    std::lock_guard<std::mutex> lock(owner.shard->mutex);
+    auto                        it = owner.shard->entries.find(owner.token);
+    if (it == owner.shard->entries.end() || port.NativeHandle() != it->second->fd)
+        return false;
+
+    struct epoll_event ev{};
+    ev.events   = toEpoll(events);
+    ev.data.u64 = owner.token;
+    return ::epoll_ctl(owner.shard->epollFd, EPOLL_CTL_MOD, it->second->fd, &ev) == 0;
+}
+
+bool SerialReactor::Remove(const SerialCommunication& port)
+{
+    std::lock_guard<std::mutex> mapLock(mapMutex_);
+    auto                        it = owners_.find(&port);
+    if (it == owners_.end())
+        return false;
+
+    Owner owner = it->second;
+    owners_.erase(it);
+
+    Shard*                      shard = owner.shard;
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto                        entry = shard->entries.find(owner.token);
+    if (entry == shard->entries.end())
+        return true;
+
+    // Closing the port already dropped its registration, and the descriptor number may now
+    // belong to another port: only unregister while the port still holds it.
+    if (port.NativeHandle() == entry->second->fd)
+        ::epoll_ctl(shard->epollFd, EPOLL_CTL_DEL, entry->second->fd, nullptr);
+    entry->second->active = false;
+    shard->entries.erase(entry);
+    return true;
+}
+
+size_t SerialReactor::Size() const
+{
+    std::lock_guard<std::mutex> lock(mapMutex_);
+    return owners_.size();
+}
+
+unsigned int SerialReactor::Shards() const
+{
+    return static_cast<unsigned int>(shards_.size());
+}
+
+void SerialReactor::Start()
+{
+    if (running_.exchange(true))
+        return;
+
+    for (unsigned int i = 0; i < shards_.size(); ++i)
+    {
+        Shard* shard  = shards_[i].get();
+        shard->thread = std::thread([this, shard, i] { loop(*shard, i); });
+    }
+}
+
+void SerialReactor::Stop()
+{
+    if (!running_.exchange(false))
+        return;
+
+    for (auto& shard : shards_)
+    {
+        uint64_t one = 1;
+        (void)!::write(shard->wakeFd, &one, sizeof(one));
+    }
+
+    for (auto& shard : shards_)
+    {
+        if (shard->thread.joinable())
+            shard->thread.join();
+    }
+}
+
+size_t SerialReactor::RunOnce(int timeoutMs)
+{
+    struct epoll_event ready[MAX_EVENTS];
+    int                n = ::epoll_wait(masterFd_, ready, MAX_EVENTS, timeoutMs);
+    if (n < 0)
+    {
+        if (errno == EINTR)
+            return 0;
+        throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+    }
+
+    size_t handled = 0;
+    for (int i = 0; i < n; ++i)
+        handled += dispatch(*shards_[ready[i].data.u32], 0);
+    return handled;
+}
+
+size_t SerialReactor::dispatch(Shard& shard, int timeoutMs)
+{
+    struct epoll_event ready[MAX_EVENTS];
+    int                n = ::epoll_wait(shard.epollFd, ready, MAX_EVENTS, timeoutMs);
+    if (n < 0)
+    {
+        if (errno == EINTR)
+            return 0;
+        throw std::runtime_error(std::string("epoll_wait failed: ") + std::strerror(errno));
+    }
+
+    size_t handled = 0;
+    for (int i = 0; i < n; ++i)
+    {
+        uint64_t token = ready[i].data.u64;
+        if (token == WAKE_TOKEN)
+        {
+            uint64_t value;
+            (void)!::read(shard.wakeFd, &value, sizeof(value));
+            handled += runPosted(shard);
+            continue;
+        }
+        if (token == TIMER_TOKEN)
+        {
+            uint64_t expirations;
+            (void)!::read(shard.timerFd, &expirations, sizeof(expirations));
+            handled += runTimers(shard);
+            continue;
+        }
+
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto                        it = shard.entries.find(token);
+            if (it == shard.entries.end())
+                continue;
+            entry = it->second;
+        }
+
+        // A handler earlier in this batch may have removed the port.
+        if (!entry->active)
+            continue;
+
+        SerialCommunication& port   = *entry->port;
+        uint32_t             events = fromEpoll(ready[i].events);
+        guarded(&port, [&] { entry->handler(port, events); });
+        ++handled;
+    }
+    return handled;
+}
+
+size_t SerialReactor::runPosted(Shard& shard)
+{
+    std::vector<Task> tasks;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        tasks.swap(shard.posted);
+    }
+
+    for (Task& task : tasks)
+        guarded(nullptr, task);
+    return tasks.size();
+}
+
+size_t SerialReactor::runTimers(Shard& shard)
+{
+    auto              now = std::chrono::steady_clock::now();
+    std::vector<Task> due;
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        while (!shard.timers.empty() && shard.timers.begin()->first.first <= now)
+        {
+            auto it = shard.timers.begin();
+            shard.timerIndex.erase(it->first.second);
+            due.push_back(std::move(it->second));
+            shard.timers.erase(it);
+        }
+        armTimer(shard);
+    }
+
+    // Run unlocked: a task may add or cancel timers.
+    for (Task& task : due)
+        guarded(nullptr, task);
+    return due.size();
+}
+
+// Programs the shard timerfd for the earliest pending timer. Caller holds the shard mutex.
+void SerialReactor::armTimer(Shard& shard)
+{
+    struct itimerspec spec{};
+    if (!shard.timers.empty())
+    {
+        auto since = std::chrono::duration_cast<std::chrono::nanoseconds>(shard.timers.begin()->first.first.time_since_epoch());
+        auto ns    = std::max<int64_t>(since.count(), 1);
+        spec.it_value.tv_sec  = static_cast<time_t>(ns / 1000000000);
+        spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    }
+    ::timerfd_settime(shard.timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+}
+
+void SerialReactor::Post(Task task, const SerialCommunication* affinity)
+{
+    Shard& shard = shardFor(affinity);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.posted.push_back(std::move(task));
+    }
+
+    uint64_t one = 1;
+    (void)!::write(shard.wakeFd, &one, sizeof(one));
+}
+
+SerialReactor::TimerId SerialReactor::AddTimer(std::chrono::steady_clock::time_point deadline, Task task,
+                                               const SerialCommunication* affinity)
+{
+    Shard&  shard = shardFor(affinity);
+    TimerId id    = nextTimerId_.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    TimerKey                    key(deadline, id);
+    bool                        earliest = shard.timers.empty() || key < shard.timers.begin()->first;
+    shard.timers.emplace(key, std::move(task));
+    shard.timerIndex.emplace(id, key);
+    if (earliest)
+        armTimer(shard);
+    return id;
+}
+
+bool SerialReactor::CancelTimer(TimerId id)
+{
+    for (auto& shard : shards_)
+    {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        auto                        it = shard->timerIndex.find(id);
+        if (it == shard->timerIndex.end())
+            continue;
+
+        shard->timers.erase(it->second);
+        shard->timerIndex.erase(it);
+        return true;
+    }
+    return false;
+}
+
+void SerialReactor::loop(Shard& shard, unsigned int index)
+{
+    if (pinThreads_)
+    {
+        unsigned int cpus = std::max(1u, std::thread::hardware_concurrency());
+        cpu_set_t    set;
+        CPU_ZERO(&set);
+        CPU_SET(index % cpus, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    // An exception must not leave the thread: std::thread would terminate the process.
+    while (running_)
+    {
+        if (!guarded(nullptr, [&] { dispatch(shard, -1); }))
+            std::this_thread::sleep_for(LOOP_ERROR_BACKOFF);
+    }
+}
+
+void SerialReactor::SetErrorHandler(ErrorHandler handler)
+{
+    std::lock_guard<std::mutex> lock(errorMutex_);
+    errorHandler_ = std::move(handler);
+}
+
+// The one place that catches for handlers, tasks, timers and the shard loop. A throwing
+// error handler is ignored as well, so nothing escapes onto the shard thread.
+template <typename Function>
+bool SerialReactor::guarded(const SerialCommunication* port, Function&& function) noexcept
+{
+    std::exception_ptr error;
+    try
+    {
+        function();
+        return true;
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    try
+    {
+        ErrorHandler handler;
+        {
+            std::lock_guard<std::mutex> lock(errorMutex_);
+            handler = errorHandler_;
+        }
+        if (handler)
+            handler(port, error);
+    }
+    catch (...)
+    {
+    }
+    return false;
+}
+
+bool SerialReactor::ownerOf(const SerialCommunication* port, Owner& owner) const
+{
+    std::lock_guard<std::mutex> lock(mapMutex_);
+    auto                        it = owners_.find(port);
+    if (it == owners_.end())
+        return false;
+    owner = it->second;
+    return true;
+}
+
+SerialReactor::Shard& SerialReactor::shardFor(const SerialCommunication* affinity) const
+{
+    Owner owner;
+    return affinity && ownerOf(affinity, owner) ? *owner.shard : *shards_.front();
+}
+
+#endif // _WIN32
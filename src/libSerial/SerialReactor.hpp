@@ -0,0 +1,231 @@
+#ifndef SERIAL_REACTOR_HPP
+#define SERIAL_REACTOR_HPP
+
+#ifndef _WIN32
+
+#include "Serial.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief epoll based event loop that serves many SerialCommunication ports from few threads
+ *
+ * Ports are distributed over one or more shards. Each shard owns an epoll instance and,
+ * once Start() is called, one thread. Handlers run on the shard thread that owns the port,
+ * so a given port is never serviced by two threads at the same time.
+ *
+ * Without Start(), the caller can drive every shard itself through RunOnce().
+ *
+ * To drain write queues from the loop, watch Writable while port.PendingWrite() is non-zero
+ * and call port.ProcessWritable() from the handler.
+ *
+ * Besides readiness handlers, a shard runs posted tasks and timers (one timerfd per shard),
+ * both on the thread of the shard that owns a given port, so they never race its handler.
+ *
+ * Each registration gets its own token, which is what epoll reports back: an event queued
+ * for a port that was removed never reaches a port added later, even at the same address.
+ * Exceptions thrown by handlers, tasks and timers, and failures of a started shard loop,
+ * are caught in one place and passed to the ErrorHandler; the shard keeps running.
+ */
+class SerialReactor
+{
+public:
+    /**
+     * @brief Readiness flags passed to handlers and used for registration
+     */
+    enum Events : uint32_t
+    {
+        Readable = 1u << 0,
+        Writable = 1u << 1,
+        Error    = 1u << 2
+    };
+
+    /**
+     * @brief Handler invoked on readiness
+     * @param port Port that became ready
+     * @param events Combination of Events flags
+     */
+    using Handler = std::function<void(SerialCommunication& port, uint32_t events)>;
+
+    /**
+     * @brief Task run by Post() or when a timer expires
+     */
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Identifies a timer for CancelTimer(); 0 is never a valid id
+     */
+    using TimerId = uint64_t;
+
+    /**
+     * @brief Receives what a handler, task, timer or shard loop threw
+     * @param port Port whose handler threw, nullptr for tasks, timers and the loop
+     * @param error The exception
+     */
+    using ErrorHandler = std::function<void(const SerialCommunication* port, std::exception_ptr error)>;
+
+    /**
+     * @brief Create a reactor
+     * @param shards Number of shards (threads once started); 0 selects one per hardware thread
+     * @param pinThreads Pin shard thread i to CPU i (modulo CPU count) when started
+     * @throws std::runtime_error if epoll or eventfd cannot be created
+     */
+    explicit SerialReactor(unsigned int shards = 1, bool pinThreads = false);
+
+    /**
+     * @brief Stops the shard threads and releases the epoll instances; ports are left open
+     */
+    ~SerialReactor();
+
+    SerialReactor(const SerialReactor&)            = delete;
+    SerialReactor& operator=(const SerialReactor&) = delete;
+
+    /**
+     * @brief Register an open port with the least loaded shard
+     * @param port Port to watch; the reactor keeps a reference until Remove()
+     * @param handler Callback invoked from the shard thread on readiness
+     * @param events Events to watch (Readable and/or Writable)
+     * @return true on success, false if the port is closed or already registered
+     *
+     * Registrations are tracked per port object, not per descriptor: a port closed while
+     * registered can still be removed, and a new port that reuses its descriptor number
+     * can be added.
+     */
+    bool Add(const std::shared_ptr<SerialCommunication>& port, Handler handler, uint32_t events = Readable);
+
+    /**
+     * @brief Change the events watched for a registered port
+     * @return true on success, false if the port is not registered
+     */
+    bool Modify(const SerialCommunication& port, uint32_t events);
+
+    /**
+     * @brief Unregister a port. Safe to call from inside its handler.
+     * @return true if the port was registered
+     */
+    bool Remove(const SerialCommunication& port);
+
+    /**
+     * @brief Number of ports currently registered
+     */
+    size_t Size() const;
+
+    /**
+     * @brief Number of shards
+     */
+    unsigned int Shards() const;
+
+    /**
+     * @brief Spawn one thread per shard; returns immediately
+     */
+    void Start();
+
+    /**
+     * @brief Wake and join the shard threads
+     */
+    void Stop();
+
+    /**
+     * @brief Wait for readiness on all shards and dispatch handlers from the calling thread
+     * @param timeoutMs Maximum wait in milliseconds, -1 waits forever
+     * @return Number of handler invocations
+     * @note Must not be used while the reactor is started
+     */
+    size_t RunOnce(int timeoutMs);
+
+    /**
+     * @brief Run a task on a shard thread. Thread-safe.
+     * @param task Task to run
+     * @param affinity Run on the shard serving this port (first shard when nullptr or not registered)
+     */
+    void Post(Task task, const SerialCommunication* affinity = nullptr);
+
+    /**
+     * @brief Run a task once at deadline. Thread-safe.
+     * @param deadline steady_clock time at which the task runs
+     * @param task Task to run
+     * @param affinity Run on the shard serving this port (first shard when nullptr or not registered)
+     * @return Id for CancelTimer()
+     */
+    TimerId AddTimer(std::chrono::steady_clock::time_point deadline, Task task, const SerialCommunication* affinity = nullptr);
+
+    /**
+     * @brief Cancel a timer that has not fired yet. Thread-safe.
+     * @return true if the timer was pending and will not run
+     */
+    bool CancelTimer(TimerId id);
+
+    /**
+     * @brief Set the callback that receives caught exceptions. Thread-safe.
+     *
+     * It runs on the shard thread that caught the exception; without one they are dropped.
+     */
+    void SetErrorHandler(ErrorHandler handler);
+
+private:
+    struct Entry
+    {
+        std::shared_ptr<SerialCommunication> port;
+        Handler                              handler;
+        int                                  fd = -1; // Descriptor registered with epoll
+        std::atomic<bool>                    active{true};
+    };
+
+    using TimerKey = std::pair<std::chrono::steady_clock::time_point, TimerId>;
+
+    struct Shard
+    {
+        int                                                                    epollFd = -1;
+        int                                                                    wakeFd  = -1;
+        int                                                                    timerFd = -1;
+        mutable std::mutex                                                     mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<Entry>> entries;    // Keyed by token, not by fd or port
+        std::vector<Task>                                    posted;     // Run on the next wakeup
+        std::map<TimerKey, Task>                             timers;     // Ordered by deadline
+        std::unordered_map<TimerId, TimerKey>                timerIndex; // For CancelTimer()
+        std::thread                                          thread;
+    };
+
+    struct Owner
+    {
+        Shard*   shard;
+        uint64_t token; // epoll data of the registration
+    };
+
+    size_t dispatch(Shard& shard, int timeoutMs);
+    size_t runPosted(Shard& shard);
+    size_t runTimers(Shard& shard);
+    void   armTimer(Shard& shard);
+    void   loop(Shard& shard, unsigned int index);
+    bool   ownerOf(const SerialCommunication* port, Owner& owner) const;
+    Shard& shardFor(const SerialCommunication* affinity) const;
+
+    template <typename Function>
+    bool guarded(const SerialCommunication* port, Function&& function) noexcept;
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+    int                                 masterFd_;
+    bool                                pinThreads_;
+    std::atomic<bool>                   running_;
+    std::atomic<TimerId>                nextTimerId_;
+
+    mutable std::mutex                                    mapMutex_; // Guards owners_ and nextToken_
+    std::unordered_map<const SerialCommunication*, Owner> owners_;
+    uint64_t                                              nextToken_;
+
+    std::mutex   errorMutex_;
+    ErrorHandler errorHandler_;
+};
+
+#endif // _WIN32
+
+#endif // SERIAL_REACTOR_HPP
@@ -0,0 +1,238 @@
+#include "SerialRxDispatcher.hpp"
+
+#ifndef _WIN32
+#include "SerialReactor.hpp"
+#endif
+
+#include <algorithm>
+
+// Wait of the per-port thread between checks for Unsubscribe().
+static const unsigned int THREAD_POLL_MS = 50;
+
+struct SerialRxDispatcher::Subscription
+{
+    std::shared_ptr<SerialCommunication> port;
+    Callback                             callback;
+    Access                               access;
+    std::mutex                           callMutex; // Held while reading and calling back
+    bool                                 active = true;
+    std::vector<uint8_t>                 batch;
+    std::thread                          thread;    // Ports without a descriptor only
+    std::atomic<bool>                    running{true};
+};
+
+// Subscription whose callback is running on this thread, to allow unsubscribing from inside it.
+static thread_local const void* t_delivering = nullptr;
+
+SerialRxDispatcher& SerialRxDispatcher::Instance()
+{
+    static SerialRxDispatcher instance;
+    return instance;
+}
+
+SerialRxDispatcher::SerialRxDispatcher() = default;
+
+SerialRxDispatcher::~SerialRxDispatcher()
+{
+    std::vector<std::shared_ptr<SerialCommunication>> ports;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& entry : subscriptions_)
+            ports.push_back(entry.second->port);
+    }
+
+    for (auto& port : ports)
+        Unsubscribe(*port);
+
+#ifndef _WIN32
+    reactor_.reset();
+#endif
+}
+
+bool SerialRxDispatcher::Subscribe(const std::shared_ptr<SerialCommunication>& port, Callback callback, Access access)
+{
+    if (!port || !port->IsOpen() || !callback)
+        return false;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto existing = subscriptions_.find(port.get());
+    if (existing != subscriptions_.end())
+    {
+        Subscription& subscription = *existing->second;
+        if (t_delivering == &subscription)
+        {
+            subscription.callback = std::move(callback);
+        }
+        else
+        {
+            std::lock_guard<std::mutex> callLock(subscription.callMutex);
+            subscription.callback = std::move(callback);
+        }
+        return true;
+    }
+
+    auto subscription      = std::make_shared<Subscription>();
+    subscription->port     = port;
+    subscription->callback = std::move(callback);
+    subscription->access   = std::move(access);
+    subscription->batch.resize(BATCH_SIZE);
+
+#ifndef _WIN32
+    if (port->NativeHandle() >= 0)
+    {
+        if (!reactor_)
+        {
+            reactor_.reset(new SerialReactor(1));
+            reactor_->Start();
+        }
+
+        std::weak_ptr<Subscription> weak = subscription;
+        SerialReactor*              reactor = reactor_.get();
+        bool added = reactor_->Add(port, [this, weak, reactor](SerialCommunication& ready, uint32_t events) {
+            auto current = weak.lock();
+            if (!current)
+                return;
+            // A failed or hung-up port stays readable forever and would keep the shard thread
+            // spinning; stop watching it once what it still holds has been delivered.
+            bool ok = deliver(*current);
+            if (!ok || (events & SerialReactor::Error))
+                reactor->Remove(ready);
+        });
+        if (!added)
+            return false;
+
+        subscriptions_[port.get()] = subscription;
+        return true;
+    }
+#endif
+
+    subscription->thread       = std::thread(&SerialRxDispatcher::runThread, this, subscription);
+    subscriptions_[port.get()] = subscription;
+    return true;
+}
+
+void SerialRxDispatcher::Unsubscribe(const SerialCommunication& port)
+{
+    std::shared_ptr<Subscription> subscription;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto                        it = subscriptions_.find(&port);
+        if (it == subscriptions_.end())
+            return;
+        subscription = it->second;
+        subscriptions_.erase(it);
+    }
+
+#ifndef _WIN32
+    if (reactor_ && !subscription->thread.joinable())
+        reactor_->Remove(port);
+#endif
+
+    // Wait for a callback in flight, unless we are that callback.
+    if (t_delivering == subscription.get())
+    {
+        subscription->active = false;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> callLock(subscription->callMutex);
+        subscription->active = false;
+    }
+
+    subscription->running = false;
+    if (subscription->thread.joinable())
+    {
+        if (subscription->thread.get_id() == std::this_thread::get_id())
+            subscription->thread.detach();
+        else
+            subscription->thread.join();
+    }
+}
+
+// Runs drain() inside the access function. Returns false when the port failed or is gone.
+bool SerialRxDispatcher::deliver(Subscription& subscription)
+{
+    if (!subscription.access)
+        return drain(subscription);
+
+    bool ok = false;
+    return subscription.access([&] { ok = drain(subscription); }) && ok;
+}
+
+// Drains what the port holds into one batch and hands it to the callback.
+// Returns false when the port failed.
+bool SerialRxDispatcher::drain(Subscription& subscription)
+{
+    std::lock_guard<std::mutex> callLock(subscription.callMutex);
+    if (!subscription.active)
+        return true;
+
+    size_t filled = 0;
+    bool   ok     = true;
+    while (filled < subscription.batch.size())
+    {
+        SerialResult result = subscription.port->TryReadAvailable(subscription.batch.data() + filled, subscription.batch.size() - filled);
+        ok                  = !result.Failed();
+        if (!result)
+            break;
+        filled += result.bytes;
+    }
+
+    if (filled > 0)
+    {
+        t_delivering = &subscription;
+        subscription.callback(subscription.batch.data(), filled);
+        t_delivering = nullptr;
+    }
+    return ok;
+}
+
+void SerialRxDispatcher::runThread(std::shared_ptr<Subscription> subscription)
+{
+    std::vector<uint8_t> first(subscription->batch.size());
+
+    while (subscription->running)
+    {
+        bool keep = false;
+        if (!subscription->access)
+            keep = receive(*subscription, first);
+        else if (!subscription->access([&] { keep = receive(*subscription, first); }))
+            return;
+        if (!keep)
+            return;
+    }
+}
+
+// One wait of the per-port thread and the callback for what it received.
+// Returns false when the thread should end.
+bool SerialRxDispatcher::receive(Subscription& subscription, std::vector<uint8_t>& first)
+{
+    SerialResult result = subscription.port->TryRead(first.data(), first.size(), THREAD_POLL_MS);
+    if (result.Failed())
+        return false;
+    if (!result)
+        return true;
+
+    std::lock_guard<std::mutex> callLock(subscription.callMutex);
+    if (!subscription.active)
+        return false;
+
+    // Append whatever else is already buffered to the same batch.
+    size_t filled = result.bytes;
+    std::copy(first.begin(), first.begin() + static_cast<std::ptrdiff_t>(filled), subscription.batch.begin());
+    while (filled < subscription.batch.size())
+    {
+        SerialResult more = subscription.port->TryReadAvailable(subscription.batch.data() + filled, subscription.batch.size() - filled);
+        if (more.Failed())
+            subscription.running = false;
+        if (!more)
+            break;
+        filled += more.bytes;
+    }
+
+    t_delivering = &subscription;
+    subscription.callback(subscription.batch.data(), filled);
+    t_delivering = nullptr;
+    return true;
+}
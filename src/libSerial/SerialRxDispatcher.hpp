@@ -0,0 +1,92 @@
+#ifndef SERIAL_RX_DISPATCHER_HPP
+#define SERIAL_RX_DISPATCHER_HPP
+
+#include "Serial.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifndef _WIN32
+class SerialReactor;
+#endif
+
+/**
+ * @brief Push delivery of received bytes from a library-owned I/O thread
+ *
+ * Ports with a file descriptor share one SerialReactor thread: on every readiness wakeup
+ * the port is drained into a batch buffer (several driver chunks when available) and the
+ * callback runs once with the whole batch. Ports without a descriptor (loopback, Windows)
+ * get a thread of their own that blocks in Read() and batches the same way.
+ *
+ * Once Unsubscribe() returns, the callback is not running and will not run again, unless
+ * Unsubscribe() was called from inside that very callback. Do not mix with Read() calls or
+ * a receive thread on the same port.
+ *
+ * An owner that closes ports from other threads passes an Access function: every read and
+ * the callback that follows it run inside that function, e.g. under a SerialHandleTable
+ * lease, so closing the port waits for them.
+ */
+class SerialRxDispatcher
+{
+public:
+    /**
+     * @brief Receives one batch; data is valid only during the call
+     */
+    using Callback = std::function<void(const uint8_t* data, size_t length)>;
+
+    /**
+     * @brief Runs use while the port may be read; returns false without running it once the
+     *        port is gone, which ends the subscription
+     */
+    using Access = std::function<bool(const std::function<void()>& use)>;
+
+    /**
+     * @brief Bytes collected at most per callback invocation
+     */
+    static const size_t BATCH_SIZE = 16 * 1024;
+
+    /**
+     * @brief Process-wide dispatcher used by the C API
+     */
+    static SerialRxDispatcher& Instance();
+
+    SerialRxDispatcher();
+    ~SerialRxDispatcher();
+
+    SerialRxDispatcher(const SerialRxDispatcher&)            = delete;
+    SerialRxDispatcher& operator=(const SerialRxDispatcher&) = delete;
+
+    /**
+     * @brief Deliver the data received on port to callback, replacing any previous callback
+     * @param access Guards each read and callback; none when empty. Kept from the first subscription.
+     * @return false if the port is closed or cannot be watched
+     */
+    bool Subscribe(const std::shared_ptr<SerialCommunication>& port, Callback callback, Access access = nullptr);
+
+    /**
+     * @brief Stop delivering data of port; must be called before the port is closed
+     */
+    void Unsubscribe(const SerialCommunication& port);
+
+private:
+    struct Subscription;
+
+    bool deliver(Subscription& subscription);
+    bool drain(Subscription& subscription);
+    bool receive(Subscription& subscription, std::vector<uint8_t>& first);
+    void runThread(std::shared_ptr<Subscription> subscription);
+
+    std::mutex                                                                  mutex_;
+    std::unordered_map<const SerialCommunication*, std::shared_ptr<Subscription>> subscriptions_;
+
+#ifndef _WIN32
+    std::unique_ptr<SerialReactor> reactor_; // Created on the first subscription with a descriptor
+#endif
+};
+
+#endif // SERIAL_RX_DISPATCHER_HPP
@@ -0,0 +1,180 @@
+#ifndef SERIAL_STATS_HPP
+#define SERIAL_STATS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Number of buckets of a LatencyHistogram
+ */
+static const size_t LATENCY_BUCKETS = 24;
+
+/**
+ * @brief Fixed log2 histogram of durations in microseconds
+ *
+ * Bucket 0 counts durations below 2 us, bucket i (i > 0) durations in [2^i, 2^(i+1)) us;
+ * the last bucket also takes everything longer (about 8 s and up). Recording is one
+ * relaxed atomic increment, so any thread may record while another takes a snapshot.
+ */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram()
+    {
+        Reset();
+    }
+
+    LatencyHistogram(const LatencyHistogram&)            = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void Record(std::chrono::steady_clock::duration elapsed)
+    {
+        uint64_t us = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+        size_t   bucket = us < 2 ? 0 : static_cast<size_t>(63 - __builtin_clzll(us));
+        if (bucket >= LATENCY_BUCKETS)
+            bucket = LATENCY_BUCKETS - 1;
+        buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void Snapshot(uint64_t (&out)[LATENCY_BUCKETS]) const
+    {
+        for (size_t i = 0; i < LATENCY_BUCKETS; ++i)
+            out[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+
+    void Reset()
+    {
+        for (auto& bucket : buckets_)
+            bucket.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> buckets_[LATENCY_BUCKETS];
+};
+
+/**
+ * @brief Point-in-time copy of the counters of one port
+ */
+struct SerialStatsSnapshot
+{
+    uint64_t bytesIn       = 0; ///< Bytes received from the device
+    uint64_t bytesOut      = 0; ///< Bytes handed to the device
+    uint64_t readCalls     = 0; ///< Device read operations (read(), io_uring read, ...)
+    uint64_t writeCalls    = 0; ///< Device write operations
+    uint64_t pollWakeups   = 0; ///< Waits for readiness that returned (readable or writable)
+    uint64_t timeouts      = 0; ///< Waits that ended without the port becoming ready
+    uint64_t partialWrites = 0; ///< Writes the device accepted only in part
+    uint64_t errors        = 0; ///< Device operations that failed
+    uint64_t droppedBytes  = 0; ///< Queued write bytes discarded because Close() could not send them
+
+    uint64_t readWaitUs[LATENCY_BUCKETS] = {};  ///< Time blocked in reads that may wait
+    uint64_t writeUs[LATENCY_BUCKETS]    = {};  ///< Duration of device writes
+};
+
+/**
+ * @brief Hot-path counters of one port, updated with relaxed atomics
+ *
+ * Receive and transmit counters live on separate cache lines, so a receive thread and
+ * a writer never contend on the same line.
+ */
+class SerialStats
+{
+public:
+    void RecordRead(size_t bytes, bool waited, std::chrono::steady_clock::duration elapsed)
+    {
+        rx_.calls.fetch_add(1, std::memory_order_relaxed);
+        if (bytes)
+            rx_.bytes.fetch_add(bytes, std::memory_order_relaxed);
+        if (!waited)
+            return;
+
+        rx_.wakeups.fetch_add(1, std::memory_order_relaxed);
+        if (!bytes)
+            rx_.timeouts.fetch_add(1, std::memory_order_relaxed);
+        readWait_.Record(elapsed);
+    }
+
+    void RecordWrite(size_t requested, size_t accepted, std::chrono::steady_clock::duration elapsed)
+    {
+        tx_.calls.fetch_add(1, std::memory_order_relaxed);
+        if (accepted)
+            tx_.bytes.fetch_add(accepted, std::memory_order_relaxed);
+        if (accepted < requested)
+            tx_.partial.fetch_add(1, std::memory_order_relaxed);
+        write_.Record(elapsed);
+    }
+
+    void RecordWritableWait(bool ready)
+    {
+        tx_.wakeups.fetch_add(1, std::memory_order_relaxed);
+        if (!ready)
+            tx_.timeouts.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordError()
+    {
+        errors_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void RecordDropped(size_t bytes)
+    {
+        tx_.dropped.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    SerialStatsSnapshot Snapshot() const
+    {
+        SerialStatsSnapshot s;
+        s.bytesIn       = rx_.bytes.load(std::memory_order_relaxed);
+        s.bytesOut      = tx_.bytes.load(std::memory_order_relaxed);
+        s.readCalls     = rx_.calls.load(std::memory_order_relaxed);
+        s.writeCalls    = tx_.calls.load(std::memory_order_relaxed);
+        s.pollWakeups   = rx_.wakeups.load(std::memory_order_relaxed) + tx_.wakeups.load(std::memory_order_relaxed);
+        s.timeouts      = rx_.timeouts.load(std::memory_order_relaxed) + tx_.timeouts.load(std::memory_order_relaxed);
+        s.partialWrites = tx_.partial.load(std::memory_order_relaxed);
+        s.errors        = errors_.load(std::memory_order_relaxed);
+        s.droppedBytes  = tx_.dropped.load(std::memory_order_relaxed);
+        readWait_.Snapshot(s.readWaitUs);
+        write_.Snapshot(s.writeUs);
+        return s;
+    }
+
+    void Reset()
+    {
+        rx_.Reset();
+        tx_.Reset();
+        errors_.store(0, std::memory_order_relaxed);
+        readWait_.Reset();
+        write_.Reset();
+    }
+
+private:
+    struct alignas(64) Direction
+    {
+        std::atomic<uint64_t> bytes{0};
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> wakeups{0};
+        std::atomic<uint64_t> timeouts{0};
+        std::atomic<uint64_t> partial{0};
+        std::atomic<uint64_t> dropped{0};
+
+        void Reset()
+        {
+            bytes.store(0, std::memory_order_relaxed);
+            calls.store(0, std::memory_order_relaxed);
+            wakeups.store(0, std::memory_order_relaxed);
+            timeouts.store(0, std::memory_order_relaxed);
+            partial.store(0, std::memory_order_relaxed);
+            dropped.store(0, std::memory_order_relaxed);
+        }
+    };
+
+    Direction             rx_;
+    Direction             tx_;
+    alignas(64) std::atomic<uint64_t> errors_{0};
+    LatencyHistogram      readWait_;
+    LatencyHistogram      write_;
+};
+
+#endif // SERIAL_STATS_HPP
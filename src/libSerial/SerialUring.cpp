@@ -0,0 +1,406 @@
+#include "SerialUring.hpp"
+
+#ifndef _WIN32
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include <climits>
+#include <cstring>
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static const unsigned int RING_ENTRIES = 256;
+
+// user_data layout: request index in the upper bits, bit 0 set for the linked timeout.
+static const uint64_t TIMEOUT_TAG = 1;
+
+// ReadRequest::result of a read that is still in flight.
+static const int READ_PENDING = INT_MIN;
+
+static int uringSetup(unsigned int entries, struct io_uring_params* params)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uringEnter(int fd, unsigned int submit, unsigned int wait, unsigned int flags)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_enter, fd, submit, wait, flags, nullptr, 0));
+}
+
+static int uringRegister(int fd, unsigned int opcode, void* arg, unsigned int count)
+{
+    return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+static struct __kernel_timespec deadlineFromNow(unsigned int timeoutMs)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    struct __kernel_timespec ts;
+    ts.tv_sec  = now.tv_sec + timeoutMs / 1000;
+    ts.tv_nsec = now.tv_nsec + static_cast<long long>(timeoutMs % 1000) * 1000000LL;
+    if (ts.tv_nsec >= 1000000000LL)
+    {
+        ts.tv_sec += 1;
+        ts.tv_nsec -= 1000000000LL;
+    }
+    return ts;
+}
+
+/* -------------------------------------------------------------------------- */
+/* UringRing                                                                  */
+/* -------------------------------------------------------------------------- */
+
+bool UringRing::Available()
+{
+    static const bool available = [] {
+        UringRing ring;
+        if (!ring.setup(4))
+            return false;
+
+        const unsigned int       ops = 256;
+        std::vector<uint8_t>     storage(sizeof(struct io_uring_probe) + ops * sizeof(struct io_uring_probe_op));
+        struct io_uring_probe*   probe = reinterpret_cast<struct io_uring_probe*>(storage.data());
+        if (uringRegister(ring.ringFd_, IORING_REGISTER_PROBE, probe, ops) < 0)
+            return false;
+
+        const uint8_t required[] = {IORING_OP_READ, IORING_OP_WRITEV, IORING_OP_LINK_TIMEOUT};
+        for (uint8_t op : required)
+        {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }();
+    return available;
+}
+
+UringRing* UringRing::ForThisThread()
+{
+    thread_local std::unique_ptr<UringRing> ring;
+    thread_local bool                       failed = false;
+
+    if (ring && ring->broken_)
+    {
+        ring.reset();
+        failed = true;
+    }
+
+    if (!ring && !failed)
+    {
+        std::unique_ptr<UringRing> candidate(new UringRing());
+        if (Available() && candidate->setup(RING_ENTRIES))
+            ring = std::move(candidate);
+        else
+            failed = true;
+    }
+    return ring.get();
+}
+
+UringRing::UringRing() :
+    ringFd_(-1), sqRing_(MAP_FAILED), sqRingSize_(0), cqRing_(MAP_FAILED), cqRingSize_(0), sqes_(MAP_FAILED), sqesSize_(0), sqHead_(nullptr),
+    sqTail_(nullptr), sqMask_(nullptr), sqArray_(nullptr), sqEntries_(0), pending_(0), broken_(false), cqHead_(nullptr), cqTail_(nullptr), cqMask_(nullptr),
+    cqes_(nullptr)
+{
+}
+
+UringRing::~UringRing()
+{
+    if (sqes_ != MAP_FAILED)
+        ::munmap(sqes_, sqesSize_);
+    if (cqRing_ != MAP_FAILED && cqRing_ != sqRing_)
+        ::munmap(cqRing_, cqRingSize_);
+    if (sqRing_ != MAP_FAILED)
+        ::munmap(sqRing_, sqRingSize_);
+    if (ringFd_ >= 0)
+        ::close(ringFd_);
+}
+
+bool UringRing::setup(unsigned int entries)
+{
+    struct io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+
+    ringFd_ = uringSetup(entries, &params);
+    if (ringFd_ < 0)
+        return false;
+
+    sqRingSize_ = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    cqRingSize_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    bool singleMmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMmap)
+        sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+    sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQ_RING);
+    if (sqRing_ == MAP_FAILED)
+        return false;
+
+    if (singleMmap)
+        cqRing_ = sqRing_;
+    else
+    {
+        cqRing_ = ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_CQ_RING);
+        if (cqRing_ == MAP_FAILED)
+            return false;
+    }
+
+    sqesSize_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes_     = ::mmap(nullptr, sqesSize_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd_, IORING_OFF_SQES);
+    if (sqes_ == MAP_FAILED)
+        return false;
+
+    uint8_t* sq = static_cast<uint8_t*>(sqRing_);
+    sqHead_     = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+    sqTail_     = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+    sqMask_     = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+    sqArray_    = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+    sqEntries_  = params.sq_entries;
+
+    uint8_t* cq = static_cast<uint8_t*>(cqRing_);
+    cqHead_     = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+    cqTail_     = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+    cqMask_     = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+    cqes_       = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+    return true;
+}
+
+struct io_uring_sqe* UringRing::nextSqe()
+{
+    unsigned int tail  = *sqTail_ + pending_;
+    unsigned int index = tail & *sqMask_;
+
+    struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(sqes_) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqArray_[index] = index;
+    ++pending_;
+    return sqe;
+}
+
+int UringRing::submitAndWait(unsigned int submit, unsigned int wait)
+{
+    if (submit)
+    {
+        __atomic_store_n(sqTail_, *sqTail_ + submit, __ATOMIC_RELEASE);
+        pending_ = 0;
+    }
+
+    int ret;
+    do
+    {
+        ret = uringEnter(ringFd_, submit, wait, wait ? IORING_ENTER_GETEVENTS : 0);
+        // A signal interrupting the wait must not resubmit what the kernel already took.
+        if (ret >= 0 || errno != EINTR)
+            break;
+        submit = 0;
+    } while (true);
+
+    if (ret < 0)
+    {
+        broken_ = true;
+        return -errno;
+    }
+    return ret;
+}
+
+bool UringRing::popCqe(uint64_t& userData, int& result)
+{
+    unsigned int head = *cqHead_;
+    if (head == __atomic_load_n(cqTail_, __ATOMIC_ACQUIRE))
+        return false;
+
+    const struct io_uring_cqe& cqe = cqes_[head & *cqMask_];
+    userData                       = cqe.user_data;
+    result                         = cqe.res;
+    __atomic_store_n(cqHead_, head + 1, __ATOMIC_RELEASE);
+    return true;
+}
+
+int UringRing::Read(int fd, void* buffer, size_t length, unsigned int timeoutMs)
+{
+    ReadRequest request{fd, buffer, length, 0};
+    int         ret = ReadBatch(&request, 1, timeoutMs);
+    return ret < 0 ? ret : request.result;
+}
+
+int UringRing::WriteV(int fd, const iovec* iov, size_t count)
+{
+    struct io_uring_sqe* sqe = nextSqe();
+    sqe->opcode              = IORING_OP_WRITEV;
+    sqe->fd                  = fd;
+    sqe->addr                = reinterpret_cast<uint64_t>(iov);
+    sqe->len                 = static_cast<uint32_t>(count);
+    sqe->off                 = static_cast<uint64_t>(-1);
+
+    int ret = submitAndWait(1, 1);
+    if (ret < 0)
+        return ret;
+
+    uint64_t userData;
+    int      result = -EIO;
+    while (!popCqe(userData, result))
+    {
+        ret = submitAndWait(0, 1);
+        if (ret < 0)
+            return ret;
+    }
+    return result;
+}
+
+bool UringRing::Usable() const
+{
+    return !broken_;
+}
+
+// Gives the ring's error to every read that did not complete: the unfinished ones of the
+// current pass (the first submitted) and all of the passes not submitted yet.
+static int failBatch(UringRing::ReadRequest* requests, size_t submitted, size_t count, int error)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (i >= submitted || requests[i].result == READ_PENDING)
+            requests[i].result = error;
+    }
+    return error;
+}
+
+int UringRing::ReadBatch(ReadRequest* requests, size_t count, unsigned int timeoutMs)
+{
+    // Absolute deadline: every pass and every read shares the same end time.
+    struct __kernel_timespec deadline = deadlineFromNow(timeoutMs);
+    const size_t             perPass  = sqEntries_ / 2;
+    int                      received = 0;
+
+    for (size_t first = 0; first < count; first += perPass)
+    {
+        size_t n = std::min(perPass, count - first);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            ReadRequest& request = requests[first + i];
+            request.result       = READ_PENDING;
+
+            struct io_uring_sqe* read = nextSqe();
+            read->opcode              = IORING_OP_READ;
+            read->fd                  = request.fd;
+            read->addr                = reinterpret_cast<uint64_t>(request.buffer);
+            read->len                 = static_cast<uint32_t>(request.length);
+            read->off                 = static_cast<uint64_t>(-1);
+            read->flags               = IOSQE_IO_LINK;
+            read->user_data           = static_cast<uint64_t>(i) << 1;
+
+            struct io_uring_sqe* timeout = nextSqe();
+            timeout->opcode              = IORING_OP_LINK_TIMEOUT;
+            timeout->fd                  = -1;
+            timeout->addr                = reinterpret_cast<uint64_t>(&deadline);
+            timeout->len                 = 1;
+            timeout->timeout_flags       = IORING_TIMEOUT_ABS;
+            timeout->user_data           = (static_cast<uint64_t>(i) << 1) | TIMEOUT_TAG;
+        }
+
+        int ret = submitAndWait(static_cast<unsigned int>(2 * n), 0);
+        if (ret < 0)
+            return failBatch(requests + first, n, count - first, ret);
+
+        // Buffers stay in use until every read has completed, so collect all completions.
+        size_t outstanding = 2 * n;
+        while (outstanding)
+        {
+            uint64_t userData;
+            int      result;
+            if (!popCqe(userData, result))
+            {
+                ret = submitAndWait(0, 1);
+                if (ret < 0)
+                    return failBatch(requests + first, n, count - first, ret);
+                continue;
+            }
+
+            --outstanding;
+            if (userData & TIMEOUT_TAG)
+                continue;
+
+            ReadRequest& request = requests[first + (userData >> 1)];
+            request.result       = (result == -ECANCELED || result == -EINTR) ? 0 : result;
+            if (request.result > 0)
+                ++received;
+        }
+    }
+
+    return received;
+}
+
+/* -------------------------------------------------------------------------- */
+/* UringSerialCommunication                                                   */
+/* -------------------------------------------------------------------------- */
+
+UringSerialCommunication::UringSerialCommunication(const std::string& portName, uint32_t baudRate, uint8_t dataBits, uint8_t stopBits,
+                                                   char parity, bool enableRts, bool enableDtr) :
+    SerialCommunication(portName, baudRate, dataBits, stopBits, parity, enableRts, enableDtr), pollFallback_(false)
+{
+}
+
+UringSerialCommunication::~UringSerialCommunication()
+{
+    // Stop the receive thread while readDevice() of this class is still valid to call.
+    Close();
+}
+
+SerialBackend UringSerialCommunication::Backend() const
+{
+    return pollFallback_ ? SerialBackend::Poll : SerialBackend::IoUring;
+}
+
+// Classifies a negative completion result like the poll path classifies errno.
+static SerialResult ringFailure(int result)
+{
+    bool gone = result == -EIO || result == -ENXIO || result == -ENODEV;
+    return SerialResult::Failure(gone ? SerialStatus::Disconnected : SerialStatus::IoError, -result);
+}
+
+SerialResult UringSerialCommunication::readDevice(void* buffer, size_t length, unsigned int timeoutMs) noexcept
+{
+    // The ring's non-blocking read attempt returns whatever is buffered, ignoring VMIN;
+    // only poll() waits for the minimum, so batched read modes take the poll path.
+    UringRing* ring = pollFallback_ || readMode_.minBytes > 0 ? nullptr : UringRing::ForThisThread();
+    if (!ring)
+        return SerialCommunication::readDevice(buffer, length, timeoutMs);
+
+    // A failed io_uring_enter() leaves the ring unusable; the poll path takes over then,
+    // as it does for kernels that cannot arm reads on non-blocking files.
+    int n = ring->Read(fd_, buffer, length, timeoutMs);
+    if (n == -EAGAIN || (n < 0 && !ring->Usable()))
+    {
+        pollFallback_ = true;
+        return SerialCommunication::readDevice(buffer, length, timeoutMs);
+    }
+    if (n < 0)
+        return ringFailure(n);
+
+    return SerialResult::Received(static_cast<size_t>(n));
+}
+
+SerialResult UringSerialCommunication::writeDevice(const iovec* iov, size_t count) noexcept
+{
+    UringRing* ring = UringRing::ForThisThread();
+    if (!ring)
+        return SerialCommunication::writeDevice(iov, count);
+
+    int written = ring->WriteV(fd_, iov, count);
+    if (written == -EAGAIN || written == -EINTR)
+        return SerialResult::Transferred(0);
+    if (written < 0)
+        return ringFailure(written);
+
+    return SerialResult::Transferred(static_cast<size_t>(written));
+}
+
+#endif // _WIN32
@@ -0,0 +1,146 @@
+#ifndef SERIAL_URING_HPP
+#define SERIAL_URING_HPP
+
+#ifndef _WIN32
+
+#include "Serial.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+/**
+ * @brief Minimal io_uring instance driven through raw syscalls (no liburing dependency)
+ *
+ * One ring exists per thread, created on first use, so completions never have to be
+ * handed over between threads. All ports used from a thread share its ring, which lets
+ * ReadBatch() put reads for many ports in flight with a single io_uring_enter().
+ *
+ * Only callers of ReadBatch() get that batching. UringSerialCommunication, and with it
+ * SerialReactor and SerialRxDispatcher, reads one port per io_uring_enter() through Read().
+ */
+class UringRing
+{
+public:
+    /**
+     * @brief One read of a ReadBatch() call
+     */
+    struct ReadRequest
+    {
+        int    fd;     ///< Descriptor to read from
+        void*  buffer; ///< Destination buffer
+        size_t length; ///< Capacity of buffer
+        int    result; ///< Bytes read, 0 on timeout, or -errno
+    };
+
+    /**
+     * @brief Check once whether the kernel supports the operations used here
+     */
+    static bool Available();
+
+    /**
+     * @brief Ring of the calling thread
+     *
+     * A ring whose io_uring_enter() failed is discarded here, after which the thread
+     * gets nullptr and uses the poll path.
+     * @return Ring instance, or nullptr when io_uring cannot be used
+     */
+    static UringRing* ForThisThread();
+
+    ~UringRing();
+
+    UringRing(const UringRing&)            = delete;
+    UringRing& operator=(const UringRing&) = delete;
+
+    /**
+     * @brief Read with timeout in one io_uring_enter (read linked to a timeout)
+     * @return Bytes read, 0 on timeout, or -errno (of the read, or of the ring when !Usable())
+     */
+    int Read(int fd, void* buffer, size_t length, unsigned int timeoutMs);
+
+    /**
+     * @brief Gather write in one io_uring_enter
+     * @return Bytes written or -errno
+     */
+    int WriteV(int fd, const iovec* iov, size_t count);
+
+    /**
+     * @brief False once io_uring_enter() failed; the ring is dropped by the next ForThisThread()
+     */
+    bool Usable() const;
+
+    /**
+     * @brief Read from many descriptors concurrently, sharing one deadline
+     *
+     * Takes raw descriptors, so the caller owns the fds and the per-port bookkeeping
+     * (statistics, capture, read mode) that SerialCommunication::Read() would do.
+     * @param requests Reads to perform; result is filled in for each of them
+     * @param count Number of requests
+     * @param timeoutMs Deadline relative to now, shared by every request
+     * @return Number of requests that received data, or -errno when io_uring_enter()
+     *         failed; the ring is then no longer usable and unfinished requests carry the error
+     */
+    int ReadBatch(ReadRequest* requests, size_t count, unsigned int timeoutMs);
+
+private:
+    UringRing();
+    bool setup(unsigned int entries);
+
+    io_uring_sqe* nextSqe();
+    int           submitAndWait(unsigned int submit, unsigned int wait);
+    bool          popCqe(uint64_t& userData, int& result);
+
+    int ringFd_;
+
+    void*  sqRing_;
+    size_t sqRingSize_;
+    void*  cqRing_;
+    size_t cqRingSize_;
+    void*  sqes_;
+    size_t sqesSize_;
+
+    unsigned int* sqHead_;
+    unsigned int* sqTail_;
+    unsigned int* sqMask_;
+    unsigned int* sqArray_;
+    unsigned int  sqEntries_;
+    unsigned int  pending_;
+    bool          broken_;
+
+    unsigned int* cqHead_;
+    unsigned int* cqTail_;
+    unsigned int* cqMask_;
+    io_uring_cqe* cqes_;
+};
+
+/**
+ * @brief SerialCommunication whose Read/Write go through the calling thread's UringRing
+ *
+ * Each Read costs one io_uring_enter instead of poll() followed by read(). When the
+ * kernel reports EAGAIN for a read (kernels without poll-armed reads on non-blocking
+ * files) or the ring itself fails, the instance switches to the poll path for good. Reads with a SerialReadMode
+ * minimum also use the poll path, since only poll() honours VMIN.
+ */
+class UringSerialCommunication : public SerialCommunication
+{
+public:
+    UringSerialCommunication(const std::string& portName, uint32_t baudRate, uint8_t dataBits, uint8_t stopBits, char parity, bool enableRts,
+                             bool enableDtr);
+    ~UringSerialCommunication() override;
+
+    SerialBackend Backend() const override;
+
+protected:
+    SerialResult readDevice(void* buffer, size_t length, unsigned int timeoutMs) noexcept override;
+    SerialResult writeDevice(const iovec* iov, size_t count) noexcept override;
+
+private:
+    std::atomic<bool> pollFallback_;
+};
+
+#endif // _WIN32
+
+#endif // SERIAL_URING_HPP
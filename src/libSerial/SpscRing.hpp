@@ -0,0 +1,135 @@
+#ifndef SPSC_RING_HPP
+#define SPSC_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief Read-only view over contiguous bytes (stand-in for std::span<const uint8_t> in C++17)
+ */
+struct ByteSpan
+{
+    const uint8_t* data = nullptr; ///< First byte of the region
+    size_t         size = 0;       ///< Number of bytes in the region
+};
+
+/**
+ * @brief Lock-free single-producer/single-consumer byte ring
+ *
+ * One thread fills the ring through WritableRegion()/CommitWrite(), another drains it
+ * through ReadableRegion()/Consume(). Regions are contiguous, so data can be read from
+ * the device straight into the ring and parsed straight out of it without extra copies.
+ * Indices grow monotonically; the capacity is rounded up to a power of two.
+ */
+class SpscRing
+{
+public:
+    /**
+     * @brief Mutable region returned to the producer
+     */
+    struct Region
+    {
+        uint8_t* data = nullptr;
+        size_t   size = 0;
+    };
+
+    explicit SpscRing(size_t capacity) : capacity_(roundUp(capacity)), mask_(capacity_ - 1), buffer_(new uint8_t[capacity_]), head_(0), tail_(0)
+    {
+    }
+
+    SpscRing(const SpscRing&)            = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Producer side: largest contiguous free region
+     */
+    Region WritableRegion() const
+    {
+        size_t tail   = tail_.load(std::memory_order_relaxed);
+        size_t head   = head_.load(std::memory_order_acquire);
+        size_t free   = capacity_ - (tail - head);
+        size_t offset = tail & mask_;
+
+        Region region;
+        region.data = buffer_.get() + offset;
+        region.size = free < capacity_ - offset ? free : capacity_ - offset;
+        return region;
+    }
+
+    /**
+     * @brief Producer side: publish bytes written into the last WritableRegion()
+     */
+    void CommitWrite(size_t count)
+    {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Consumer side: largest contiguous readable region
+     */
+    ByteSpan ReadableRegion() const
+    {
+        size_t head   = head_.load(std::memory_order_relaxed);
+        size_t tail   = tail_.load(std::memory_order_acquire);
+        size_t used   = tail - head;
+        size_t offset = head & mask_;
+
+        ByteSpan span;
+        span.data = buffer_.get() + offset;
+        span.size = used < capacity_ - offset ? used : capacity_ - offset;
+        return span;
+    }
+
+    /**
+     * @brief Consumer side: release bytes obtained from ReadableRegion()
+     */
+    void Consume(size_t count)
+    {
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Bytes currently stored (exact only from the producer or consumer thread)
+     */
+    size_t Size() const
+    {
+        return tail_.load(std::memory_order_seq_cst) - head_.load(std::memory_order_seq_cst);
+    }
+
+    /**
+     * @brief Total capacity in bytes
+     */
+    size_t Capacity() const
+    {
+        return capacity_;
+    }
+
+    /**
+     * @brief Consumer side: drop every byte published so far
+     */
+    void Clear()
+    {
+        head_.store(tail_.load(std::memory_order_acquire), std::memory_order_seq_cst);
+    }
+
+private:
+    static size_t roundUp(size_t value)
+    {
+        size_t capacity = 64;
+        while (capacity < value)
+            capacity <<= 1;
+        return capacity;
+    }
+
+    const size_t               capacity_;
+    const size_t               mask_;
+    std::unique_ptr<uint8_t[]> buffer_;
+
+    // Producer and consumer indices on separate cache lines to avoid false sharing.
+    alignas(64) std::atomic<size_t> head_;
+    alignas(64) std::atomic<size_t> tail_;
+};
+
+#endif // SPSC_RING_HPP
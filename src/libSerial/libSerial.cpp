@@ -1,13 +1,91 @@
 #include "libSerial.h"
 #include "Serial.hpp"
+#include "SerialHandleTable.hpp"
+#include "SerialHotplug.hpp"
+#include "SerialParallel.hpp"
+#include "SerialPortIndex.hpp"
+#include "SerialRxDispatcher.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <vector>
 #include <memory>
 #include <cstring>
+#include <cstddef>
+#include <cstdlib>
 #include <stdexcept>
+#include <thread>
+#include <unordered_map>
 
-// Static vector holding instances of SerialCommunication
-static std::vector<std::shared_ptr<SerialCommunication>> s_instances;
+// SerialCommIoVec is handed to SerialCommunication::WriteV as an iovec array
+static_assert(sizeof(SerialCommIoVec) == sizeof(iovec), "SerialCommIoVec must match iovec");
+static_assert(offsetof(SerialCommIoVec, base) == offsetof(iovec, iov_base), "SerialCommIoVec must match iovec");
+static_assert(offsetof(SerialCommIoVec, length) == offsetof(iovec, iov_len), "SerialCommIoVec must match iovec");
+
+static_assert(SERIAL_COMM_HISTOGRAM_BUCKETS == LATENCY_BUCKETS, "SerialCommStats histograms must match LatencyHistogram");
+
+// Instances of SerialCommunication by instance ID
+static SerialHandleTable s_instances;
+
+// errno of the last failed call on this thread, see SerialCommGetLastSystemError
+static thread_local int t_lastSystemError = 0;
+
+// Instance whose receive callback runs on this thread under a lease, -1 outside callbacks.
+// Close, Open and Deinit need the exclusive lease and would wait for this thread forever.
+static thread_local int t_callbackInstance = -1;
+
+// Maps a failed result to the C error codes and remembers its system error code.
+static SerialCommError failureOf(const SerialResult &result)
+{
+    t_lastSystemError = result.sysError;
+    switch (result.status)
+    {
+        case SerialStatus::Ok:              return SCErrorNone;
+        case SerialStatus::Timeout:         return SCErrorTimeout;
+        case SerialStatus::NotOpen:         return SCErrorNotOpen;
+        case SerialStatus::IoError:         return SCErrorIoFailed;
+        case SerialStatus::Disconnected:    return SCErrorDisconnected;
+        case SerialStatus::InvalidArgument: return SCErrorInvalidFormat;
+    }
+    return SCErrorIoFailed;
+}
+
+// Leases the ports of a batch for I/O, nullptr for invalid IDs. An ID listed twice is leased
+// once and shares the port, since a thread must not hold two leases of the same port.
+static std::vector<SerialCommunication *> usePorts(const int *instanceIds, size_t count,
+                                                   std::vector<SerialHandleTable::SharedLease> &leases)
+{
+    std::vector<SerialCommunication *>             ports(count, nullptr);
+    std::unordered_map<int, SerialCommunication *> leased;
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto found = leased.find(instanceIds[i]);
+        if (found != leased.end())
+        {
+            ports[i] = found->second;
+            continue;
+        }
+
+        SerialHandleTable::SharedLease lease = s_instances.Use(instanceIds[i]);
+        if (lease)
+        {
+            ports[i] = &*lease;
+            leases.push_back(std::move(lease));
+        }
+        leased[instanceIds[i]] = ports[i];
+    }
+    return ports;
+}
+
+// Copies text to cursor and advances it; used to place the strings of a list after its array.
+static char *packString(char *&cursor, const std::string &text)
+{
+    char *start = cursor;
+    std::memcpy(cursor, text.c_str(), text.size() + 1);
+    cursor += text.size() + 1;
+    return start;
+}
 
 extern "C"
 {
@@ -15,7 +93,7 @@ extern "C"
 /**
  * @brief Lists available serial ports, optionally filtered by USB Vendor ID and Product ID.
  *
- * Currently not implemented (TODO).
+ * The names and the array share one allocation, released by SerialCommFreePortList.
  *
  * @param vendorId USB Vendor ID filter (0 disables filtering).
  * @param productId USB Product ID filter (0 disables filtering).
@@ -24,12 +102,145 @@ extern "C"
 BSC_SDK_EXPORT SerialCommPortList SerialCommListPorts(uint16_t vendorId, uint16_t productId)
 {
     SerialCommPortList list{};
-    // TODO: implement port enumeration
-    (void)vendorId; // to avoid unused parameter warning
-    (void)productId;
+
+    auto   ports = SerialPortIndex::Instance().List(vendorId, productId);
+    size_t size  = ports.size() * sizeof(char *);
+    for (const auto &info : ports)
+        size += info.device.size() + 1;
+    if (ports.empty())
+        return list;
+
+    list.ports = static_cast<char **>(std::malloc(size));
+    if (!list.ports)
+        return list;
+
+    char *cursor = reinterpret_cast<char *>(list.ports + ports.size());
+    for (const auto &info : ports)
+        list.ports[list.count++] = packString(cursor, info.device);
     return list;
 }
 
+/**
+ * @brief Releases a list returned by SerialCommListPorts.
+ *
+ * @param list List to release and reset (may be NULL).
+ */
+BSC_SDK_EXPORT void SerialCommFreePortList(SerialCommPortList *list)
+{
+    if (!list)
+        return;
+    std::free(list->ports);
+    *list = SerialCommPortList{};
+}
+
+/**
+ * @brief Lists available serial ports with their USB attributes.
+ *
+ * The entries and their strings share one allocation, released by SerialCommFreePortInfoList.
+ *
+ * @param vendorId USB Vendor ID filter (0 disables filtering).
+ * @param productId USB Product ID filter (0 disables filtering).
+ * @return SerialCommPortInfoList Structure containing the list of ports found.
+ */
+BSC_SDK_EXPORT SerialCommPortInfoList SerialCommListPortInfo(uint16_t vendorId, uint16_t productId)
+{
+    SerialCommPortInfoList list{};
+
+    auto   ports = SerialPortIndex::Instance().List(vendorId, productId);
+    size_t size  = ports.size() * sizeof(SerialCommPortInfo);
+    for (const auto &info : ports)
+        size += info.device.size() + info.name.size() + info.driver.size() + info.serialNumber.size() + info.manufacturer.size() +
+                info.product.size() + 6;
+    if (ports.empty())
+        return list;
+
+    list.ports = static_cast<SerialCommPortInfo *>(std::malloc(size));
+    if (!list.ports)
+        return list;
+
+    char *cursor = reinterpret_cast<char *>(list.ports + ports.size());
+    for (const auto &info : ports)
+    {
+        SerialCommPortInfo &entry = list.ports[list.count++];
+        entry.device              = packString(cursor, info.device);
+        entry.name                = packString(cursor, info.name);
+        entry.driver              = packString(cursor, info.driver);
+        entry.serialNumber        = packString(cursor, info.serialNumber);
+        entry.manufacturer        = packString(cursor, info.manufacturer);
+        entry.product             = packString(cursor, info.product);
+        entry.vendorId            = info.vendorId;
+        entry.productId           = info.productId;
+        entry.interfaceNumber     = info.interfaceNumber;
+    }
+    return list;
+}
+
+/**
+ * @brief Releases a list returned by SerialCommListPortInfo.
+ *
+ * @param list List to release and reset (may be NULL).
+ */
+BSC_SDK_EXPORT void SerialCommFreePortInfoList(SerialCommPortInfoList *list)
+{
+    if (!list)
+        return;
+    std::free(list->ports);
+    *list = SerialCommPortInfoList{};
+}
+
+/**
+ * @brief Starts reporting ports that are plugged in or out.
+ *
+ * @param vendorId USB Vendor ID filter (0 disables filtering).
+ * @param productId USB Product ID filter (0 disables filtering).
+ * @param callback Function called from the monitor thread for each event.
+ * @param userData Opaque pointer passed to the callback.
+ * @return int Watch ID, 0 if the monitor cannot run.
+ */
+BSC_SDK_EXPORT int SerialCommWatchPorts(uint16_t vendorId, uint16_t productId, SerialCommPortEventCallback callback, void *userData)
+{
+    if (!callback)
+        return 0;
+
+    return SerialHotplug::Instance().Subscribe(
+        [callback, userData](SerialHotplug::Event event, const SerialPortInfo &info) {
+            SerialCommPortInfo port;
+            port.device          = info.device.c_str();
+            port.name            = info.name.c_str();
+            port.driver          = info.driver.c_str();
+            port.serialNumber    = info.serialNumber.c_str();
+            port.manufacturer    = info.manufacturer.c_str();
+            port.product         = info.product.c_str();
+            port.vendorId        = info.vendorId;
+            port.productId       = info.productId;
+            port.interfaceNumber = info.interfaceNumber;
+            callback(event == SerialHotplug::Event::Added ? SCPortAdded : SCPortRemoved, &port, userData);
+        },
+        vendorId, productId);
+}
+
+/**
+ * @brief Stops a watch started by SerialCommWatchPorts.
+ *
+ * @param watchId ID returned by SerialCommWatchPorts.
+ */
+BSC_SDK_EXPORT void SerialCommUnwatchPorts(int watchId)
+{
+    SerialHotplug::Instance().Unsubscribe(watchId);
+}
+
+/**
+ * @brief Looks a port up in the port index.
+ *
+ * @param device Port path.
+ * @return true if the port exists.
+ */
+BSC_SDK_EXPORT bool SerialCommPortExists(const char *device)
+{
+    SerialPortInfo info;
+    return device && SerialPortIndex::Instance().Find(device, info);
+}
+
 /**
  * @brief Initializes and creates a configured SerialCommunication instance.
  *
@@ -43,7 +254,7 @@ BSC_SDK_EXPORT SerialCommPortList SerialCommListPorts(uint16_t vendorId, uint16_
  * @param enableDtr Enable DTR line.
  * @param portSerial Serial port name (e.g., "COM3" or "/dev/ttyUSB0").
  * @param outError Optional pointer to receive error code.
- * @return int Instance ID (index in vector) or -1 on failure.
+ * @return int Instance ID or -1 on failure.
  */
 BSC_SDK_EXPORT int SerialCommInit(uint32_t baudRate, uint8_t dataBits, uint8_t stopBits, char parity,
                                  bool enableRts, bool enableDtr, const char *portSerial, SerialCommError *outError)
@@ -63,23 +274,70 @@ BSC_SDK_EXPORT int SerialCommInit(uint32_t baudRate, uint8_t dataBits, uint8_t s
         return -1;
     }
 
-    // Reuse empty slots if any
-    for (size_t i = 0; i < s_instances.size(); ++i)
+    int instanceId = s_instances.Insert(inst);
+    if (outError)
+        *outError = instanceId < 0 ? SCErrorOpenFailed : SCErrorNone;
+    return instanceId;
+}
+
+/**
+ * @brief Creates several instances, opening and configuring the ports in parallel.
+ *
+ * @param configs Port settings, one per instance.
+ * @param count Number of elements in configs.
+ * @param outIds Receives the instance ID of each element, -1 on failure.
+ * @param outErrors Optional, receives the error code of each element.
+ * @return size_t Number of instances created.
+ */
+BSC_SDK_EXPORT size_t SerialCommInitMany(const SerialCommPortConfig *configs, size_t count, int *outIds, SerialCommError *outErrors)
+{
+    if (!configs || !outIds)
+        return 0;
+
+    std::vector<std::shared_ptr<SerialCommunication>> created(count);
+    ParallelFor(count, [&](size_t i) {
+        const SerialCommPortConfig &config = configs[i];
+        if (config.portSerial)
+            created[i] = SerialCommunication::Create(config.portSerial, config.baudRate, config.dataBits, config.stopBits,
+                                                     config.parity, config.enableRts, config.enableDtr);
+    });
+
+    size_t opened = 0;
+    for (size_t i = 0; i < count; ++i)
     {
-        if (!s_instances[i])
+        SerialCommError error = SCErrorNone;
+        if (!configs[i].portSerial)
+            error = SCErrorInvalidFormat;
+        else if (!created[i])
+            error = SCErrorPortNotFound;
+
+        outIds[i] = -1;
+        if (error == SCErrorNone && (outIds[i] = s_instances.Insert(created[i])) < 0)
+            error = SCErrorOpenFailed;
+        if (outErrors)
+            outErrors[i] = error;
+        if (error == SCErrorNone)
+            ++opened;
+    }
+    return opened;
+}
+
+// Stops push delivery before Close or Deinit take the exclusive lease: a callback in flight
+// holds a lease of its own and may call into this API with it.
+static void unsubscribe(int instanceId)
+{
+    std::shared_ptr<SerialCommunication> port;
+    {
+        auto inst = s_instances.Use(instanceId);
+        if (inst)
         {
-            s_instances[i] = inst;
-            if (outError)
-                *outError = SCErrorNone;
-            return static_cast<int>(i);
+            port = inst.Port();
         }
     }
-
-    // Otherwise, add at the end
-    s_instances.push_back(inst);
-    if (outError)
-        *outError = SCErrorNone;
-    return static_cast<int>(s_instances.size() - 1);
+    if (port)
+    {
+        SerialRxDispatcher::Instance().Unsubscribe(*port);
+    }
 }
 
 /**
@@ -90,12 +348,20 @@ BSC_SDK_EXPORT int SerialCommInit(uint32_t baudRate, uint8_t dataBits, uint8_t s
  */
 BSC_SDK_EXPORT SerialCommError SerialCommClose(int instanceId)
 {
-    if (instanceId < 0 || static_cast<size_t>(instanceId) >= s_instances.size() || !s_instances[instanceId])
+    if (instanceId == t_callbackInstance)
     {
         return SCErrorInvalidFormat;
     }
 
-    s_instances[instanceId]->Close();
+    unsubscribe(instanceId);
+    auto inst = s_instances.Own(instanceId);
+    if (!inst)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    SerialRxDispatcher::Instance().Unsubscribe(*inst);
+    inst->Close();
     return SCErrorNone;
 }
 
@@ -107,13 +373,21 @@ BSC_SDK_EXPORT SerialCommError SerialCommClose(int instanceId)
  */
 BSC_SDK_EXPORT SerialCommError SerialCommDeinit(int instanceId)
 {
-    if (instanceId < 0 || static_cast<size_t>(instanceId) >= s_instances.size() || !s_instances[instanceId])
+    if (instanceId == t_callbackInstance)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    unsubscribe(instanceId);
+    auto inst = s_instances.Own(instanceId);
+    if (!inst)
     {
         return SCErrorInvalidFormat;
     }
 
-    s_instances[instanceId]->Close();
-    s_instances[instanceId].reset();
+    SerialRxDispatcher::Instance().Unsubscribe(*inst);
+    inst->Close();
+    s_instances.Remove(inst);
     return SCErrorNone;
 }
 
@@ -125,12 +399,18 @@ BSC_SDK_EXPORT SerialCommError SerialCommDeinit(int instanceId)
  */
 BSC_SDK_EXPORT SerialCommError SerialCommOpen(int instanceId)
 {
-    if (instanceId < 0 || static_cast<size_t>(instanceId) >= s_instances.size() || !s_instances[instanceId])
+    if (instanceId == t_callbackInstance)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    auto inst = s_instances.Own(instanceId);
+    if (!inst)
     {
         return SCErrorInvalidFormat;
     }
 
-    return s_instances[instanceId]->Open() ? SCErrorNone : SCErrorOpenFailed;
+    return inst->Open() ? SCErrorNone : SCErrorOpenFailed;
 }
 
 /**
@@ -144,26 +424,116 @@ BSC_SDK_EXPORT SerialCommError SerialCommOpen(int instanceId)
  */
 BSC_SDK_EXPORT size_t SerialCommWrite(int instanceId, const void *buffer, size_t length, SerialCommError *outError)
 {
-    if (instanceId < 0 || static_cast<size_t>(instanceId) >= s_instances.size() ||
-        !s_instances[instanceId] || !buffer || length == 0)
+    auto inst = s_instances.Use(instanceId);
+    if (!inst || !buffer || length == 0)
     {
         if (outError)
             *outError = SCErrorInvalidFormat;
         return 0;
     }
 
-    try
+    SerialResult result = inst->TryWrite(buffer, length);
+    if (outError)
+        *outError = result ? SCErrorNone : failureOf(result);
+    return result ? result.bytes : 0;
+}
+
+/**
+ * @brief Writes several segments to the serial port of the specified instance in one call.
+ *
+ * @param instanceId Instance ID.
+ * @param segments Array of segments to write in order.
+ * @param count Number of segments.
+ * @param outError Optional pointer to receive error code.
+ * @return size_t Total number of bytes written (0 on failure).
+ */
+BSC_SDK_EXPORT size_t SerialCommWriteV(int instanceId, const SerialCommIoVec *segments, size_t count, SerialCommError *outError)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst || !segments || count == 0)
     {
-        s_instances[instanceId]->Write(buffer, length);
         if (outError)
-            *outError = SCErrorNone;
-        return length;
+            *outError = SCErrorInvalidFormat;
+        return 0;
+    }
+
+    SerialResult result = inst->TryWriteV(reinterpret_cast<const iovec *>(segments), count);
+    if (outError)
+        *outError = result ? SCErrorNone : failureOf(result);
+    return result ? result.bytes : 0;
+}
+
+/**
+ * @brief Writes one buffer to each of several instances in parallel.
+ *
+ * @param instanceIds Instance IDs.
+ * @param buffers Data for the instance at the same index.
+ * @param count Number of elements.
+ * @param outWritten Optional, receives the bytes written per element.
+ * @param outErrors Optional, receives the error code per element.
+ * @return size_t Number of elements written completely.
+ */
+BSC_SDK_EXPORT size_t SerialCommWriteMany(const int *instanceIds, const SerialCommIoVec *buffers, size_t count,
+                                          size_t *outWritten, SerialCommError *outErrors)
+{
+    if (!instanceIds || !buffers)
+        return 0;
+
+    std::vector<SerialHandleTable::SharedLease> leases;
+    std::vector<SerialCommunication *>          targets = usePorts(instanceIds, count, leases);
+
+    std::atomic<size_t> completed(0);
+    ParallelFor(count, [&](size_t i) {
+        SerialCommError error   = SCErrorNone;
+        size_t          written = 0;
+        if (!targets[i] || !buffers[i].base || buffers[i].length == 0)
+        {
+            error = SCErrorInvalidFormat;
+        }
+        else
+        {
+            SerialResult result = targets[i]->TryWrite(buffers[i].base, buffers[i].length);
+            if (result)
+            {
+                written = result.bytes;
+                completed.fetch_add(1);
+            }
+            else
+            {
+                error = failureOf(result);
+            }
+        }
+
+        if (outWritten)
+            outWritten[i] = written;
+        if (outErrors)
+            outErrors[i] = error;
+    });
+    return completed.load();
+}
+
+/**
+ * @brief Waits until the write queue of the specified instance is empty.
+ *
+ * @param instanceId Instance ID.
+ * @param timeoutMs Maximum wait in milliseconds.
+ * @return SerialCommError Error code, SCErrorNone if the queue drained.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommDrain(int instanceId, uint32_t timeoutMs)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    try
+    {
+        return inst->DrainWrites(timeoutMs) ? SCErrorNone : SCErrorNoData;
     }
     catch (const std::runtime_error &)
     {
-        if (outError)
-            *outError = SCErrorOpenFailed;
-        return 0;
+        return SCErrorIoFailed;
     }
 }
 
@@ -178,51 +548,305 @@ BSC_SDK_EXPORT size_t SerialCommWrite(int instanceId, const void *buffer, size_t
  */
 BSC_SDK_EXPORT size_t SerialCommRead(int instanceId, void *buffer, size_t length, SerialCommError *outError)
 {
-    if (instanceId < 0 || static_cast<size_t>(instanceId) >= s_instances.size() ||
-        !s_instances[instanceId] || !buffer || length == 0)
+    auto inst = s_instances.Use(instanceId);
+    if (!inst || !buffer || length == 0)
     {
         if (outError)
             *outError = SCErrorInvalidFormat;
         return 0;
     }
 
-    try
+    // A timeout is not an error here: 0 bytes and SCErrorNone.
+    SerialResult result = inst->TryRead(buffer, length, 1000);
+    if (outError)
+        *outError = result.Failed() ? failureOf(result) : SCErrorNone;
+    return result.Failed() ? 0 : result.bytes;
+}
+
+/**
+ * @brief Reads from several instances concurrently, all waiting until the same deadline.
+ *
+ * @param instanceIds Instance IDs.
+ * @param buffers Destination for the instance at the same index.
+ * @param count Number of elements.
+ * @param timeoutMs Time from the call until the shared deadline.
+ * @param outRead Receives the bytes read per element.
+ * @param outErrors Optional, receives the error code per element; SCErrorNoData if nothing arrived.
+ * @return size_t Number of elements that received data.
+ */
+BSC_SDK_EXPORT size_t SerialCommReadMany(const int *instanceIds, const SerialCommBuffer *buffers, size_t count,
+                                         uint32_t timeoutMs, size_t *outRead, SerialCommError *outErrors)
+{
+    if (!instanceIds || !buffers || !outRead)
+        return 0;
+
+    std::vector<SerialHandleTable::SharedLease> leases;
+    std::vector<SerialCommunication *>          sources = usePorts(instanceIds, count, leases);
+
+    auto                deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    std::atomic<size_t> received(0);
+    ParallelFor(count, [&](size_t i) {
+        SerialCommError error = SCErrorNone;
+        size_t          bytes = 0;
+        if (!sources[i] || !buffers[i].base || buffers[i].length == 0)
+        {
+            error = SCErrorInvalidFormat;
+        }
+        else
+        {
+            // Elements picked up late still wait only for what is left until the deadline.
+            auto         left   = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+            unsigned int waitMs = left.count() > 0 ? static_cast<unsigned int>(left.count()) : 0;
+            SerialResult result = waitMs > 0 ? sources[i]->TryRead(buffers[i].base, buffers[i].length, waitMs)
+                                             : sources[i]->TryReadAvailable(buffers[i].base, buffers[i].length);
+            if (result)
+            {
+                bytes = result.bytes;
+                received.fetch_add(1);
+            }
+            else
+            {
+                error = result.Failed() ? failureOf(result) : SCErrorNoData;
+            }
+        }
+
+        outRead[i] = bytes;
+        if (outErrors)
+            outErrors[i] = error;
+    });
+    return received.load();
+}
+
+/**
+ * @brief Reads exactly length bytes from the specified instance within one overall timeout.
+ *
+ * @param instanceId Instance ID.
+ * @param buffer Buffer to store the data.
+ * @param length Number of bytes wanted.
+ * @param timeoutMs Total timeout in milliseconds.
+ * @param outError Pointer to error code, SCErrorNoData if the data was incomplete.
+ * @return size_t Number of bytes read.
+ */
+BSC_SDK_EXPORT size_t SerialCommReadExact(int instanceId, void *buffer, size_t length, uint32_t timeoutMs, SerialCommError *outError)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst || !buffer || length == 0)
     {
-        size_t bytes = s_instances[instanceId]->Read(buffer, length, 1000);
         if (outError)
-            *outError = SCErrorNone;
-        return bytes;
+            *outError = SCErrorInvalidFormat;
+        return 0;
     }
-    catch (const std::runtime_error &)
+
+    auto         deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    SerialResult result   = inst->TryReadExact(buffer, length, deadline);
+    if (outError)
+        *outError = result ? SCErrorNone : result.Failed() ? failureOf(result) : SCErrorNoData;
+    return result.bytes;
+}
+
+/**
+ * @brief Reads up to and including a delimiter from the specified instance within one overall timeout.
+ *
+ * @param instanceId Instance ID.
+ * @param buffer Buffer to store the data.
+ * @param maxLength Capacity of the buffer.
+ * @param delimiter Byte that ends the read.
+ * @param timeoutMs Total timeout in milliseconds.
+ * @param outError Pointer to error code, SCErrorNoData if the delimiter was not received.
+ * @return size_t Number of bytes stored.
+ */
+BSC_SDK_EXPORT size_t SerialCommReadUntil(int instanceId, void *buffer, size_t maxLength, uint8_t delimiter, uint32_t timeoutMs,
+                                         SerialCommError *outError)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst || !buffer || maxLength == 0)
     {
         if (outError)
-            *outError = SCErrorNoData;
+            *outError = SCErrorInvalidFormat;
         return 0;
     }
+
+    auto         deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    SerialResult result   = inst->TryReadUntil(buffer, maxLength, delimiter, deadline);
+    bool         found    = result.bytes > 0 && static_cast<const uint8_t *>(buffer)[result.bytes - 1] == delimiter;
+    if (outError)
+        *outError = result.Failed() ? failureOf(result) : found ? SCErrorNone : SCErrorNoData;
+    return result.bytes;
 }
 
 /**
- * @brief Flushes input and output buffers of the specified instance.
+ * @brief Sets the VMIN/VTIME read mode of the specified instance.
  *
  * @param instanceId Instance ID.
+ * @param minBytes Bytes to collect before a read completes.
+ * @param interByteTimeout Inter-byte timer in tenths of a second.
  * @return SerialCommError Error code, SCErrorNone if success.
  */
-BSC_SDK_EXPORT SerialCommError SerialCommFlush(int instanceId)
+BSC_SDK_EXPORT SerialCommError SerialCommSetReadMode(int instanceId, uint8_t minBytes, uint8_t interByteTimeout)
 {
-    if (instanceId < 0 || static_cast<size_t>(instanceId) >= s_instances.size() || !s_instances[instanceId])
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
     {
         return SCErrorInvalidFormat;
     }
 
-    try
+    SerialReadMode mode;
+    mode.minBytes         = minBytes;
+    mode.interByteTimeout = interByteTimeout;
+    return inst->SetReadMode(mode) ? SCErrorNone : SCErrorOpenFailed;
+}
+
+/**
+ * @brief Copies the counters and histograms of the specified instance.
+ *
+ * @param instanceId Instance ID.
+ * @param stats Output structure.
+ * @return SerialCommError Error code, SCErrorNone if success.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommGetStats(int instanceId, SerialCommStats *stats)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst || !stats)
     {
-        s_instances[instanceId]->Flush();
+        return SCErrorInvalidFormat;
+    }
+
+    SerialStatsSnapshot snapshot = inst->Stats();
+    stats->bytesIn       = snapshot.bytesIn;
+    stats->bytesOut      = snapshot.bytesOut;
+    stats->readCalls     = snapshot.readCalls;
+    stats->writeCalls    = snapshot.writeCalls;
+    stats->pollWakeups   = snapshot.pollWakeups;
+    stats->timeouts      = snapshot.timeouts;
+    stats->partialWrites = snapshot.partialWrites;
+    stats->errors        = snapshot.errors;
+    stats->droppedBytes  = snapshot.droppedBytes;
+    std::memcpy(stats->readWaitUs, snapshot.readWaitUs, sizeof(stats->readWaitUs));
+    std::memcpy(stats->writeUs, snapshot.writeUs, sizeof(stats->writeUs));
+    return SCErrorNone;
+}
+
+/**
+ * @brief Zeroes the counters and histograms of the specified instance.
+ *
+ * @param instanceId Instance ID.
+ * @return SerialCommError Error code, SCErrorNone if success.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommResetStats(int instanceId)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    inst->ResetStats();
+    return SCErrorNone;
+}
+
+/**
+ * @brief Enables or disables low-latency mode for the specified instance.
+ *
+ * @param instanceId Instance ID.
+ * @param enable true to enable, false to restore the original settings.
+ * @return SerialCommError Error code, SCErrorNone if success.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommSetLowLatency(int instanceId, bool enable)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    return inst->SetLowLatency(enable) ? SCErrorNone : SCErrorOpenFailed;
+}
+
+/**
+ * @brief Returns the baud rate the driver applied to the specified instance.
+ *
+ * @param instanceId Instance ID.
+ * @return uint32_t Rate in bits per second, 0 if the instance is invalid.
+ */
+BSC_SDK_EXPORT uint32_t SerialCommGetActualBaudRate(int instanceId)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
+    {
+        return 0;
+    }
+
+    return inst->ActualBaudRate();
+}
+
+/**
+ * @brief Sets or removes the receive callback of the specified instance.
+ *
+ * @param instanceId Instance ID.
+ * @param callback Function to call with each batch, NULL to remove.
+ * @param userData Passed unchanged to callback.
+ * @return SerialCommError Error code, SCErrorNone if success.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommSetRxCallback(int instanceId, SerialCommRxCallback callback, void *userData)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
+    {
+        return SCErrorInvalidFormat;
+    }
+
+    if (!callback)
+    {
+        SerialRxDispatcher::Instance().Unsubscribe(*inst);
         return SCErrorNone;
     }
-    catch (const std::runtime_error &)
+
+    // Reads and callbacks hold a lease like any other call, so Close and Deinit wait for them.
+    bool subscribed = SerialRxDispatcher::Instance().Subscribe(
+        inst.Port(),
+        [instanceId, callback, userData](const uint8_t *data, size_t length) {
+            callback(instanceId, data, length, userData);
+        },
+        [instanceId](const std::function<void()> &use) {
+            auto lease = s_instances.Use(instanceId);
+            if (!lease)
+            {
+                return false;
+            }
+            t_callbackInstance = instanceId;
+            use();
+            t_callbackInstance = -1;
+            return true;
+        });
+    return subscribed ? SCErrorNone : SCErrorOpenFailed;
+}
+
+/**
+ * @brief Flushes input and output buffers of the specified instance.
+ *
+ * @param instanceId Instance ID.
+ * @return SerialCommError Error code, SCErrorNone if success.
+ */
+BSC_SDK_EXPORT SerialCommError SerialCommFlush(int instanceId)
+{
+    auto inst = s_instances.Use(instanceId);
+    if (!inst)
     {
-        return SCErrorNoData;
+        return SCErrorInvalidFormat;
     }
+
+    SerialResult result = inst->TryFlush();
+    return result ? SCErrorNone : failureOf(result);
+}
+
+/**
+ * @brief Returns the system error code of the last failed call on this thread.
+ *
+ * @return int errno (GetLastError() on Windows), 0 if the failure had none.
+ */
+BSC_SDK_EXPORT int SerialCommGetLastSystemError(void)
+{
+    return t_lastSystemError;
 }
 
 } // extern "C"
@@ -3,8 +3,11 @@
 #include <getopt.h>
 #include <string>
 #include <cstdlib>
+#include <vector>
 #include "SdkWrapper.h"
 #include <OpenBSC.hpp>
+#include <OpenBSCDiscovery.hpp>
+#include <PortManager.hpp>
 
 namespace MediumTerminalUtils {
     /**
@@ -12,7 +15,8 @@ namespace MediumTerminalUtils {
      * @param progName Name of the executable
      */
     void printUsage(const char* progName) {
-        std::cout << "Usage: " << progName << " [-c COM_PORT | -p PID] [-v VID] [-x COMMAND] [-b BAUD] [--rts] [--dtr]\n"
+        std::cout << "Usage: " << progName << " [-c COM_PORT | -p PID] [-v VID] [-x COMMAND] [-b BAUD] [--rts] [--dtr] [--low-latency] [-w FILE]\n"
+                  << "       " << progName << " --discover [-p PID] [-v VID] [-x COMMAND] [-b BAUD] [--rts] [--dtr]\n"
                   << "  OpenBSC Medium Terminal is a USB and Serial communication CLI utilizing OPEN BSC PROTOCOL\n\n"
                   << "  Required config options:\n\n"
                   << "  -c <COM_PORT> | --com <COM_PORT>   Specify COM port (e.g., COM5)\n"
@@ -23,10 +27,44 @@ namespace MediumTerminalUtils {
                   << "  Optional config options:\n\n"
                   << "  -b <BAUD>     | --baudrate <BAUD>  Baudrate (default: 115200)\n"
                   << "  --rts                               Enable RTS\n"
-                  << "  --dtr                               Enable DTR\n";
+                  << "  --dtr                               Enable DTR\n"
+                  << "  -l            | --low-latency      Low-latency mode (ASYNC_LOW_LATENCY, 1 ms USB latency timer)\n"
+                  << "  -w <FILE>     | --capture <FILE>   Record the port traffic to FILE for offline replay\n\n"
+                  << "  Discovery:\n\n"
+                  << "  --discover                          Send COMMAND (default: V) to every port at once and list\n"
+                  << "                                      which ones answered; filtered by -v/-p when given\n";
     }
 }
 
+int MediumTerminal::runDiscovery(uint16_t vid, uint16_t pid, const std::string& command, int baudrate, bool rts, bool dtr)
+{
+    std::vector<std::string> candidates = FindPorts(vid, pid);
+    if (candidates.empty()) {
+        std::cerr << "No COM port found to probe.\n";
+        return 1;
+    }
+
+    DiscoveryConfig config;
+    config.command  = command;
+    config.baudRate = static_cast<uint32_t>(baudrate);
+    config.useRts   = rts;
+    config.useDtr   = dtr;
+
+    static const char* const STATUS_TEXT[] = {"answered", "no answer", "bad BCC", "open failed", "send failed", "I/O error"};
+
+    int answered = 0;
+    for (const DiscoveryResult& result : DiscoverDevices(candidates, config)) {
+        std::cout << result.port << "\t" << STATUS_TEXT[static_cast<int>(result.status)];
+        if (result.status == DiscoveryStatus::Answered) {
+            std::cout << "\t" << result.latencyUs / 1000.0 << " ms\t" << result.answer;
+            ++answered;
+        }
+        std::cout << "\n";
+    }
+
+    return answered > 0 ? 0 : 1;
+}
+
 int MediumTerminal::run(int argc, char *argv[])
 {
     std::string comPort;
@@ -37,6 +75,10 @@ int MediumTerminal::run(int argc, char *argv[])
     bool rts = false;                  // RTS control
     bool dtr = false;                  // DTR control
     int baudrate = 115200;             // Default baudrate
+    bool lowLatency = false;           // Low-latency serial mode
+    std::string capturePath;           // Traffic capture file
+    bool discover = false;             // Probe all candidate ports instead of one
+    bool vidGiven = false;             // -v was passed explicitly
 
     // Define long options for getopt
     const struct option long_options[] = {
@@ -48,12 +90,15 @@ int MediumTerminal::run(int argc, char *argv[])
         {"baudrate", required_argument, nullptr, 'b'},
         {"rts", no_argument, nullptr, 'r'},
         {"dtr", no_argument, nullptr, 'd'},
+        {"low-latency", no_argument, nullptr, 'l'},
+        {"capture", required_argument, nullptr, 'w'},
+        {"discover", no_argument, nullptr, 'D'},
         {nullptr, 0, nullptr, 0}
     };
 
     // Parse command-line arguments
     int opt, long_index = 0;
-    while ((opt = getopt_long(argc, argv, "c:p:v:x:b:rd", long_options, &long_index)) != -1) {
+    while ((opt = getopt_long(argc, argv, "c:p:v:x:b:rdlw:", long_options, &long_index)) != -1) {
         switch (opt) {
             case 'h': 
                 MediumTerminalUtils::printUsage(argv[0]); 
@@ -67,6 +112,7 @@ int MediumTerminal::run(int argc, char *argv[])
                 break;
             case 'v': 
                 vid = static_cast<uint16_t>(strtoul(optarg, nullptr, 0)); 
+                vidGiven = true;
                 break;
             case 'x': 
                 command = optarg; 
@@ -80,12 +126,25 @@ int MediumTerminal::run(int argc, char *argv[])
             case 'd': 
                 dtr = true; 
                 break;
+            case 'l': 
+                lowLatency = true; 
+                break;
+            case 'w': 
+                capturePath = optarg; 
+                break;
+            case 'D': 
+                discover = true; 
+                break;
             default: 
                 MediumTerminalUtils::printUsage(argv[0]); 
                 return 1;
         }
     }
 
+    if (discover) {
+        return runDiscovery(usePid || vidGiven ? vid : 0, pid, command.empty() ? "V" : command, baudrate, rts, dtr);
+    }
+
     // Validate COM/PID options
     if ((!comPort.empty() && usePid) || (comPort.empty() && !usePid)) {
         std::cerr << "Error: Use either -c <COM_PORT> or -p <PID>, but not both.\n";
@@ -114,8 +173,19 @@ int MediumTerminal::run(int argc, char *argv[])
     }
 
     // Initialize OpenBSC instance
+    SerialOptions options;
+    options.lowLatency = lowLatency;
+
+    if (!capturePath.empty()) {
+        options.capture = SerialCapture::Create(capturePath);
+        if (!options.capture) {
+            std::cerr << "Failed to create capture file " << capturePath << "\n";
+            return 1;
+        }
+    }
+
     OpenBSC bsc;
-    if (!bsc.Init(serial.c_str(), baudrate, 8, 1, 'N', rts, dtr) || !bsc.Open(serial.c_str())) {
+    if (!bsc.Init(serial.c_str(), baudrate, 8, 1, 'N', rts, dtr, options) || !bsc.Open(serial.c_str())) {
         std::cerr << "Failed to open serial port " << serial << "\n";
         return 1;
     }
@@ -9,6 +9,9 @@
  * @author Eduardo abdala
  */
 
+#include <cstdint>
+#include <string>
+
 class MediumTerminal {
 public:
     /**
@@ -21,6 +24,12 @@ public:
 
 private:
     void printUsage(const char* progName) const;
+
+    /**
+     * @brief Probe every port matching vid/pid (0 = any) with command and print who answered
+     * @return Exit code, 0 if at least one device answered
+     */
+    int runDiscovery(uint16_t vid, uint16_t pid, const std::string& command, int baudrate, bool rts, bool dtr);
 };
 
 #endif  // MEDIUM_TERMINAL_H